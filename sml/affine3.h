@@ -0,0 +1,398 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_AFFINE3_H_
+#define SLIPPYS_MATH_LIBRARY_AFFINE3_H_
+
+#include <cstring>
+#include <sml/format.h>
+#include <sml/matrix4.h>
+#include <sml/simd.h>
+#include <sml/vector3.h>
+
+/*
+
+Affine3 is a Mat4 without its last row, which is always (0, 0, 0, 1) for
+translations, rotations and scales. It is stored the same way, one column
+after the other, so Affine3 { X Y Z T } stands for
+
+| X.x Y.x Z.x T.x |
+| X.y Y.y Z.y T.y |
+| X.z Y.z Z.z T.z |
+|  0   0   0   1  |
+
+It takes 48 bytes instead of 64, and composing two of them takes 36
+multiplications instead of 64.
+
+*/
+
+namespace sml {
+
+struct Points12 {
+    float f[12];
+};
+
+class Affine3 {
+   public:
+    constexpr Affine3();
+    constexpr Affine3(const Points12& points);
+    explicit Affine3(const Mat4& m);
+
+    // transformation methods
+    Affine3 translated(const Vec3& v) const;
+    Affine3& translate(const Vec3& v);
+    Affine3 scaled(const Vec3& v) const;
+    Affine3& scale(const Vec3& v);
+    Affine3 rotated(const Vec3& axis, const float angle) const;
+    Affine3& rotate(const Vec3& axis, const float angle);
+    Affine3 inverted() const;
+    Affine3& invert();
+
+    // vector methods
+    Vec3 transformed_point(const Vec3& v) const;
+    Vec3 transformed_direction(const Vec3& v) const;
+
+    // batch methods (w = 1 for points, w = 0 for directions, 'out' may be 'in')
+    void transform_points(const Vec3* in, Vec3* out, size_t n) const;
+    void transform_directions(const Vec3* in, Vec3* out, size_t n) const;
+
+    // misc methods
+    Mat4 to_mat4() const;
+    std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
+    Affine3& copy(const Affine3& m);
+
+    // useful constant matrices
+    static constexpr Affine3 identity();
+
+    static const size_t COLUMNS = 4;
+    static const size_t ROWS = 3;
+    static const size_t MEM_SIZE = COLUMNS * ROWS * sizeof(float);
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 570;
+
+    operator std::string();
+
+    constexpr const float* operator[](const size_t n) const;
+    constexpr float* operator[](const size_t n);
+
+    // all 12 entries, column after column
+    const float* data() const;
+    float* data();
+
+   private:
+    float _data[4][3];
+};
+
+// Operators
+
+bool operator==(const Affine3& a, const Affine3& b);
+bool operator!=(const Affine3& a, const Affine3& b);
+
+Affine3 operator*(const Affine3& a, const Affine3& b);
+Vec3 operator*(const Affine3& m, const Vec3& v);
+
+Affine3& operator*=(Affine3& a, const Affine3& b);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+// Kernels
+
+namespace detail {
+
+/*
+Affine composition
+The linear parts multiply like 3x3 matrices, and the translation of 'b' is
+moved by 'a' before adding the translation of 'a':
+
+  out[c] = a[0] * b[c][0] + a[1] * b[c][1] + a[2] * b[c][2]          (c < 3)
+  out[3] = a[0] * b[3][0] + a[1] * b[3][1] + a[2] * b[3][2] + a[3]
+
+All of 'a' and 'b' is read before 'out' is written, so 'out' may alias either.
+*/
+inline void multiply_affine3_scalar(const float* a, const float* b, float* out) {
+    float result[12];
+    for (size_t c = 0; c < Affine3::COLUMNS; c++) {
+        const float* column = b + c * Affine3::ROWS;
+        for (size_t r = 0; r < Affine3::ROWS; r++) {
+            result[c * Affine3::ROWS + r] =
+                a[r] * column[0] + a[3 + r] * column[1] + a[6 + r] * column[2];
+        }
+    }
+    result[9] += a[9];
+    result[10] += a[10];
+    result[11] += a[11];
+    std::memcpy(out, result, Affine3::MEM_SIZE);
+}
+
+inline void multiply_affine3(const float* a, const float* b, float* out) {
+#if defined(SML_SIMD_SSE)
+    // columns are 3 floats apart, so the last one is loaded in two halves to stay in bounds
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 3);
+    const __m128 a2 = _mm_loadu_ps(a + 6);
+    const __m128 a3 = _mm_movelh_ps(
+        _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(a + 9)), _mm_load_ss(a + 11));
+
+    __m128 result[4];
+    for (size_t c = 0; c < Affine3::COLUMNS; c++) {
+        const float* column = b + c * Affine3::ROWS;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+        result[c] = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+    }
+    result[3] = _mm_add_ps(result[3], a3);
+
+    // pack the four 3-float columns back into three registers
+    const __m128 r0 = result[0], r1 = result[1], r2 = result[2], r3 = result[3];
+    _mm_storeu_ps(out, _mm_shuffle_ps(r0, _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 2, 2)),
+                                      _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(_mm_shuffle_ps(r2, r3, _MM_SHUFFLE(0, 0, 2, 2)), r3,
+                                          _MM_SHUFFLE(2, 1, 2, 0)));
+#else
+    multiply_affine3_scalar(a, b, out);
+#endif
+}
+
+}  // namespace detail
+
+// Constructors
+
+constexpr Affine3::Affine3() : _data{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 0}} {}
+
+constexpr Affine3::Affine3(const Points12& points) : _data{} {
+    for (size_t x = 0; x < Affine3::COLUMNS; x++) {
+        for (size_t y = 0; y < Affine3::ROWS; y++) {
+            _data[x][y] = points.f[x * Affine3::ROWS + y];
+        }
+    }
+}
+
+inline Affine3::Affine3(const Mat4& m) : _data{} {
+    for (size_t c = 0; c < Affine3::COLUMNS; c++) {
+        std::memcpy(_data[c], m[c], Affine3::ROWS * sizeof(float));
+    }
+}
+
+// Useful static members
+
+constexpr Affine3 Affine3::identity() { return Affine3(); }
+
+// Tranformation Methods
+
+inline Affine3 Affine3::translated(const Vec3& v) const {
+    Affine3 m{};
+    m.copy(*this);
+    return m.translate(v);
+}
+
+inline Affine3& Affine3::translate(const Vec3& v) {
+    for (size_t r = 0; r < Affine3::ROWS; r++) {
+        _data[3][r] += _data[0][r] * v.x + _data[1][r] * v.y + _data[2][r] * v.z;
+    }
+    return (*this);
+}
+
+inline Affine3 Affine3::scaled(const Vec3& v) const {
+    Affine3 m{};
+    m.copy(*this);
+    return m.scale(v);
+}
+
+inline Affine3& Affine3::scale(const Vec3& v) {
+    for (size_t r = 0; r < Affine3::ROWS; r++) {
+        _data[0][r] *= v.x;
+        _data[1][r] *= v.y;
+        _data[2][r] *= v.z;
+    }
+    return (*this);
+}
+
+inline Affine3 Affine3::rotated(const Vec3& axis, const float angle) const {
+    Affine3 m{};
+    m.copy(*this);
+    return m.rotate(axis, angle);
+}
+
+inline Affine3& Affine3::rotate(const Vec3& axis, const float angle) {
+    float rotation[9];
+    detail::rotation_mat3(axis, angle, rotation);
+
+    float result[9];
+    for (size_t c = 0; c < 3; c++) {
+        const float* column = rotation + c * 3;
+        for (size_t r = 0; r < Affine3::ROWS; r++) {
+            result[c * Affine3::ROWS + r] =
+                _data[0][r] * column[0] + _data[1][r] * column[1] + _data[2][r] * column[2];
+        }
+    }
+    std::memcpy(_data, result, sizeof(result));
+    return (*this);
+}
+
+/*
+Inverse
+The rows of the inverted linear part are the cross products of its columns over
+its determinant, and the translation is moved back through it.
+*/
+inline Affine3 Affine3::inverted() const {
+    const Vec3 c0(_data[0][0], _data[0][1], _data[0][2]);
+    const Vec3 c1(_data[1][0], _data[1][1], _data[1][2]);
+    const Vec3 c2(_data[2][0], _data[2][1], _data[2][2]);
+    const Vec3 t(_data[3][0], _data[3][1], _data[3][2]);
+
+    Vec3 r0 = c1.cross(c2);
+    Vec3 r1 = c2.cross(c0);
+    Vec3 r2 = c0.cross(c1);
+    const float inverse_determinant = 1.f / c0.dot(r0);
+    r0 *= inverse_determinant;
+    r1 *= inverse_determinant;
+    r2 *= inverse_determinant;
+
+    return Affine3({r0.x, r1.x, r2.x,  // force format
+                    r0.y, r1.y, r2.y,  //
+                    r0.z, r1.z, r2.z,  //
+                    -r0.dot(t), -r1.dot(t), -r2.dot(t)});
+}
+
+inline Affine3& Affine3::invert() { return copy(inverted()); }
+
+// Vector Methods
+
+inline Vec3 Affine3::transformed_point(const Vec3& v) const { return (*this) * v; }
+
+inline Vec3 Affine3::transformed_direction(const Vec3& v) const {
+    return Vec3(_data[0][0] * v.x + _data[1][0] * v.y + _data[2][0] * v.z,
+                _data[0][1] * v.x + _data[1][1] * v.y + _data[2][1] * v.z,
+                _data[0][2] * v.x + _data[1][2] * v.y + _data[2][2] * v.z);
+}
+
+// Batch Methods
+
+inline void Affine3::transform_points(const Vec3* in, Vec3* out, size_t n) const {
+    const Mat4 m = to_mat4();
+    detail::transform_vec3_array(m.data(), in, out, n, 1.f);
+}
+
+inline void Affine3::transform_directions(const Vec3* in, Vec3* out, size_t n) const {
+    const Mat4 m = to_mat4();
+    detail::transform_vec3_array(m.data(), in, out, n, 0.f);
+}
+
+// Misc Methods
+
+inline Mat4 Affine3::to_mat4() const {
+    return Mat4({_data[0][0], _data[0][1], _data[0][2], 0,  // force format
+                 _data[1][0], _data[1][1], _data[1][2], 0,  //
+                 _data[2][0], _data[2][1], _data[2][2], 0,  //
+                 _data[3][0], _data[3][1], _data[3][2], 1});
+}
+
+inline Affine3& Affine3::copy(const Affine3& m) {
+    std::memcpy(_data, m._data, Affine3::MEM_SIZE);
+    return (*this);
+}
+
+inline std::string Affine3::to_string() const {
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Affine3::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Affine3 {\n");
+
+    for (size_t y = 0; y < Affine3::ROWS; y++) {
+        writer.append("      { ");
+        for (size_t x = 0; x < Affine3::COLUMNS; x++) {
+            writer.append_fixed(_data[x][y]);
+            writer.append(" ");
+        }
+        writer.append("}\n");
+    }
+    writer.append("}\n");
+
+    return writer.finish();
+}
+
+// Conversion operators
+
+inline Affine3::operator std::string() { return to_string(); }
+
+constexpr const float* Affine3::operator[](const size_t n) const { return _data[n]; }
+
+constexpr float* Affine3::operator[](const size_t n) { return _data[n]; }
+
+inline const float* Affine3::data() const { return reinterpret_cast<const float*>(_data); }
+
+inline float* Affine3::data() { return reinterpret_cast<float*>(_data); }
+
+// Imutable operators
+
+inline bool operator==(const Affine3& a, const Affine3& b) {
+    for (size_t x = 0; x < Affine3::COLUMNS; x++) {
+        for (size_t y = 0; y < Affine3::ROWS; y++) {
+            if (std::fabs(a[x][y] - b[x][y]) > FLT_EPSILON) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+inline bool operator!=(const Affine3& a, const Affine3& b) { return !(a == b); }
+
+inline Affine3 operator*(const Affine3& a, const Affine3& b) {
+    Affine3 m;
+    detail::multiply_affine3(a.data(), b.data(), m.data());
+    return m;
+}
+
+inline Vec3 operator*(const Affine3& m, const Vec3& v) {
+    return Vec3(m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0],
+                m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1],
+                m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2]);
+}
+
+// Mutable operators
+
+inline Affine3& operator*=(Affine3& a, const Affine3& b) {
+    detail::multiply_affine3(a.data(), b.data(), a.data());
+    return a;
+}
+
+}  // namespace sml
+
+namespace std {
+
+inline string to_string(const sml::Affine3& m) { return m.to_string(); }
+
+}  // namespace std
+
+#endif
@@ -0,0 +1,295 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_ANIMATION_H_
+#define SLIPPYS_MATH_LIBRARY_ANIMATION_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <sml/quaternion.h>
+#include <sml/vector3.h>
+#include <vector>
+
+/*
+
+Keyframe animation
+
+An AnimationClip holds Vec3 tracks (translations, scales) and Quat tracks
+(rotations). Each track is a run of keys, times increasing, and every track of
+a kind shares one times array and one values array with the others:
+
+  times   | t0 t1 t2 | t0 t1 | t0 t1 t2 t3 | ...
+  values  | v0 v1 v2 | v0 v1 | v0 v1 v2 v3 | ...
+            track 0    track 1  track 2
+
+Sampling a track at some time means finding the last key at or before it and
+blending towards the next one: Vec3s linearly, Quats with Quat::fast_slerp.
+Before the first key and after the last, the track holds its end value.
+
+The clip can sample a track on its own, binary searching its keys each time.
+An AnimationSampler instead plays one clip back and keeps a cursor (the last key
+found) per track. As playback moves forward, the next key is almost always the
+cursor itself or the one after it, so finding it takes a step or two. Jumping
+far ahead or going back (looping, seeking) falls back to a binary search. Many
+samplers can share a clip.
+
+A sampler writes the whole pose at once, in separate x, y, z (and w) arrays,
+one entry per track.
+
+*/
+
+namespace sml {
+
+class AnimationClip {
+   public:
+    AnimationClip() = default;
+
+    // tracks, returning their index among the tracks of their kind
+    size_t add_track(const float* times, const Vec3* values, const size_t count);
+    size_t add_track(const float* times, const Quat* values, const size_t count);
+    void clear();
+
+    size_t vec3_track_count() const;
+    size_t quat_track_count() const;
+
+    // time of the last key of any track
+    float duration() const;
+
+    // single samples, looking the keys up from scratch
+    Vec3 sample_vec3(const size_t track, const float time) const;
+    Quat sample_quat(const size_t track, const float time) const;
+
+   private:
+    friend class AnimationSampler;
+
+    struct Track {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    std::vector<float> _vec3_times;
+    std::vector<Vec3> _vec3_values;
+    std::vector<Track> _vec3_tracks;
+    std::vector<float> _quat_times;
+    std::vector<Quat> _quat_values;
+    std::vector<Track> _quat_tracks;
+    float _duration = 0.f;
+};
+
+class AnimationSampler {
+   public:
+    // the clip must outlive the sampler
+    explicit AnimationSampler(const AnimationClip& clip);
+
+    // whole poses, one entry per track
+    void sample_vec3s(const float time, float* x, float* y, float* z);
+    void sample_quats(const float time, float* w, float* x, float* y, float* z);
+
+    // start over from the first keys, needed once the clip was cleared
+    void reset();
+
+    const AnimationClip& clip() const;
+
+   private:
+    const AnimationClip* _clip;
+    std::vector<uint32_t> _vec3_cursors;
+    std::vector<uint32_t> _quat_cursors;
+};
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+// steps a cursor may walk forward before a binary search takes over
+const uint32_t ANIMATION_CURSOR_STEPS = 4;
+
+// the last key in [first, end) at or before time, or first if there is none
+inline uint32_t find_key(const float* times, const uint32_t first, const uint32_t end,
+                         const float time) {
+    const float* after = std::upper_bound(times + first, times + end, time);
+    return after == times + first ? first : static_cast<uint32_t>(after - times) - 1;
+}
+
+// find_key over all keys, starting from the key found last time
+inline uint32_t advance_key(const float* times, const uint32_t count, const float time,
+                            uint32_t cursor) {
+    if (time < times[cursor]) {
+        return find_key(times, 0, cursor, time);
+    }
+    for (uint32_t step = 0; step < ANIMATION_CURSOR_STEPS; step++) {
+        if (cursor + 1 == count || times[cursor + 1] > time) {
+            return cursor;
+        }
+        cursor++;
+    }
+    return find_key(times, cursor, count, time);
+}
+
+// how far time is from key to the next one, within [0, 1]
+inline float key_factor(const float* times, const uint32_t count, const uint32_t key,
+                        const float time) {
+    if (key + 1 == count) {
+        return 0.f;
+    }
+    const float t = (time - times[key]) / (times[key + 1] - times[key]);
+    return std::min(std::max(t, 0.f), 1.f);
+}
+
+inline Vec3 blend_keys(const Vec3* values, const uint32_t key, const float t) {
+    return t == 0.f ? values[key] : lerp(values[key], values[key + 1], t);
+}
+
+inline Quat blend_keys(const Quat* values, const uint32_t key, const float t) {
+    return t == 0.f ? values[key] : Quat::fast_slerp(values[key], values[key + 1], t);
+}
+
+}  // namespace detail
+
+// Tracks
+
+inline size_t AnimationClip::add_track(const float* times, const Vec3* values,
+                                       const size_t count) {
+    assert(count > 0 && std::is_sorted(times, times + count));
+
+    _vec3_tracks.push_back(
+        {static_cast<uint32_t>(_vec3_times.size()), static_cast<uint32_t>(count)});
+    _vec3_times.insert(_vec3_times.end(), times, times + count);
+    _vec3_values.insert(_vec3_values.end(), values, values + count);
+    _duration = std::max(_duration, times[count - 1]);
+    return _vec3_tracks.size() - 1;
+}
+
+inline size_t AnimationClip::add_track(const float* times, const Quat* values,
+                                       const size_t count) {
+    assert(count > 0 && std::is_sorted(times, times + count));
+
+    _quat_tracks.push_back(
+        {static_cast<uint32_t>(_quat_times.size()), static_cast<uint32_t>(count)});
+    _quat_times.insert(_quat_times.end(), times, times + count);
+    _quat_values.insert(_quat_values.end(), values, values + count);
+    _duration = std::max(_duration, times[count - 1]);
+    return _quat_tracks.size() - 1;
+}
+
+inline void AnimationClip::clear() {
+    _vec3_times.clear();
+    _vec3_values.clear();
+    _vec3_tracks.clear();
+    _quat_times.clear();
+    _quat_values.clear();
+    _quat_tracks.clear();
+    _duration = 0.f;
+}
+
+inline size_t AnimationClip::vec3_track_count() const { return _vec3_tracks.size(); }
+
+inline size_t AnimationClip::quat_track_count() const { return _quat_tracks.size(); }
+
+inline float AnimationClip::duration() const { return _duration; }
+
+// Sampling
+
+inline Vec3 AnimationClip::sample_vec3(const size_t track, const float time) const {
+    assert(track < _vec3_tracks.size());
+
+    const Track& keys = _vec3_tracks[track];
+    const float* times = _vec3_times.data() + keys.first;
+    const uint32_t key = detail::find_key(times, 0, keys.count, time);
+    return detail::blend_keys(_vec3_values.data() + keys.first, key,
+                              detail::key_factor(times, keys.count, key, time));
+}
+
+inline Quat AnimationClip::sample_quat(const size_t track, const float time) const {
+    assert(track < _quat_tracks.size());
+
+    const Track& keys = _quat_tracks[track];
+    const float* times = _quat_times.data() + keys.first;
+    const uint32_t key = detail::find_key(times, 0, keys.count, time);
+    return detail::blend_keys(_quat_values.data() + keys.first, key,
+                              detail::key_factor(times, keys.count, key, time));
+}
+
+// Sampler
+
+inline AnimationSampler::AnimationSampler(const AnimationClip& clip)
+    : _clip{&clip},
+      _vec3_cursors(clip.vec3_track_count(), 0),
+      _quat_cursors(clip.quat_track_count(), 0) {}
+
+inline void AnimationSampler::sample_vec3s(const float time, float* x, float* y, float* z) {
+    // tracks may have been added to the clip since
+    _vec3_cursors.resize(_clip->_vec3_tracks.size(), 0);
+
+    const float* all_times = _clip->_vec3_times.data();
+    const Vec3* all_values = _clip->_vec3_values.data();
+    for (size_t i = 0; i < _vec3_cursors.size(); i++) {
+        const AnimationClip::Track& keys = _clip->_vec3_tracks[i];
+        const float* times = all_times + keys.first;
+        const uint32_t key = detail::advance_key(times, keys.count, time, _vec3_cursors[i]);
+        _vec3_cursors[i] = key;
+
+        const Vec3 v = detail::blend_keys(all_values + keys.first, key,
+                                          detail::key_factor(times, keys.count, key, time));
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+}
+
+inline void AnimationSampler::sample_quats(const float time, float* w, float* x, float* y,
+                                           float* z) {
+    // tracks may have been added to the clip since
+    _quat_cursors.resize(_clip->_quat_tracks.size(), 0);
+
+    const float* all_times = _clip->_quat_times.data();
+    const Quat* all_values = _clip->_quat_values.data();
+    for (size_t i = 0; i < _quat_cursors.size(); i++) {
+        const AnimationClip::Track& keys = _clip->_quat_tracks[i];
+        const float* times = all_times + keys.first;
+        const uint32_t key = detail::advance_key(times, keys.count, time, _quat_cursors[i]);
+        _quat_cursors[i] = key;
+
+        const Quat q = detail::blend_keys(all_values + keys.first, key,
+                                          detail::key_factor(times, keys.count, key, time));
+        w[i] = q.w;
+        x[i] = q.x;
+        y[i] = q.y;
+        z[i] = q.z;
+    }
+}
+
+inline void AnimationSampler::reset() {
+    _vec3_cursors.assign(_clip->_vec3_tracks.size(), 0);
+    _quat_cursors.assign(_clip->_quat_tracks.size(), 0);
+}
+
+inline const AnimationClip& AnimationSampler::clip() const { return *_clip; }
+
+}  // namespace sml
+
+#endif
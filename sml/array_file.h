@@ -0,0 +1,602 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_ARRAY_FILE_H_
+#define SLIPPYS_MATH_LIBRARY_ARRAY_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sml/affine3.h>
+#include <sml/color.h>
+#include <sml/matrix4.h>
+#include <sml/quaternion.h>
+#include <sml/vector3.h>
+#include <type_traits>
+#include <vector>
+
+/*
+
+Array files store named arrays of sml types exactly as they sit in memory, so
+a reader can map the file and hand out pointers into it without parsing or
+constructing anything. Pages are only read when an array is first touched.
+
+  offset 0    header        (64 bytes)
+  offset 64   array table   (64 bytes per array)
+  ...         array data    (every array starts on a 64 byte boundary)
+
+Header (all fields in the writer's byte order):
+
+  char     magic[4]      "SMLA"
+  uint16_t version       1
+  uint16_t header_size   64
+  uint32_t byte_order    0x01020304
+  uint32_t array_count
+  uint64_t table_offset
+  uint64_t file_size
+  (zero padding up to 64 bytes)
+
+Array table entry:
+
+  char     name[32]      null-terminated
+  uint32_t type          ArrayType
+  uint32_t layout        ArrayLayout
+  uint64_t count         number of elements
+  uint64_t offset        from the start of the file
+  uint64_t size          in bytes
+
+AOS arrays are the elements back to back (a Vec3 is 12 bytes, a Mat4 is 64
+column-major bytes, a Quat is w, x, y, z). SOA arrays store each float
+component as its own stream of 'count' floats, every stream padded to 64 bytes:
+
+  Vec3 SOA    | x0 x1 x2 ... | y0 y1 y2 ... | z0 z1 z2 ... |
+
+Nothing is byte-swapped: a file written on a machine with the other byte order
+is rejected with ArrayFileStatus::FOREIGN_BYTE_ORDER.
+
+Mapping needs the operating system headers, which would otherwise reach every
+file that includes sml. ArrayFileReader only declares the two calls it makes;
+their definitions live in sml/array_file_mapping.h, which must be included in
+exactly one source file of a program that opens array files.
+
+*/
+
+namespace sml {
+
+namespace detail {
+struct ArrayFileEntry;
+}
+
+enum class ArrayType : uint32_t { FLOAT = 1, VEC3 = 2, QUAT = 3, MAT4 = 4, AFFINE3 = 5, COLOR = 6 };
+
+enum class ArrayLayout : uint32_t { AOS = 0, SOA = 1 };
+
+enum class ArrayFileStatus {
+    OK,
+    CANNOT_OPEN,
+    CANNOT_WRITE,
+    BAD_MAGIC,
+    UNSUPPORTED_VERSION,
+    FOREIGN_BYTE_ORDER,
+    CORRUPT,
+};
+
+// A read-only view over 'size' consecutive elements owned by someone else.
+template <typename T>
+class ArraySpan {
+   public:
+    constexpr ArraySpan() : _data{nullptr}, _size{0} {}
+    constexpr ArraySpan(const T* data, size_t size) : _data{data}, _size{size} {}
+
+    constexpr const T* data() const { return _data; }
+    constexpr size_t size() const { return _size; }
+    constexpr bool empty() const { return _size == 0; }
+
+    constexpr const T* begin() const { return _data; }
+    constexpr const T* end() const { return _data + _size; }
+
+    constexpr const T& operator[](const size_t n) const { return _data[n]; }
+
+   private:
+    const T* _data;
+    size_t _size;
+};
+
+class ArrayFileWriter {
+   public:
+    ArrayFileWriter() = default;
+
+    // Arrays are only referenced: they must stay alive until write() returns.
+    // Names longer than NAME_SIZE - 1 characters are cut.
+    void add(const char* name, const float* values, const size_t count);
+    void add(const char* name, const Vec3* values, const size_t count,
+             const ArrayLayout layout = ArrayLayout::AOS);
+    void add(const char* name, const Quat* values, const size_t count,
+             const ArrayLayout layout = ArrayLayout::AOS);
+    void add(const char* name, const Mat4* values, const size_t count,
+             const ArrayLayout layout = ArrayLayout::AOS);
+    void add(const char* name, const Affine3* values, const size_t count,
+             const ArrayLayout layout = ArrayLayout::AOS);
+    void add(const char* name, const Color* values, const size_t count,
+             const ArrayLayout layout = ArrayLayout::AOS);
+
+    void clear();
+    size_t size() const;
+
+    ArrayFileStatus write(const char* path) const;
+
+    static const size_t NAME_SIZE = 32;
+
+   private:
+    struct Array {
+        char name[NAME_SIZE];
+        ArrayType type;
+        ArrayLayout layout;
+        const float* values;
+        size_t count;
+    };
+
+    void add(const char* name, const ArrayType type, const ArrayLayout layout,
+             const float* values, const size_t count);
+
+    std::vector<Array> _arrays;
+};
+
+class ArrayFileReader {
+   public:
+    ArrayFileReader() = default;
+    ~ArrayFileReader();
+
+    ArrayFileReader(const ArrayFileReader&) = delete;
+    ArrayFileReader& operator=(const ArrayFileReader&) = delete;
+    ArrayFileReader(ArrayFileReader&& other);
+    ArrayFileReader& operator=(ArrayFileReader&& other);
+
+    // maps the whole file, closing whatever was open before
+    ArrayFileStatus open(const char* path);
+    void close();
+    bool is_open() const;
+
+    // array table
+    size_t size() const;
+    size_t find(const char* name) const;  // NOT_FOUND when missing
+
+    const char* name(const size_t array) const;
+    ArrayType type(const size_t array) const;
+    ArrayLayout layout(const size_t array) const;
+    size_t count(const size_t array) const;
+
+    // AOS arrays (empty when the array has another type or layout)
+    ArraySpan<float> floats(const size_t array) const;
+    ArraySpan<Vec3> vec3s(const size_t array) const;
+    ArraySpan<Quat> quats(const size_t array) const;
+    ArraySpan<Mat4> mat4s(const size_t array) const;
+    ArraySpan<Affine3> affine3s(const size_t array) const;
+    ArraySpan<Color> colors(const size_t array) const;
+
+    // one float stream of an SOA array, e.g. component 1 of a Vec3 array is y
+    ArraySpan<float> component(const size_t array, const size_t component) const;
+
+    static const size_t NOT_FOUND = SIZE_MAX;
+
+   private:
+    const detail::ArrayFileEntry& entry(const size_t array) const;
+
+    template <typename T>
+    ArraySpan<T> aos_span(const size_t array, const ArrayType type) const;
+
+    const unsigned char* _mapping = nullptr;
+    size_t _mapping_size = 0;
+    size_t _array_count = 0;
+};
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+const uint16_t ARRAY_FILE_VERSION = 1;
+const uint32_t ARRAY_FILE_BYTE_ORDER = 0x01020304;
+const size_t ARRAY_FILE_ALIGNMENT = 64;
+
+struct ArrayFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t byte_order;
+    uint32_t array_count;
+    uint64_t table_offset;
+    uint64_t file_size;
+    unsigned char padding[32];
+};
+
+struct ArrayFileEntry {
+    char name[ArrayFileWriter::NAME_SIZE];
+    uint32_t type;
+    uint32_t layout;
+    uint64_t count;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// defined in sml/array_file_mapping.h
+const unsigned char* map_file(const char* path, size_t& size);
+void unmap_file(const unsigned char* mapping, const size_t size);
+
+static_assert(sizeof(ArrayFileHeader) == 64, "array file header must be 64 bytes");
+static_assert(sizeof(ArrayFileEntry) == 64, "array file entry must be 64 bytes");
+
+static_assert(sizeof(Vec3) == 3 * sizeof(float), "Vec3 must be three packed floats");
+static_assert(sizeof(Quat) == 4 * sizeof(float), "Quat must be four packed floats");
+static_assert(sizeof(Mat4) == 16 * sizeof(float), "Mat4 must be sixteen packed floats");
+static_assert(sizeof(Affine3) == 12 * sizeof(float), "Affine3 must be twelve packed floats");
+static_assert(sizeof(Color) == 4 * sizeof(float), "Color must be four packed floats");
+static_assert(std::is_standard_layout<Mat4>::value && std::is_standard_layout<Affine3>::value,
+              "matrices are mapped straight from files");
+
+inline size_t array_components(const ArrayType type) {
+    switch (type) {
+        case ArrayType::FLOAT: return 1;
+        case ArrayType::VEC3: return 3;
+        case ArrayType::QUAT: return 4;
+        case ArrayType::MAT4: return 16;
+        case ArrayType::AFFINE3: return 12;
+        case ArrayType::COLOR: return 4;
+    }
+    return 0;
+}
+
+inline uint64_t align_array_offset(const uint64_t offset) {
+    return (offset + ARRAY_FILE_ALIGNMENT - 1) & ~static_cast<uint64_t>(ARRAY_FILE_ALIGNMENT - 1);
+}
+
+// bytes between two SOA component streams
+inline uint64_t array_stream_size(const uint64_t count) {
+    return align_array_offset(count * sizeof(float));
+}
+
+inline uint64_t array_data_size(const ArrayType type, const ArrayLayout layout,
+                                const uint64_t count) {
+    if (layout == ArrayLayout::SOA) {
+        return array_components(type) * array_stream_size(count);
+    }
+    return array_components(type) * count * sizeof(float);
+}
+
+inline bool write_zeros(std::FILE* file, size_t n) {
+    static const unsigned char ZEROS[ARRAY_FILE_ALIGNMENT] = {};
+    while (n > 0) {
+        const size_t chunk = n < sizeof(ZEROS) ? n : sizeof(ZEROS);
+        if (std::fwrite(ZEROS, 1, chunk, file) != chunk) {
+            return false;
+        }
+        n -= chunk;
+    }
+    return true;
+}
+
+// writes one component of every element, gathered through a small stack buffer
+inline bool write_array_stream(std::FILE* file, const float* values, const size_t count,
+                               const size_t components, const size_t component) {
+    float buffer[1024];
+    for (size_t i = 0; i < count;) {
+        const size_t chunk = count - i < 1024 ? count - i : 1024;
+        for (size_t j = 0; j < chunk; j++) {
+            buffer[j] = values[(i + j) * components + component];
+        }
+        if (std::fwrite(buffer, sizeof(float), chunk, file) != chunk) {
+            return false;
+        }
+        i += chunk;
+    }
+    return write_zeros(file, array_stream_size(count) - count * sizeof(float));
+}
+
+}  // namespace detail
+
+// Writer
+
+inline void ArrayFileWriter::add(const char* name, const ArrayType type, const ArrayLayout layout,
+                                 const float* values, const size_t count) {
+    Array array;
+    std::memset(array.name, 0, NAME_SIZE);
+    std::strncpy(array.name, name, NAME_SIZE - 1);
+    array.type = type;
+    array.layout = layout;
+    array.values = values;
+    array.count = count;
+    _arrays.push_back(array);
+}
+
+inline void ArrayFileWriter::add(const char* name, const float* values, const size_t count) {
+    add(name, ArrayType::FLOAT, ArrayLayout::AOS, values, count);
+}
+
+inline void ArrayFileWriter::add(const char* name, const Vec3* values, const size_t count,
+                                 const ArrayLayout layout) {
+    add(name, ArrayType::VEC3, layout, reinterpret_cast<const float*>(values), count);
+}
+
+inline void ArrayFileWriter::add(const char* name, const Quat* values, const size_t count,
+                                 const ArrayLayout layout) {
+    add(name, ArrayType::QUAT, layout, reinterpret_cast<const float*>(values), count);
+}
+
+inline void ArrayFileWriter::add(const char* name, const Mat4* values, const size_t count,
+                                 const ArrayLayout layout) {
+    add(name, ArrayType::MAT4, layout, reinterpret_cast<const float*>(values), count);
+}
+
+inline void ArrayFileWriter::add(const char* name, const Affine3* values, const size_t count,
+                                 const ArrayLayout layout) {
+    add(name, ArrayType::AFFINE3, layout, reinterpret_cast<const float*>(values), count);
+}
+
+inline void ArrayFileWriter::add(const char* name, const Color* values, const size_t count,
+                                 const ArrayLayout layout) {
+    add(name, ArrayType::COLOR, layout, reinterpret_cast<const float*>(values), count);
+}
+
+inline void ArrayFileWriter::clear() { _arrays.clear(); }
+
+inline size_t ArrayFileWriter::size() const { return _arrays.size(); }
+
+inline ArrayFileStatus ArrayFileWriter::write(const char* path) const {
+    std::vector<detail::ArrayFileEntry> table(_arrays.size());
+
+    uint64_t offset = detail::align_array_offset(sizeof(detail::ArrayFileHeader) +
+                                                 _arrays.size() * sizeof(detail::ArrayFileEntry));
+    for (size_t i = 0; i < _arrays.size(); i++) {
+        detail::ArrayFileEntry& entry = table[i];
+        std::memcpy(entry.name, _arrays[i].name, NAME_SIZE);
+        entry.type = static_cast<uint32_t>(_arrays[i].type);
+        entry.layout = static_cast<uint32_t>(_arrays[i].layout);
+        entry.count = _arrays[i].count;
+        entry.offset = offset;
+        entry.size = detail::array_data_size(_arrays[i].type, _arrays[i].layout, entry.count);
+        offset = detail::align_array_offset(offset + entry.size);
+    }
+
+    detail::ArrayFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SMLA", 4);
+    header.version = detail::ARRAY_FILE_VERSION;
+    header.header_size = sizeof(detail::ArrayFileHeader);
+    header.byte_order = detail::ARRAY_FILE_BYTE_ORDER;
+    header.array_count = static_cast<uint32_t>(_arrays.size());
+    header.table_offset = sizeof(detail::ArrayFileHeader);
+    header.file_size = offset;
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return ArrayFileStatus::CANNOT_OPEN;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!table.empty()) {
+        ok = ok && std::fwrite(table.data(), sizeof(table[0]), table.size(), file) == table.size();
+    }
+    uint64_t position = sizeof(header) + table.size() * sizeof(detail::ArrayFileEntry);
+    for (size_t i = 0; ok && i < _arrays.size(); i++) {
+        const Array& array = _arrays[i];
+        const size_t components = detail::array_components(array.type);
+        ok = detail::write_zeros(file, static_cast<size_t>(table[i].offset - position));
+        if (array.layout == ArrayLayout::SOA) {
+            for (size_t c = 0; ok && c < components; c++) {
+                ok = detail::write_array_stream(file, array.values, array.count, components, c);
+            }
+        } else if (array.count > 0) {
+            const size_t floats = array.count * components;
+            ok = ok && std::fwrite(array.values, sizeof(float), floats, file) == floats;
+        }
+        position = table[i].offset + table[i].size;
+    }
+    ok = ok && detail::write_zeros(file, static_cast<size_t>(offset - position));
+
+    if (std::fclose(file) != 0 || !ok) {
+        return ArrayFileStatus::CANNOT_WRITE;
+    }
+    return ArrayFileStatus::OK;
+}
+
+// Reader
+
+inline ArrayFileReader::~ArrayFileReader() { close(); }
+
+inline ArrayFileReader::ArrayFileReader(ArrayFileReader&& other)
+    : _mapping{other._mapping},
+      _mapping_size{other._mapping_size},
+      _array_count{other._array_count} {
+    other._mapping = nullptr;
+    other._mapping_size = 0;
+    other._array_count = 0;
+}
+
+inline ArrayFileReader& ArrayFileReader::operator=(ArrayFileReader&& other) {
+    if (this != &other) {
+        close();
+        _mapping = other._mapping;
+        _mapping_size = other._mapping_size;
+        _array_count = other._array_count;
+        other._mapping = nullptr;
+        other._mapping_size = 0;
+        other._array_count = 0;
+    }
+    return (*this);
+}
+
+inline ArrayFileStatus ArrayFileReader::open(const char* path) {
+    close();
+
+    size_t size = 0;
+    const unsigned char* mapping = detail::map_file(path, size);
+    if (mapping == nullptr) {
+        return ArrayFileStatus::CANNOT_OPEN;
+    }
+
+    // only the header and the table are read here, array data stays untouched
+    ArrayFileStatus status = ArrayFileStatus::OK;
+    detail::ArrayFileHeader header;
+    if (size < sizeof(header)) {
+        status = ArrayFileStatus::CORRUPT;
+    } else {
+        std::memcpy(&header, mapping, sizeof(header));
+        if (std::memcmp(header.magic, "SMLA", 4) != 0) {
+            status = ArrayFileStatus::BAD_MAGIC;
+        } else if (header.byte_order != detail::ARRAY_FILE_BYTE_ORDER) {
+            status = ArrayFileStatus::FOREIGN_BYTE_ORDER;
+        } else if (header.version != detail::ARRAY_FILE_VERSION) {
+            status = ArrayFileStatus::UNSUPPORTED_VERSION;
+        } else if (header.file_size != size || header.table_offset < sizeof(header) ||
+                   header.table_offset % alignof(detail::ArrayFileEntry) != 0 ||
+                   header.table_offset > size ||
+                   (size - header.table_offset) / sizeof(detail::ArrayFileEntry) <
+                       header.array_count) {
+            status = ArrayFileStatus::CORRUPT;
+        }
+    }
+
+    for (size_t i = 0; status == ArrayFileStatus::OK && i < header.array_count; i++) {
+        detail::ArrayFileEntry entry;
+        std::memcpy(&entry, mapping + header.table_offset + i * sizeof(entry), sizeof(entry));
+        const ArrayType type = static_cast<ArrayType>(entry.type);
+        const ArrayLayout layout = static_cast<ArrayLayout>(entry.layout);
+        const bool valid = detail::array_components(type) != 0 &&
+                           (layout == ArrayLayout::AOS || layout == ArrayLayout::SOA) &&
+                           entry.name[ArrayFileWriter::NAME_SIZE - 1] == '\0' &&
+                           entry.offset % detail::ARRAY_FILE_ALIGNMENT == 0 &&
+                           entry.offset <= size && entry.size <= size - entry.offset &&
+                           entry.count <= size &&
+                           entry.size == detail::array_data_size(type, layout, entry.count);
+        if (!valid) {
+            status = ArrayFileStatus::CORRUPT;
+        }
+    }
+
+    if (status != ArrayFileStatus::OK) {
+        detail::unmap_file(mapping, size);
+        return status;
+    }
+
+    _mapping = mapping;
+    _mapping_size = size;
+    _array_count = header.array_count;
+    return status;
+}
+
+inline void ArrayFileReader::close() {
+    if (_mapping != nullptr) {
+        detail::unmap_file(_mapping, _mapping_size);
+    }
+    _mapping = nullptr;
+    _mapping_size = 0;
+    _array_count = 0;
+}
+
+inline bool ArrayFileReader::is_open() const { return _mapping != nullptr; }
+
+inline size_t ArrayFileReader::size() const { return _array_count; }
+
+inline const detail::ArrayFileEntry& ArrayFileReader::entry(const size_t array) const {
+    const detail::ArrayFileHeader* header =
+        reinterpret_cast<const detail::ArrayFileHeader*>(_mapping);
+    return reinterpret_cast<const detail::ArrayFileEntry*>(_mapping + header->table_offset)[array];
+}
+
+inline size_t ArrayFileReader::find(const char* name) const {
+    for (size_t i = 0; i < _array_count; i++) {
+        if (std::strncmp(entry(i).name, name, ArrayFileWriter::NAME_SIZE) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+inline const char* ArrayFileReader::name(const size_t array) const { return entry(array).name; }
+
+inline ArrayType ArrayFileReader::type(const size_t array) const {
+    return static_cast<ArrayType>(entry(array).type);
+}
+
+inline ArrayLayout ArrayFileReader::layout(const size_t array) const {
+    return static_cast<ArrayLayout>(entry(array).layout);
+}
+
+inline size_t ArrayFileReader::count(const size_t array) const {
+    return static_cast<size_t>(entry(array).count);
+}
+
+template <typename T>
+ArraySpan<T> ArrayFileReader::aos_span(const size_t array, const ArrayType type) const {
+    const detail::ArrayFileEntry& e = entry(array);
+    if (e.type != static_cast<uint32_t>(type) ||
+        e.layout != static_cast<uint32_t>(ArrayLayout::AOS)) {
+        return ArraySpan<T>();
+    }
+    return ArraySpan<T>(reinterpret_cast<const T*>(_mapping + e.offset),
+                        static_cast<size_t>(e.count));
+}
+
+inline ArraySpan<float> ArrayFileReader::floats(const size_t array) const {
+    return aos_span<float>(array, ArrayType::FLOAT);
+}
+
+inline ArraySpan<Vec3> ArrayFileReader::vec3s(const size_t array) const {
+    return aos_span<Vec3>(array, ArrayType::VEC3);
+}
+
+inline ArraySpan<Quat> ArrayFileReader::quats(const size_t array) const {
+    return aos_span<Quat>(array, ArrayType::QUAT);
+}
+
+inline ArraySpan<Mat4> ArrayFileReader::mat4s(const size_t array) const {
+    return aos_span<Mat4>(array, ArrayType::MAT4);
+}
+
+inline ArraySpan<Affine3> ArrayFileReader::affine3s(const size_t array) const {
+    return aos_span<Affine3>(array, ArrayType::AFFINE3);
+}
+
+inline ArraySpan<Color> ArrayFileReader::colors(const size_t array) const {
+    return aos_span<Color>(array, ArrayType::COLOR);
+}
+
+inline ArraySpan<float> ArrayFileReader::component(const size_t array,
+                                                   const size_t component) const {
+    const detail::ArrayFileEntry& e = entry(array);
+    const ArrayType array_type = static_cast<ArrayType>(e.type);
+    if (e.layout != static_cast<uint32_t>(ArrayLayout::SOA) ||
+        component >= detail::array_components(array_type)) {
+        return ArraySpan<float>();
+    }
+    const uint64_t offset = e.offset + component * detail::array_stream_size(e.count);
+    return ArraySpan<float>(reinterpret_cast<const float*>(_mapping + offset),
+                            static_cast<size_t>(e.count));
+}
+
+}  // namespace sml
+
+#endif
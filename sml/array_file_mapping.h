@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_ARRAY_FILE_MAPPING_H_
+#define SLIPPYS_MATH_LIBRARY_ARRAY_FILE_MAPPING_H_
+
+#include <cstdint>
+#include <sml/array_file.h>
+
+#if defined(_WIN32)
+// The few kernel32 calls map_file needs, declared exactly as windows.h does,
+// so this header does not bring in windows.h and its macros either.
+struct _SECURITY_ATTRIBUTES;
+extern "C" {
+__declspec(dllimport) void* __stdcall CreateFileA(const char*, unsigned long, unsigned long,
+                                                  _SECURITY_ATTRIBUTES*, unsigned long,
+                                                  unsigned long, void*);
+__declspec(dllimport) unsigned long __stdcall GetFileSize(void*, unsigned long*);
+__declspec(dllimport) unsigned long __stdcall GetLastError(void);
+__declspec(dllimport) void __stdcall SetLastError(unsigned long);
+__declspec(dllimport) void* __stdcall CreateFileMappingA(void*, _SECURITY_ATTRIBUTES*,
+                                                         unsigned long, unsigned long,
+                                                         unsigned long, const char*);
+#if defined(_WIN64)
+__declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long,
+                                                    unsigned long, unsigned __int64);
+#else
+__declspec(dllimport) void* __stdcall MapViewOfFile(void*, unsigned long, unsigned long,
+                                                    unsigned long, unsigned long);
+#endif
+__declspec(dllimport) int __stdcall UnmapViewOfFile(const void*);
+__declspec(dllimport) int __stdcall CloseHandle(void*);
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+
+The file mapping behind ArrayFileReader. Unlike the rest of sml these are not
+inline functions: include this header in exactly one source file of a program
+that opens array files, so the operating system headers stay out of the others.
+
+*/
+
+namespace sml {
+
+namespace detail {
+
+const unsigned char* map_file(const char* path, size_t& size) {
+#if defined(_WIN32)
+    // GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING and FILE_ATTRIBUTE_NORMAL
+    void* file = CreateFileA(path, 0x80000000ul, 0x1ul, nullptr, 3ul, 0x80ul, nullptr);
+    if (file == reinterpret_cast<void*>(intptr_t{-1})) {
+        return nullptr;
+    }
+    unsigned long high = 0;
+    // INVALID_FILE_SIZE is also a valid low half, GetLastError tells them apart
+    // as long as no earlier error is left behind
+    SetLastError(0);
+    const unsigned long low = GetFileSize(file, &high);
+    if ((low == 0xfffffffful && GetLastError() != 0) || (low == 0 && high == 0)) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    const uint64_t file_size = (static_cast<uint64_t>(high) << 32) | low;
+    // PAGE_READONLY
+    void* mapping = CreateFileMappingA(file, nullptr, 0x02ul, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    // FILE_MAP_READ
+    void* view = MapViewOfFile(mapping, 0x04ul, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return nullptr;
+    }
+    size = static_cast<size_t>(file_size);
+    return static_cast<const unsigned char*>(view);
+#else
+    const int file = ::open(path, O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        ::close(file);
+        return nullptr;
+    }
+    void* view =
+        mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) {
+        return nullptr;
+    }
+    size = static_cast<size_t>(status.st_size);
+    return static_cast<const unsigned char*>(view);
+#endif
+}
+
+void unmap_file(const unsigned char* mapping, const size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(const_cast<unsigned char*>(mapping), size);
+#endif
+}
+
+}  // namespace detail
+
+}  // namespace sml
+
+#endif
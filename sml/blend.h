@@ -0,0 +1,400 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_BLEND_H_
+#define SLIPPYS_MATH_LIBRARY_BLEND_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <sml/color.h>
+#include <sml/color32.h>
+#include <sml/simd.h>
+
+/*
+
+Compositing
+
+Everything here works on premultiplied alpha, where r, g and b are already
+multiplied by a. Every mode is then one formula over all four channels, with
+S the source, D the destination and Sa, Da their alphas:
+
+  S * (s0 + s1 * Da) + D * (d0 + d1 * Sa) + k * S * D
+
+  mode        s0  s1   d0  d1   k
+  OVER         1   0    1  -1   0     S + D * (1 - Sa)
+  SOURCE_IN    0   1    0   0   0     S * Da
+  SOURCE_OUT   1  -1    0   0   0     S * (1 - Da)
+  ATOP         0   1    1  -1   0     S * Da + D * (1 - Sa)
+  XOR          1  -1    1  -1   0     S * (1 - Da) + D * (1 - Sa)
+  MULTIPLY     1  -1    1  -1   1     S * D, plus what each shows outside the other
+  SCREEN       1   0    1   0  -1     S + D - S * D
+  ADDITIVE     1   0    1   0   0     S + D
+
+so one kernel covers them all, and the result is clamped to [0, 1] once at the
+end. A Color is four floats, which is one SSE or NEON register (two pixels per
+AVX register), so no shuffling between pixels is needed.
+
+Spans come either as Color arrays or as packed 8-bit RGBA, four bytes per
+pixel (Color32 or plain bytes). Those go to floats, are blended and come back
+through the same conversions as Color32::to_colors and from_colors.
+
+*/
+
+namespace sml {
+
+enum class BlendMode { OVER, SOURCE_IN, SOURCE_OUT, ATOP, XOR, MULTIPLY, SCREEN, ADDITIVE };
+
+// premultiplied alpha, unpremultiplying an invisible color gives Color::invisible()
+Color premultiplied(const Color& c);
+Color unpremultiplied(const Color& c);
+
+void premultiply(Color* colors, const size_t n);
+void unpremultiply(Color* colors, const size_t n);
+void premultiply(uint8_t* rgba, const size_t n);
+void unpremultiply(uint8_t* rgba, const size_t n);
+void premultiply(Color32* colors, const size_t n);
+void unpremultiply(Color32* colors, const size_t n);
+
+// 'source' put on 'destination' by 'mode', both premultiplied
+Color blended(const Color& source, const Color& destination, const BlendMode mode);
+
+// destination[i] = blended(source[i], destination[i], mode), n pixels
+void blend(const Color* source, Color* destination, const size_t n, const BlendMode mode);
+void blend(const uint8_t* source_rgba, uint8_t* destination_rgba, const size_t n,
+           const BlendMode mode);
+void blend(const Color32* source, Color32* destination, const size_t n, const BlendMode mode);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+struct BlendFactors {
+    float source;
+    float source_by_destination_alpha;
+    float destination;
+    float destination_by_source_alpha;
+    float product;
+};
+
+// in BlendMode order
+const BlendFactors BLEND_FACTORS[] = {
+    {1, 0, 1, -1, 0},  {0, 1, 0, 0, 0},   {1, -1, 0, 0, 0}, {0, 1, 1, -1, 0},
+    {1, -1, 1, -1, 0}, {1, -1, 1, -1, 1}, {1, 0, 1, 0, -1}, {1, 0, 1, 0, 0},
+};
+
+inline const BlendFactors& blend_factors(const BlendMode mode) {
+    return BLEND_FACTORS[static_cast<size_t>(mode)];
+}
+
+inline float blend_channel(const float s, const float d, const float source_alpha,
+                           const float destination_alpha, const BlendFactors& f) {
+    return s * (f.source + f.source_by_destination_alpha * destination_alpha) +
+           d * (f.destination + f.destination_by_source_alpha * source_alpha) +
+           f.product * s * d;
+}
+
+inline Color from_bytes(const uint8_t* rgba) {
+    return Color32(rgba[0], rgba[1], rgba[2], rgba[3]).to_color();
+}
+
+inline void to_bytes(const Color& c, uint8_t* rgba) {
+    const Color32 packed(c);
+    rgba[0] = packed.r;
+    rgba[1] = packed.g;
+    rgba[2] = packed.b;
+    rgba[3] = packed.a;
+}
+
+#if defined(SML_SIMD_SSE)
+
+struct BlendFactorsSSE {
+    __m128 source, source_by_destination_alpha, destination, destination_by_source_alpha,
+        product;
+};
+
+inline BlendFactorsSSE blend_factors_sse(const BlendMode mode) {
+    const BlendFactors& f = blend_factors(mode);
+    return {_mm_set1_ps(f.source), _mm_set1_ps(f.source_by_destination_alpha),
+            _mm_set1_ps(f.destination), _mm_set1_ps(f.destination_by_source_alpha),
+            _mm_set1_ps(f.product)};
+}
+
+// one pixel, not clamped
+inline __m128 blend_sse(const __m128 s, const __m128 d, const BlendFactorsSSE& f) {
+    const __m128 source_alpha = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 destination_alpha = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 source_factor =
+        _mm_add_ps(f.source, _mm_mul_ps(f.source_by_destination_alpha, destination_alpha));
+    const __m128 destination_factor =
+        _mm_add_ps(f.destination, _mm_mul_ps(f.destination_by_source_alpha, source_alpha));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(s, source_factor), _mm_mul_ps(d, destination_factor)),
+                      _mm_mul_ps(f.product, _mm_mul_ps(s, d)));
+}
+
+inline __m128 clamp_unit_sse(const __m128 c) {
+    return _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(_mm_set1_ps(1.f), c));
+}
+
+// r, g and b by a, a left alone
+inline __m128 premultiply_sse(const __m128 c) {
+    const __m128 alpha = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 factor = _mm_move_ss(alpha, _mm_set1_ps(1.f));
+    // the 1 sits in lane 0, turn it round to lane 3
+    return _mm_mul_ps(c, _mm_shuffle_ps(factor, factor, _MM_SHUFFLE(0, 1, 2, 3)));
+}
+
+inline __m128 unpremultiply_sse(const __m128 c) {
+    const __m128 alpha = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 visible = _mm_cmpgt_ps(alpha, _mm_setzero_ps());
+    const __m128 inverse = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.f), alpha), visible);
+    const __m128 factor = _mm_move_ss(inverse, _mm_set1_ps(1.f));
+    return _mm_mul_ps(c, _mm_shuffle_ps(factor, factor, _MM_SHUFFLE(0, 1, 2, 3)));
+}
+
+#endif
+
+#if defined(SML_SIMD_AVX)
+
+// the SSE kernel on two pixels at once, alphas spread within each half, clamped
+inline __m256 blend_avx(const __m256 s, const __m256 d, const BlendMode mode) {
+    const BlendFactors& f = blend_factors(mode);
+    const __m256 source_alpha = _mm256_permute_ps(s, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256 destination_alpha = _mm256_permute_ps(d, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m256 source_factor =
+        _mm256_add_ps(_mm256_set1_ps(f.source),
+                      _mm256_mul_ps(_mm256_set1_ps(f.source_by_destination_alpha),
+                                    destination_alpha));
+    const __m256 destination_factor =
+        _mm256_add_ps(_mm256_set1_ps(f.destination),
+                      _mm256_mul_ps(_mm256_set1_ps(f.destination_by_source_alpha),
+                                    source_alpha));
+    const __m256 sum = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(s, source_factor), _mm256_mul_ps(d, destination_factor)),
+        _mm256_mul_ps(_mm256_set1_ps(f.product), _mm256_mul_ps(s, d)));
+    return _mm256_max_ps(_mm256_setzero_ps(), _mm256_min_ps(_mm256_set1_ps(1.f), sum));
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON)
+
+// one pixel, clamped
+inline float32x4_t blend_neon(const float32x4_t s, const float32x4_t d, const BlendFactors& f) {
+    const float32x4_t source_alpha = vdupq_n_f32(vgetq_lane_f32(s, 3));
+    const float32x4_t destination_alpha = vdupq_n_f32(vgetq_lane_f32(d, 3));
+    const float32x4_t source_factor = vmlaq_n_f32(vdupq_n_f32(f.source), destination_alpha,
+                                                  f.source_by_destination_alpha);
+    const float32x4_t destination_factor = vmlaq_n_f32(vdupq_n_f32(f.destination),
+                                                       source_alpha,
+                                                       f.destination_by_source_alpha);
+    float32x4_t sum = vmulq_f32(s, source_factor);
+    sum = vmlaq_f32(sum, d, destination_factor);
+    sum = vmlaq_n_f32(sum, vmulq_f32(s, d), f.product);
+    return vmaxq_f32(vdupq_n_f32(0.f), vminq_f32(vdupq_n_f32(1.f), sum));
+}
+
+#endif
+
+}  // namespace detail
+
+inline Color premultiplied(const Color& c) { return Color(c.r * c.a, c.g * c.a, c.b * c.a, c.a); }
+
+inline Color unpremultiplied(const Color& c) {
+    if (!(c.a > 0.f)) {
+        return Color::invisible();
+    }
+    const float inverse = 1 / c.a;
+    return Color(c.r * inverse, c.g * inverse, c.b * inverse, c.a);
+}
+
+inline Color blended(const Color& source, const Color& destination, const BlendMode mode) {
+    const detail::BlendFactors& f = detail::blend_factors(mode);
+    const float sa = source.a;
+    const float da = destination.a;
+    return Color(detail::blend_channel(source.r, destination.r, sa, da, f),
+                 detail::blend_channel(source.g, destination.g, sa, da, f),
+                 detail::blend_channel(source.b, destination.b, sa, da, f),
+                 detail::blend_channel(source.a, destination.a, sa, da, f));
+}
+
+inline void premultiply(Color* colors, const size_t n) {
+    float* floats = reinterpret_cast<float*>(colors);
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    for (; i < n; i++) {
+        _mm_storeu_ps(floats + i * 4, detail::premultiply_sse(_mm_loadu_ps(floats + i * 4)));
+    }
+#else
+    (void)floats;
+#endif
+    for (; i < n; i++) {
+        colors[i] = premultiplied(colors[i]);
+    }
+}
+
+inline void unpremultiply(Color* colors, const size_t n) {
+    float* floats = reinterpret_cast<float*>(colors);
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    for (; i < n; i++) {
+        const __m128 c = detail::unpremultiply_sse(_mm_loadu_ps(floats + i * 4));
+        _mm_storeu_ps(floats + i * 4, detail::clamp_unit_sse(c));
+    }
+#else
+    (void)floats;
+#endif
+    for (; i < n; i++) {
+        colors[i] = unpremultiplied(colors[i]);
+    }
+}
+
+inline void premultiply(uint8_t* rgba, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 pixels[4];
+        detail::load_color32x4_sse(reinterpret_cast<const Color32*>(rgba + i * 4), pixels);
+        for (size_t k = 0; k < 4; k++) {
+            pixels[k] = detail::premultiply_sse(pixels[k]);
+        }
+        detail::store_color32x4_sse(pixels, reinterpret_cast<Color32*>(rgba + i * 4));
+    }
+#endif
+    for (; i < n; i++) {
+        detail::to_bytes(premultiplied(detail::from_bytes(rgba + i * 4)), rgba + i * 4);
+    }
+}
+
+inline void unpremultiply(uint8_t* rgba, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 pixels[4];
+        detail::load_color32x4_sse(reinterpret_cast<const Color32*>(rgba + i * 4), pixels);
+        for (size_t k = 0; k < 4; k++) {
+            pixels[k] = detail::unpremultiply_sse(pixels[k]);
+        }
+        detail::store_color32x4_sse(pixels, reinterpret_cast<Color32*>(rgba + i * 4));
+    }
+#endif
+    for (; i < n; i++) {
+        detail::to_bytes(unpremultiplied(detail::from_bytes(rgba + i * 4)), rgba + i * 4);
+    }
+}
+
+inline void blend(const Color* source, Color* destination, const size_t n, const BlendMode mode) {
+    const float* s = reinterpret_cast<const float*>(source);
+    float* d = reinterpret_cast<float*>(destination);
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 2;
+    for (; i < groups_end; i += 2) {
+        const __m256 result =
+            detail::blend_avx(_mm256_loadu_ps(s + i * 4), _mm256_loadu_ps(d + i * 4), mode);
+        _mm256_storeu_ps(d + i * 4, result);
+    }
+#endif
+#if defined(SML_SIMD_SSE)
+    const detail::BlendFactorsSSE factors = detail::blend_factors_sse(mode);
+    for (; i < n; i++) {
+        const __m128 result =
+            detail::blend_sse(_mm_loadu_ps(s + i * 4), _mm_loadu_ps(d + i * 4), factors);
+        _mm_storeu_ps(d + i * 4, detail::clamp_unit_sse(result));
+    }
+#elif defined(SML_SIMD_NEON)
+    const detail::BlendFactors& factors = detail::blend_factors(mode);
+    for (; i < n; i++) {
+        const float32x4_t result =
+            detail::blend_neon(vld1q_f32(s + i * 4), vld1q_f32(d + i * 4), factors);
+        vst1q_f32(d + i * 4, result);
+    }
+#else
+    (void)s;
+    (void)d;
+#endif
+    for (; i < n; i++) {
+        destination[i] = blended(source[i], destination[i], mode);
+    }
+}
+
+inline void blend(const uint8_t* source_rgba, uint8_t* destination_rgba, const size_t n,
+                  const BlendMode mode) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    const detail::BlendFactorsSSE factors = detail::blend_factors_sse(mode);
+    for (; i < groups_end; i += 4) {
+        __m128 s[4], d[4];
+        detail::load_color32x4_sse(reinterpret_cast<const Color32*>(source_rgba + i * 4), s);
+        detail::load_color32x4_sse(reinterpret_cast<const Color32*>(destination_rgba + i * 4), d);
+        for (size_t k = 0; k < 4; k++) {
+            d[k] = detail::blend_sse(s[k], d[k], factors);
+        }
+        detail::store_color32x4_sse(d, reinterpret_cast<Color32*>(destination_rgba + i * 4));
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    const detail::BlendFactors& factors = detail::blend_factors(mode);
+    for (; i < groups_end; i += 4) {
+        float32x4_t s[4], d[4];
+        detail::load_color32x4_neon(reinterpret_cast<const Color32*>(source_rgba + i * 4), s);
+        detail::load_color32x4_neon(reinterpret_cast<const Color32*>(destination_rgba + i * 4), d);
+        for (size_t k = 0; k < 4; k++) {
+            d[k] = detail::blend_neon(s[k], d[k], factors);
+        }
+        detail::store_color32x4_neon(d, reinterpret_cast<Color32*>(destination_rgba + i * 4));
+    }
+#endif
+    for (; i < n; i++) {
+        const Color result = blended(detail::from_bytes(source_rgba + i * 4),
+                                     detail::from_bytes(destination_rgba + i * 4), mode);
+        detail::to_bytes(result, destination_rgba + i * 4);
+    }
+}
+
+// Color32 spans are RGBA8 spans
+
+inline void premultiply(Color32* colors, const size_t n) {
+    premultiply(reinterpret_cast<uint8_t*>(colors), n);
+}
+
+inline void unpremultiply(Color32* colors, const size_t n) {
+    unpremultiply(reinterpret_cast<uint8_t*>(colors), n);
+}
+
+inline void blend(const Color32* source, Color32* destination, const size_t n,
+                  const BlendMode mode) {
+    blend(reinterpret_cast<const uint8_t*>(source), reinterpret_cast<uint8_t*>(destination), n,
+          mode);
+}
+
+}  // namespace sml
+
+#endif
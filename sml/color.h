@@ -25,7 +25,8 @@
 #include <algorithm>
 #include <cfloat>
 #include <cmath>
-#include <sstream>
+#include <cstdint>
+#include <sml/format.h>
 #include <string>
 
 #define SML_CLAMP_COLOR(c)                   \
@@ -49,6 +50,7 @@ class Color {
 
     // methods
     const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
 
     // convenient
     static Color white();
@@ -58,6 +60,9 @@ class Color {
     static Color blue();
     static Color invisible();
     static Color gray();
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 26;
 };
 
 // Imutable operators
@@ -139,13 +144,18 @@ inline Color Color::gray() { return Color(.5f, .5f, .5f, 1.f); }
 // Methods
 
 inline const std::string Color::to_string() const {
-    std::stringstream stream;
-    stream << "Color #0x" << std::hex << std::uppercase;
-    stream << static_cast<uint16_t>(std::round(r * 0xff))
-           << static_cast<uint16_t>(std::round(g * 0xff))
-           << static_cast<uint16_t>(std::round(b * 0xff))
-           << static_cast<uint16_t>(std::round(a * 0xff));
-    return stream.str();
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Color::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Color #0x");
+    writer.append_hex(static_cast<uint16_t>(std::round(r * 0xff)));
+    writer.append_hex(static_cast<uint16_t>(std::round(g * 0xff)));
+    writer.append_hex(static_cast<uint16_t>(std::round(b * 0xff)));
+    writer.append_hex(static_cast<uint16_t>(std::round(a * 0xff)));
+    return writer.finish();
 }
 
 // Imutable operators
@@ -0,0 +1,290 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_COLOR32_H_
+#define SLIPPYS_MATH_LIBRARY_COLOR32_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <sml/color.h>
+#include <sml/format.h>
+#include <sml/simd.h>
+#include <string>
+
+/*
+
+Color32 is a color as four bytes, r g b a in memory order, the way textures
+and vertex buffers usually store it. It takes 4 bytes where Color takes 16.
+
+Bytes become floats exactly as Color(int, int, int, int) makes them, k / 255.
+The scalar path looks them up in a 256 entry table. The SIMD paths divide,
+because multiplying by 1 / 255 is off by one ulp for about half of the values
+(32-bit NEON has no vector divide and does multiply).
+
+Floats become bytes clamped to [0, 1] and rounded to the nearest of the 256
+steps, ties to even, so a byte that went to float and back is unchanged. The
+saturating packs of the SIMD paths do the final narrowing.
+
+to_colors and from_colors convert whole arrays, 4 colors at a time on SSE and
+NEON.
+
+*/
+
+namespace sml {
+
+class Color32 {
+   public:
+    Color32() = default;
+    // each value is clamped to [0, 255]
+    constexpr Color32(int _r, int _g, int _b, int _a = 0xff);
+    explicit Color32(const Color& c);
+
+    // data
+    uint8_t r, g, b, a;
+
+    // conversion
+    Color to_color() const;
+    constexpr uint32_t to_hex() const;             // 0xRRGGBBAA
+    static constexpr Color32 from_hex(uint32_t rgba);  // 0xRRGGBBAA
+
+    // methods
+    const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
+
+    // whole arrays, 'out' holds n colors
+    static void to_colors(const Color32* in, Color* out, const size_t n);
+    static void from_colors(const Color* in, Color32* out, const size_t n);
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 20;
+};
+
+constexpr bool operator==(const Color32& a, const Color32& b);
+
+constexpr bool operator!=(const Color32& a, const Color32& b);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+constexpr uint8_t clamped_byte(const int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 0xff ? 0xff : value));
+}
+
+// k / 255 for every byte k
+inline const float* unit_from_byte_table() {
+    struct Table {
+        float values[256];
+        Table() {
+            for (int k = 0; k < 256; k++) {
+                values[k] = static_cast<float>(k) / 0xff;
+            }
+        }
+    };
+    static const Table table;
+    return table.values;
+}
+
+inline uint8_t byte_from_unit(const float value) {
+    return static_cast<uint8_t>(std::nearbyint(std::max(0.f, std::min(1.f, value)) * 0xff));
+}
+
+#if defined(SML_SIMD_SSE)
+
+// one color per register
+inline void load_color32x4_sse(const Color32* in, __m128* colors) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+    const __m128 steps = _mm_set1_ps(0xff);
+    colors[0] = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), steps);
+    colors[1] = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), steps);
+    colors[2] = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), steps);
+    colors[3] = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), steps);
+}
+
+inline void store_color32x4_sse(const __m128* colors, Color32* out) {
+    const __m128 steps = _mm_set1_ps(0xff);
+    __m128i rounded[4];
+    for (size_t i = 0; i < 4; i++) {
+        const __m128 unit = _mm_min_ps(_mm_max_ps(colors[i], _mm_setzero_ps()), _mm_set1_ps(1.f));
+        rounded[i] = _mm_cvtps_epi32(_mm_mul_ps(unit, steps));
+    }
+    const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(rounded[0], rounded[1]),
+                                           _mm_packs_epi32(rounded[2], rounded[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON)
+
+inline void load_color32x4_neon(const Color32* in, float32x4_t* colors) {
+    const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(in));
+    const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+    const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+    const uint16x4_t quarters[4] = {vget_low_u16(low), vget_high_u16(low), vget_low_u16(high),
+                                    vget_high_u16(high)};
+    for (size_t i = 0; i < 4; i++) {
+        const float32x4_t steps = vcvtq_f32_u32(vmovl_u16(quarters[i]));
+#if defined(__aarch64__)
+        colors[i] = vdivq_f32(steps, vdupq_n_f32(0xff));
+#else
+        colors[i] = vmulq_n_f32(steps, 1.f / 0xff);
+#endif
+    }
+}
+
+// rounds half up, which only differs from the scalar ties to even on exact halves
+inline void store_color32x4_neon(const float32x4_t* colors, Color32* out) {
+    uint16x4_t halves[4];
+    for (size_t i = 0; i < 4; i++) {
+        const float32x4_t unit =
+            vminq_f32(vmaxq_f32(colors[i], vdupq_n_f32(0.f)), vdupq_n_f32(1.f));
+        halves[i] = vmovn_u32(vcvtq_u32_f32(vmlaq_n_f32(vdupq_n_f32(.5f), unit, 0xff)));
+    }
+    const uint8x8_t low = vmovn_u16(vcombine_u16(halves[0], halves[1]));
+    const uint8x8_t high = vmovn_u16(vcombine_u16(halves[2], halves[3]));
+    vst1q_u8(reinterpret_cast<uint8_t*>(out), vcombine_u8(low, high));
+}
+
+#endif
+
+}  // namespace detail
+
+constexpr Color32::Color32(int _r, int _g, int _b, int _a)
+    : r{detail::clamped_byte(_r)},
+      g{detail::clamped_byte(_g)},
+      b{detail::clamped_byte(_b)},
+      a{detail::clamped_byte(_a)} {}
+
+inline Color32::Color32(const Color& c)
+    : r{detail::byte_from_unit(c.r)},
+      g{detail::byte_from_unit(c.g)},
+      b{detail::byte_from_unit(c.b)},
+      a{detail::byte_from_unit(c.a)} {}
+
+inline Color Color32::to_color() const {
+    const float* unit = detail::unit_from_byte_table();
+    return Color(unit[r], unit[g], unit[b], unit[a]);
+}
+
+constexpr uint32_t Color32::to_hex() const {
+    return static_cast<uint32_t>(r) << 24 | static_cast<uint32_t>(g) << 16 |
+           static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(a);
+}
+
+constexpr Color32 Color32::from_hex(uint32_t rgba) {
+    return Color32(rgba >> 24, rgba >> 16 & 0xff, rgba >> 8 & 0xff, rgba & 0xff);
+}
+
+inline const std::string Color32::to_string() const {
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Color32::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Color32 #0x");
+    for (const uint8_t channel : {r, g, b, a}) {
+        if (channel < 0x10) {
+            writer.append("0");
+        }
+        writer.append_hex(channel);
+    }
+    return writer.finish();
+}
+
+inline void Color32::to_colors(const Color32* in, Color* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 colors[4];
+        detail::load_color32x4_sse(in + i, colors);
+        float* floats = reinterpret_cast<float*>(out + i);
+        for (size_t k = 0; k < 4; k++) {
+            _mm_storeu_ps(floats + k * 4, colors[k]);
+        }
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        float32x4_t colors[4];
+        detail::load_color32x4_neon(in + i, colors);
+        float* floats = reinterpret_cast<float*>(out + i);
+        for (size_t k = 0; k < 4; k++) {
+            vst1q_f32(floats + k * 4, colors[k]);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i].to_color();
+    }
+}
+
+inline void Color32::from_colors(const Color* in, Color32* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        const float* floats = reinterpret_cast<const float*>(in + i);
+        const __m128 colors[4] = {_mm_loadu_ps(floats), _mm_loadu_ps(floats + 4),
+                                  _mm_loadu_ps(floats + 8), _mm_loadu_ps(floats + 12)};
+        detail::store_color32x4_sse(colors, out + i);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        const float* floats = reinterpret_cast<const float*>(in + i);
+        const float32x4_t colors[4] = {vld1q_f32(floats), vld1q_f32(floats + 4),
+                                       vld1q_f32(floats + 8), vld1q_f32(floats + 12)};
+        detail::store_color32x4_neon(colors, out + i);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Color32(in[i]);
+    }
+}
+
+constexpr bool operator==(const Color32& a, const Color32& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+constexpr bool operator!=(const Color32& a, const Color32& b) { return !(a == b); }
+
+}  // namespace sml
+
+namespace std {
+
+inline string to_string(const sml::Color32& c) { return c.to_string(); }
+
+}  // namespace std
+
+#endif
@@ -0,0 +1,467 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_COMPARE_H_
+#define SLIPPYS_MATH_LIBRARY_COMPARE_H_
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sml/matrix4.h>
+#include <sml/quaternion.h>
+#include <sml/simd.h>
+#include <sml/vector3.h>
+
+/*
+
+Tolerant comparison of whole arrays, for finding which elements changed between
+two snapshots. An element changed when any of its floats differs by more than
+the tolerance:
+
+  ABSOLUTE_ERROR   |a - b| > value
+  RELATIVE_ERROR   |a - b| > value * max(|a|, |b|)
+  ULPS             more than 'ulps' representable floats lie between a and b
+
+ULP distances treat +0 and -0 as the same value. A NaN on either side always
+counts as a change, unlike operator== which lets NaNs through.
+
+Results come either as a bitmask, one bit per element, least significant bit
+first (the same layout Frustum culling writes):
+
+  changed[i / 8] & (1 << (i % 8))
+
+or as the list of changed indices. Both return how many elements changed.
+
+*/
+
+namespace sml {
+
+struct Tolerance {
+    enum Mode { ABSOLUTE_ERROR, RELATIVE_ERROR, ULPS };
+
+    Mode mode;
+    float value;
+    uint32_t ulps;
+
+    static Tolerance absolute(const float value);
+    static Tolerance relative(const float value);
+    static Tolerance within_ulps(const uint32_t ulps);
+
+    // what operator== uses
+    static Tolerance epsilon();
+};
+
+// single elements
+bool nearly_equal(const Vec3& a, const Vec3& b, const Tolerance& tolerance);
+bool nearly_equal(const Quat& a, const Quat& b, const Tolerance& tolerance);
+bool nearly_equal(const Mat4& a, const Mat4& b, const Tolerance& tolerance);
+
+// 'changed' holds (n + 7) / 8 bytes
+size_t changed_mask(const Vec3* a, const Vec3* b, const size_t n, const Tolerance& tolerance,
+                    uint8_t* changed);
+size_t changed_mask(const Quat* a, const Quat* b, const size_t n, const Tolerance& tolerance,
+                    uint8_t* changed);
+size_t changed_mask(const Mat4* a, const Mat4* b, const size_t n, const Tolerance& tolerance,
+                    uint8_t* changed);
+
+// 'indices' holds up to n entries
+size_t changed_indices(const Vec3* a, const Vec3* b, const size_t n, const Tolerance& tolerance,
+                       uint32_t* indices);
+size_t changed_indices(const Quat* a, const Quat* b, const size_t n, const Tolerance& tolerance,
+                       uint32_t* indices);
+size_t changed_indices(const Mat4* a, const Mat4* b, const size_t n, const Tolerance& tolerance,
+                       uint32_t* indices);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+inline Tolerance Tolerance::absolute(const float value) { return {ABSOLUTE_ERROR, value, 0}; }
+
+inline Tolerance Tolerance::relative(const float value) { return {RELATIVE_ERROR, value, 0}; }
+
+inline Tolerance Tolerance::within_ulps(const uint32_t ulps) { return {ULPS, 0.f, ulps}; }
+
+inline Tolerance Tolerance::epsilon() { return absolute(FLT_EPSILON); }
+
+// Kernels
+
+namespace detail {
+
+// float bits as integers that grow with the value, -0 and +0 both map to 0
+inline int64_t ordered_float_bits(const float f) {
+    int32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits < 0 ? -static_cast<int64_t>(bits & 0x7fffffff) : bits;
+}
+
+inline bool float_changed(const float a, const float b, const Tolerance& tolerance) {
+    if (tolerance.mode == Tolerance::ULPS) {
+        if (std::isnan(a) || std::isnan(b)) {
+            return true;
+        }
+        const int64_t distance = ordered_float_bits(a) - ordered_float_bits(b);
+        return (distance < 0 ? -distance : distance) > tolerance.ulps;
+    }
+    const float limit = tolerance.mode == Tolerance::RELATIVE_ERROR
+                            ? tolerance.value * std::fmax(std::fabs(a), std::fabs(b))
+                            : tolerance.value;
+    return !(std::fabs(a - b) <= limit);  // NaNs fail every comparison
+}
+
+inline bool floats_changed(const float* a, const float* b, const size_t n,
+                           const Tolerance& tolerance) {
+    for (size_t i = 0; i < n; i++) {
+        if (float_changed(a[i], b[i], tolerance)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+Each test below answers "which of up to 8 elements of 'components' floats
+changed" as one byte. The SIMD tests only differ in how they compare 4 lanes,
+so the mode is picked once per array instead of once per vector.
+*/
+
+struct ScalarChangeTest {
+    uint8_t changed_byte(const float* a, const float* b, const size_t count,
+                         const size_t components) const {
+        uint8_t bits = 0;
+        for (size_t e = 0; e < count; e++) {
+            const size_t i = e * components;
+            bits |= static_cast<uint8_t>(
+                (floats_changed(a + i, b + i, components, tolerance) ? 1 : 0) << e);
+        }
+        return bits;
+    }
+
+    Tolerance tolerance;
+};
+
+#if defined(SML_SIMD_SSE)
+
+// !(x <= limit) rather than x > limit, so that NaNs count as changes
+
+struct AbsoluteChangeTestSSE {
+    explicit AbsoluteChangeTestSSE(const Tolerance& t)
+        : tolerance{t}, limit{_mm_set1_ps(t.value)} {}
+
+    __m128 changed(const __m128 a, const __m128 b) const {
+        const __m128 difference = _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(a, b));
+        return _mm_cmpnle_ps(difference, limit);
+    }
+
+    Tolerance tolerance;
+    __m128 limit;
+};
+
+struct RelativeChangeTestSSE {
+    explicit RelativeChangeTestSSE(const Tolerance& t)
+        : tolerance{t}, ratio{_mm_set1_ps(t.value)} {}
+
+    __m128 changed(const __m128 a, const __m128 b) const {
+        const __m128 sign = _mm_set1_ps(-0.f);
+        const __m128 difference = _mm_andnot_ps(sign, _mm_sub_ps(a, b));
+        const __m128 largest = _mm_max_ps(_mm_andnot_ps(sign, a), _mm_andnot_ps(sign, b));
+        return _mm_cmpnle_ps(difference, _mm_mul_ps(ratio, largest));
+    }
+
+    Tolerance tolerance;
+    __m128 ratio;
+};
+
+struct UlpChangeTestSSE {
+    explicit UlpChangeTestSSE(const Tolerance& t)
+        : tolerance{t}, ulps{_mm_set1_epi32(static_cast<int32_t>(t.ulps ^ 0x80000000u))} {}
+
+    static __m128i ordered_bits(const __m128 f) {
+        const __m128i bits = _mm_castps_si128(f);
+        const __m128i negative = _mm_srai_epi32(bits, 31);
+        const __m128i flipped = _mm_sub_epi32(_mm_set1_epi32(INT32_MIN), bits);
+        return _mm_or_si128(_mm_and_si128(negative, flipped), _mm_andnot_si128(negative, bits));
+    }
+
+    __m128 changed(const __m128 a, const __m128 b) const {
+        // distances reach 2^32 - 1, so they are compared as unsigned numbers by
+        // flipping the top bit of both sides ('ulps' is stored flipped)
+        const __m128i ordered_a = ordered_bits(a);
+        const __m128i ordered_b = ordered_bits(b);
+        const __m128i smaller = _mm_cmplt_epi32(ordered_a, ordered_b);
+        const __m128i difference = _mm_sub_epi32(ordered_a, ordered_b);
+        const __m128i distance = _mm_sub_epi32(_mm_xor_si128(difference, smaller), smaller);
+        const __m128i beyond =
+            _mm_cmpgt_epi32(_mm_xor_si128(distance, _mm_set1_epi32(INT32_MIN)), ulps);
+        return _mm_or_ps(_mm_cmpunord_ps(a, b), _mm_castsi128_ps(beyond));
+    }
+
+    Tolerance tolerance;
+    __m128i ulps;
+};
+
+template <typename Test>
+inline uint8_t changed_byte_sse(const Test& test, const float* a, const float* b,
+                                const size_t count, const size_t components) {
+    uint8_t bits = 0;
+    if (components % 4 == 0) {
+        // Quat, Mat4: OR the element's vectors together
+        for (size_t e = 0; e < count; e++) {
+            const float* element_a = a + e * components;
+            const float* element_b = b + e * components;
+            __m128 changed = test.changed(_mm_loadu_ps(element_a), _mm_loadu_ps(element_b));
+            for (size_t c = 4; c < components; c += 4) {
+                changed = _mm_or_ps(changed, test.changed(_mm_loadu_ps(element_a + c),
+                                                          _mm_loadu_ps(element_b + c)));
+            }
+            bits |= static_cast<uint8_t>((_mm_movemask_ps(changed) != 0 ? 1 : 0) << e);
+        }
+        return bits;
+    }
+    if (components == 3 && count == 8) {
+        // 8 Vec3 are 6 vectors, the lane bits are then regrouped in threes
+        uint32_t lanes = 0;
+        for (size_t v = 0; v < 6; v++) {
+            const __m128 changed = test.changed(_mm_loadu_ps(a + v * 4), _mm_loadu_ps(b + v * 4));
+            lanes |= static_cast<uint32_t>(_mm_movemask_ps(changed)) << (v * 4);
+        }
+        // element e now sits on bit 3e, squeeze bits 0, 3, ..., 21 into 0..7
+        lanes = (lanes | (lanes >> 1) | (lanes >> 2)) & 0x249249;
+        lanes = (lanes | (lanes >> 2)) & 0x0c30c3;
+        lanes = (lanes | (lanes >> 4)) & 0x00f00f;
+        return static_cast<uint8_t>(lanes | (lanes >> 8));
+    }
+    return ScalarChangeTest{test.tolerance}.changed_byte(a, b, count, components);
+}
+
+inline uint8_t changed_byte(const AbsoluteChangeTestSSE& test, const float* a, const float* b,
+                            const size_t count, const size_t components) {
+    return changed_byte_sse(test, a, b, count, components);
+}
+
+inline uint8_t changed_byte(const RelativeChangeTestSSE& test, const float* a, const float* b,
+                            const size_t count, const size_t components) {
+    return changed_byte_sse(test, a, b, count, components);
+}
+
+inline uint8_t changed_byte(const UlpChangeTestSSE& test, const float* a, const float* b,
+                            const size_t count, const size_t components) {
+    return changed_byte_sse(test, a, b, count, components);
+}
+
+#elif defined(SML_SIMD_NEON)
+
+struct ChangeTestNEON {
+    explicit ChangeTestNEON(const Tolerance& t)
+        : tolerance{t},
+          absolute{vdupq_n_f32(t.mode == Tolerance::ABSOLUTE_ERROR ? t.value : 0.f)},
+          relative{vdupq_n_f32(t.mode == Tolerance::RELATIVE_ERROR ? t.value : 0.f)},
+          ulps{vdupq_n_u32(t.ulps)} {}
+
+    static int32x4_t ordered_bits(const float32x4_t f) {
+        const int32x4_t bits = vreinterpretq_s32_f32(f);
+        const uint32x4_t negative = vcltq_s32(bits, vdupq_n_s32(0));
+        return vbslq_s32(negative, vsubq_s32(vdupq_n_s32(INT32_MIN), bits), bits);
+    }
+
+    uint32x4_t changed(const float32x4_t a, const float32x4_t b) const {
+        const uint32x4_t ordered = vandq_u32(vceqq_f32(a, a), vceqq_f32(b, b));
+        if (tolerance.mode == Tolerance::ULPS) {
+            const uint32x4_t distance =
+                vreinterpretq_u32_s32(vabdq_s32(ordered_bits(a), ordered_bits(b)));
+            return vorrq_u32(vmvnq_u32(ordered), vcgtq_u32(distance, ulps));
+        }
+        const float32x4_t largest = vmaxq_f32(vabsq_f32(a), vabsq_f32(b));
+        const float32x4_t limit = vaddq_f32(absolute, vmulq_f32(relative, largest));
+        return vmvnq_u32(vcleq_f32(vabdq_f32(a, b), limit));
+    }
+
+    Tolerance tolerance;
+    float32x4_t absolute;
+    float32x4_t relative;
+    uint32x4_t ulps;
+};
+
+inline uint8_t changed_byte(const ChangeTestNEON& test, const float* a, const float* b,
+                            const size_t count, const size_t components) {
+    if (components % 4 != 0) {
+        return ScalarChangeTest{test.tolerance}.changed_byte(a, b, count, components);
+    }
+    uint8_t bits = 0;
+    for (size_t e = 0; e < count; e++) {
+        const float* element_a = a + e * components;
+        const float* element_b = b + e * components;
+        uint32x4_t changed = test.changed(vld1q_f32(element_a), vld1q_f32(element_b));
+        for (size_t c = 4; c < components; c += 4) {
+            changed = vorrq_u32(changed,
+                                test.changed(vld1q_f32(element_a + c), vld1q_f32(element_b + c)));
+        }
+        const uint32x2_t half = vorr_u32(vget_low_u32(changed), vget_high_u32(changed));
+        const bool any = (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+        bits |= static_cast<uint8_t>((any ? 1 : 0) << e);
+    }
+    return bits;
+}
+
+#endif
+
+inline uint8_t changed_byte(const ScalarChangeTest& test, const float* a, const float* b,
+                            const size_t count, const size_t components) {
+    return test.changed_byte(a, b, count, components);
+}
+
+template <typename Test>
+inline size_t changed_mask(const Test& test, const float* a, const float* b, const size_t n,
+                           const size_t components, uint8_t* changed) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += 8) {
+        const size_t elements = n - i < 8 ? n - i : 8;
+        uint8_t bits =
+            changed_byte(test, a + i * components, b + i * components, elements, components);
+        changed[i / 8] = bits;
+        for (; bits != 0; bits &= bits - 1) {
+            count++;
+        }
+    }
+    return count;
+}
+
+template <typename Test>
+inline size_t changed_indices(const Test& test, const float* a, const float* b, const size_t n,
+                              const size_t components, uint32_t* indices) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += 8) {
+        const size_t elements = n - i < 8 ? n - i : 8;
+        const uint8_t bits =
+            changed_byte(test, a + i * components, b + i * components, elements, components);
+        // branch-free: every slot is written, only the changed ones are kept
+        for (size_t e = 0; e < elements; e++) {
+            indices[count] = static_cast<uint32_t>(i + e);
+            count += (bits >> e) & 1;
+        }
+    }
+    return count;
+}
+
+inline size_t changed_mask(const float* a, const float* b, const size_t n,
+                           const size_t components, const Tolerance& tolerance,
+                           uint8_t* changed) {
+#if defined(SML_SIMD_SSE)
+    switch (tolerance.mode) {
+        case Tolerance::ABSOLUTE_ERROR:
+            return changed_mask(AbsoluteChangeTestSSE(tolerance), a, b, n, components, changed);
+        case Tolerance::RELATIVE_ERROR:
+            return changed_mask(RelativeChangeTestSSE(tolerance), a, b, n, components, changed);
+        case Tolerance::ULPS:
+            return changed_mask(UlpChangeTestSSE(tolerance), a, b, n, components, changed);
+    }
+    return 0;
+#elif defined(SML_SIMD_NEON)
+    return changed_mask(ChangeTestNEON(tolerance), a, b, n, components, changed);
+#else
+    return changed_mask(ScalarChangeTest{tolerance}, a, b, n, components, changed);
+#endif
+}
+
+inline size_t changed_indices(const float* a, const float* b, const size_t n,
+                              const size_t components, const Tolerance& tolerance,
+                              uint32_t* indices) {
+#if defined(SML_SIMD_SSE)
+    switch (tolerance.mode) {
+        case Tolerance::ABSOLUTE_ERROR:
+            return changed_indices(AbsoluteChangeTestSSE(tolerance), a, b, n, components, indices);
+        case Tolerance::RELATIVE_ERROR:
+            return changed_indices(RelativeChangeTestSSE(tolerance), a, b, n, components, indices);
+        case Tolerance::ULPS:
+            return changed_indices(UlpChangeTestSSE(tolerance), a, b, n, components, indices);
+    }
+    return 0;
+#elif defined(SML_SIMD_NEON)
+    return changed_indices(ChangeTestNEON(tolerance), a, b, n, components, indices);
+#else
+    return changed_indices(ScalarChangeTest{tolerance}, a, b, n, components, indices);
+#endif
+}
+
+}  // namespace detail
+
+// Single elements
+
+inline bool nearly_equal(const Vec3& a, const Vec3& b, const Tolerance& tolerance) {
+    return !detail::floats_changed(reinterpret_cast<const float*>(&a),
+                                   reinterpret_cast<const float*>(&b), 3, tolerance);
+}
+
+inline bool nearly_equal(const Quat& a, const Quat& b, const Tolerance& tolerance) {
+    return !detail::floats_changed(reinterpret_cast<const float*>(&a),
+                                   reinterpret_cast<const float*>(&b), 4, tolerance);
+}
+
+inline bool nearly_equal(const Mat4& a, const Mat4& b, const Tolerance& tolerance) {
+    return !detail::floats_changed(a.data(), b.data(), 16, tolerance);
+}
+
+// Arrays
+
+inline size_t changed_mask(const Vec3* a, const Vec3* b, const size_t n,
+                           const Tolerance& tolerance, uint8_t* changed) {
+    return detail::changed_mask(reinterpret_cast<const float*>(a),
+                                reinterpret_cast<const float*>(b), n, 3, tolerance, changed);
+}
+
+inline size_t changed_mask(const Quat* a, const Quat* b, const size_t n,
+                           const Tolerance& tolerance, uint8_t* changed) {
+    return detail::changed_mask(reinterpret_cast<const float*>(a),
+                                reinterpret_cast<const float*>(b), n, 4, tolerance, changed);
+}
+
+inline size_t changed_mask(const Mat4* a, const Mat4* b, const size_t n,
+                           const Tolerance& tolerance, uint8_t* changed) {
+    return detail::changed_mask(reinterpret_cast<const float*>(a),
+                                reinterpret_cast<const float*>(b), n, 16, tolerance, changed);
+}
+
+inline size_t changed_indices(const Vec3* a, const Vec3* b, const size_t n,
+                              const Tolerance& tolerance, uint32_t* indices) {
+    return detail::changed_indices(reinterpret_cast<const float*>(a),
+                                   reinterpret_cast<const float*>(b), n, 3, tolerance, indices);
+}
+
+inline size_t changed_indices(const Quat* a, const Quat* b, const size_t n,
+                              const Tolerance& tolerance, uint32_t* indices) {
+    return detail::changed_indices(reinterpret_cast<const float*>(a),
+                                   reinterpret_cast<const float*>(b), n, 4, tolerance, indices);
+}
+
+inline size_t changed_indices(const Mat4* a, const Mat4* b, const size_t n,
+                              const Tolerance& tolerance, uint32_t* indices) {
+    return detail::changed_indices(reinterpret_cast<const float*>(a),
+                                   reinterpret_cast<const float*>(b), n, 16, tolerance, indices);
+}
+
+}  // namespace sml
+
+#endif
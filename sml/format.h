@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_FORMAT_H_
+#define SLIPPYS_MATH_LIBRARY_FORMAT_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define SML_HAS_TO_CHARS
+#endif
+
+/*
+
+Allocation-free formatting
+
+Every type exposes format_to(buffer, capacity), which writes the same text as
+its to_string() into a caller-provided buffer. It follows snprintf semantics:
+the output is always null-terminated when capacity > 0, it is truncated when it
+does not fit, and the return value is the length the full text needs. Each type
+also advertises FORMAT_CAPACITY, a buffer size that always fits its text.
+
+Numbers go through std::to_chars when the standard library has it and through
+snprintf on a stack buffer otherwise, except the "%+#.4g" ones, which always
+use snprintf so they print the same under every standard. Neither touches the
+heap.
+
+*/
+
+namespace sml {
+
+namespace detail {
+
+class FormatWriter {
+   public:
+    FormatWriter(char* buffer, size_t capacity);
+
+    void append(const char* text);
+    void append(const char* text, size_t length);
+
+    // "%+.2f"
+    void append_fixed(float value);
+    // "%g"
+    void append_general(float value);
+    // "%+#.4g"
+    void append_precise(float value);
+    // "%X"
+    void append_hex(unsigned value);
+
+    // Accounts for text someone else already wrote at the current position.
+    void skip(size_t length);
+
+    size_t length() const;
+    size_t finish();
+
+   private:
+    char* _buffer;
+    size_t _capacity;
+    size_t _length;
+};
+
+inline FormatWriter::FormatWriter(char* buffer, size_t capacity)
+    : _buffer{buffer}, _capacity{capacity}, _length{0} {}
+
+inline void FormatWriter::append(const char* text) { append(text, std::strlen(text)); }
+
+inline void FormatWriter::append(const char* text, size_t length) {
+    if (_length + 1 < _capacity) {
+        const size_t room = _capacity - 1 - _length;
+        std::memcpy(_buffer + _length, text, length < room ? length : room);
+    }
+    _length += length;
+}
+
+inline void FormatWriter::append_fixed(float value) {
+    char number[64];
+#if defined(SML_HAS_TO_CHARS)
+    // to_chars has no showpos flag, so the sign goes in front by hand.
+    const std::to_chars_result result =
+        std::to_chars(number + 1, number + sizeof(number), value, std::chars_format::fixed, 2);
+    if (number[1] == '-') {
+        append(number + 1, static_cast<size_t>(result.ptr - number - 1));
+    } else {
+        number[0] = '+';
+        append(number, static_cast<size_t>(result.ptr - number));
+    }
+#else
+    const int length = std::snprintf(number, sizeof(number), "%+.2f", value);
+    append(number, static_cast<size_t>(length));
+#endif
+}
+
+inline void FormatWriter::append_general(float value) {
+    char number[32];
+#if defined(SML_HAS_TO_CHARS)
+    const std::to_chars_result result =
+        std::to_chars(number, number + sizeof(number), value, std::chars_format::general, 6);
+    append(number, static_cast<size_t>(result.ptr - number));
+#else
+    const int length = std::snprintf(number, sizeof(number), "%g", value);
+    append(number, static_cast<size_t>(length));
+#endif
+}
+
+inline void FormatWriter::append_precise(float value) {
+    // Always snprintf: when rounding carries into a new digit ("%+#.4g" of
+    // 9999.5 is "+1.e+04" in glibc) to_chars pads differently, and the text
+    // must not depend on the language standard.
+    char number[32];
+    const int length = std::snprintf(number, sizeof(number), "%+#.4g", value);
+    append(number, static_cast<size_t>(length));
+}
+
+inline void FormatWriter::append_hex(unsigned value) {
+    static const char DIGITS[] = "0123456789ABCDEF";
+    char number[sizeof(unsigned) * 2];
+    size_t length = 0;
+    do {
+        number[sizeof(number) - 1 - length] = DIGITS[value & 0xf];
+        value >>= 4;
+        length++;
+    } while (value != 0);
+    append(number + sizeof(number) - length, length);
+}
+
+inline void FormatWriter::skip(size_t length) { _length += length; }
+
+inline size_t FormatWriter::length() const { return _length; }
+
+inline size_t FormatWriter::finish() {
+    if (_capacity > 0) {
+        _buffer[_length < _capacity ? _length : _capacity - 1] = '\0';
+    }
+    return _length;
+}
+
+}  // namespace detail
+
+/*
+Writes count values back to back, each followed by separator, with the same
+truncation rules and return value as the single-value writers.
+*/
+template <typename T>
+size_t format_array(const T* values, size_t count, char* buffer, size_t capacity,
+                    const char* separator = "\n") {
+    detail::FormatWriter writer(buffer, capacity);
+    for (size_t i = 0; i < count; i++) {
+        const size_t length = writer.length();
+        if (length < capacity) {
+            writer.skip(values[i].format_to(buffer + length, capacity - length));
+        } else {
+            writer.skip(values[i].format_to(nullptr, 0));
+        }
+        writer.append(separator);
+    }
+    return writer.finish();
+}
+
+}  // namespace sml
+
+#endif
@@ -0,0 +1,330 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_FRUSTUM_H_
+#define SLIPPYS_MATH_LIBRARY_FRUSTUM_H_
+
+#include <cmath>
+#include <cstdint>
+#include <sml/matrix4.h>
+#include <sml/simd.h>
+#include <sml/vector3.h>
+
+/*
+
+Frustum planes are read straight off a projection (or view-projection) matrix.
+Clip space keeps a point when -w <= x, y, z <= w, which is the volume both
+Mat4::orthogonal_projection and Mat4::conical_projection map to. Every bound is
+a sum or difference of two rows of the matrix:
+
+  left   = row3 + row0    right = row3 - row0
+  bottom = row3 + row1    top   = row3 - row1
+  near   = row3 + row2    far   = row3 - row2
+
+The planes are normalized, so normal.dot(p) + distance is the signed distance of
+p to the plane, positive on the inside. A NaN distance never counts as inside,
+so an object with a NaN coordinate, radius or extent is culled, by the single
+tests and the batch ones alike.
+
+Batch culling reads objects as separate x, y, z (and radius or extent) arrays
+and writes one bit per object, least significant bit first:
+
+  visible[i / 8] & (1 << (i % 8))
+
+*/
+
+namespace sml {
+
+struct Plane {
+    Vec3 normal;
+    float distance;
+};
+
+class Frustum {
+   public:
+    Frustum();
+    explicit Frustum(const Mat4& m);
+
+    // data (left, right, bottom, top, near, far)
+    Plane planes[6];
+
+    // single tests
+    bool contains(const Vec3& point) const;
+    bool intersects_sphere(const Vec3& center, const float radius) const;
+    bool intersects_aabb(const Vec3& center, const Vec3& extents) const;
+
+    // batch tests ('visible' holds (n + 7) / 8 bytes), return how many objects are visible
+    size_t cull_spheres(const float* x, const float* y, const float* z, const float* radius,
+                        const size_t n, uint8_t* visible) const;
+    size_t cull_aabbs(const float* x, const float* y, const float* z, const float* extent_x,
+                      const float* extent_y, const float* extent_z, const size_t n,
+                      uint8_t* visible) const;
+
+    // turns a visibility mask into the list of visible indices, returns its length
+    static size_t visible_indices(const uint8_t* visible, const size_t n, uint32_t* indices);
+
+    static const size_t PLANES = 6;
+};
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+// Helpers
+
+namespace detail {
+
+inline size_t count_bits(uint8_t bits) {
+    size_t count = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        count++;
+    }
+    return count;
+}
+
+}  // namespace detail
+
+// Constructors
+
+inline Frustum::Frustum() : Frustum(Mat4::identity()) {}
+
+inline Frustum::Frustum(const Mat4& m) : planes{} {
+    for (size_t i = 0; i < Frustum::PLANES; i++) {
+        const size_t row = i / 2;
+        const float sign = (i % 2 == 0) ? 1.f : -1.f;
+
+        const Vec3 normal(m[0][3] + sign * m[0][row], m[1][3] + sign * m[1][row],
+                          m[2][3] + sign * m[2][row]);
+        const float normalization = 1.f / normal.length();
+
+        planes[i].normal = normal * normalization;
+        planes[i].distance = (m[3][3] + sign * m[3][row]) * normalization;
+    }
+}
+
+// Single tests
+
+inline bool Frustum::contains(const Vec3& point) const { return intersects_sphere(point, 0.f); }
+
+inline bool Frustum::intersects_sphere(const Vec3& center, const float radius) const {
+    for (size_t i = 0; i < Frustum::PLANES; i++) {
+        if (!(planes[i].normal.dot(center) + planes[i].distance >= -radius)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool Frustum::intersects_aabb(const Vec3& center, const Vec3& extents) const {
+    for (size_t i = 0; i < Frustum::PLANES; i++) {
+        const Vec3& normal = planes[i].normal;
+        const float reach = std::fabs(normal.x) * extents.x + std::fabs(normal.y) * extents.y +
+                            std::fabs(normal.z) * extents.z;
+        if (!(normal.dot(center) + planes[i].distance >= -reach)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Batch tests
+
+/*
+Both batch tests come down to the same check against every plane:
+
+  normal.dot(center) + distance >= -reach
+
+where the reach of a sphere is its radius, and the reach of a box is its
+extents projected on the plane normal. Eight objects are tested per AVX step,
+four per SSE step, and the rest one by one.
+*/
+inline size_t Frustum::cull_spheres(const float* x, const float* y, const float* z,
+                                    const float* radius, const size_t n, uint8_t* visible) const {
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(SML_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(x + i);
+        const __m256 cy = _mm256_loadu_ps(y + i);
+        const __m256 cz = _mm256_loadu_ps(z + i);
+        const __m256 reach = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t p = 0; p < Frustum::PLANES; p++) {
+            const Vec3& normal = planes[p].normal;
+            __m256 d = _mm256_mul_ps(_mm256_set1_ps(normal.x), cx);
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(normal.y), cy));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(normal.z), cz));
+            d = _mm256_add_ps(d, _mm256_set1_ps(planes[p].distance));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, reach, _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        visible[i / 8] = static_cast<uint8_t>(mask);
+        count += detail::count_bits(static_cast<uint8_t>(mask));
+    }
+#elif defined(SML_SIMD_SSE)
+    for (; i + 8 <= n; i += 8) {
+        int mask = 0;
+        for (size_t half = 0; half < 2; half++) {
+            const size_t j = i + half * 4;
+            const __m128 cx = _mm_loadu_ps(x + j);
+            const __m128 cy = _mm_loadu_ps(y + j);
+            const __m128 cz = _mm_loadu_ps(z + j);
+            const __m128 reach = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + j));
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (size_t p = 0; p < Frustum::PLANES; p++) {
+                const Vec3& normal = planes[p].normal;
+                __m128 d = _mm_mul_ps(_mm_set1_ps(normal.x), cx);
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(normal.y), cy));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(normal.z), cz));
+                d = _mm_add_ps(d, _mm_set1_ps(planes[p].distance));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, reach));
+            }
+            mask |= _mm_movemask_ps(inside) << (half * 4);
+        }
+
+        visible[i / 8] = static_cast<uint8_t>(mask);
+        count += detail::count_bits(static_cast<uint8_t>(mask));
+    }
+#endif
+
+    for (; i < n; i++) {
+        const uint8_t bit = static_cast<uint8_t>(1 << (i % 8));
+        if (i % 8 == 0) {
+            visible[i / 8] = 0;
+        }
+        if (intersects_sphere(Vec3(x[i], y[i], z[i]), radius[i])) {
+            visible[i / 8] |= bit;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+inline size_t Frustum::cull_aabbs(const float* x, const float* y, const float* z,
+                                  const float* extent_x, const float* extent_y,
+                                  const float* extent_z, const size_t n, uint8_t* visible) const {
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(SML_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(x + i);
+        const __m256 cy = _mm256_loadu_ps(y + i);
+        const __m256 cz = _mm256_loadu_ps(z + i);
+        const __m256 ex = _mm256_loadu_ps(extent_x + i);
+        const __m256 ey = _mm256_loadu_ps(extent_y + i);
+        const __m256 ez = _mm256_loadu_ps(extent_z + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t p = 0; p < Frustum::PLANES; p++) {
+            const Vec3& normal = planes[p].normal;
+            __m256 d = _mm256_mul_ps(_mm256_set1_ps(normal.x), cx);
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(normal.y), cy));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(normal.z), cz));
+            d = _mm256_add_ps(d, _mm256_set1_ps(planes[p].distance));
+
+            __m256 reach = _mm256_mul_ps(_mm256_set1_ps(std::fabs(normal.x)), ex);
+            reach = _mm256_add_ps(reach, _mm256_mul_ps(_mm256_set1_ps(std::fabs(normal.y)), ey));
+            reach = _mm256_add_ps(reach, _mm256_mul_ps(_mm256_set1_ps(std::fabs(normal.z)), ez));
+
+            inside = _mm256_and_ps(
+                inside, _mm256_cmp_ps(d, _mm256_sub_ps(_mm256_setzero_ps(), reach), _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        visible[i / 8] = static_cast<uint8_t>(mask);
+        count += detail::count_bits(static_cast<uint8_t>(mask));
+    }
+#elif defined(SML_SIMD_SSE)
+    for (; i + 8 <= n; i += 8) {
+        int mask = 0;
+        for (size_t half = 0; half < 2; half++) {
+            const size_t j = i + half * 4;
+            const __m128 cx = _mm_loadu_ps(x + j);
+            const __m128 cy = _mm_loadu_ps(y + j);
+            const __m128 cz = _mm_loadu_ps(z + j);
+            const __m128 ex = _mm_loadu_ps(extent_x + j);
+            const __m128 ey = _mm_loadu_ps(extent_y + j);
+            const __m128 ez = _mm_loadu_ps(extent_z + j);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (size_t p = 0; p < Frustum::PLANES; p++) {
+                const Vec3& normal = planes[p].normal;
+                __m128 d = _mm_mul_ps(_mm_set1_ps(normal.x), cx);
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(normal.y), cy));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(normal.z), cz));
+                d = _mm_add_ps(d, _mm_set1_ps(planes[p].distance));
+
+                __m128 reach = _mm_mul_ps(_mm_set1_ps(std::fabs(normal.x)), ex);
+                reach = _mm_add_ps(reach, _mm_mul_ps(_mm_set1_ps(std::fabs(normal.y)), ey));
+                reach = _mm_add_ps(reach, _mm_mul_ps(_mm_set1_ps(std::fabs(normal.z)), ez));
+
+                inside = _mm_and_ps(inside,
+                                    _mm_cmpge_ps(d, _mm_sub_ps(_mm_setzero_ps(), reach)));
+            }
+            mask |= _mm_movemask_ps(inside) << (half * 4);
+        }
+
+        visible[i / 8] = static_cast<uint8_t>(mask);
+        count += detail::count_bits(static_cast<uint8_t>(mask));
+    }
+#endif
+
+    for (; i < n; i++) {
+        const uint8_t bit = static_cast<uint8_t>(1 << (i % 8));
+        if (i % 8 == 0) {
+            visible[i / 8] = 0;
+        }
+        if (intersects_aabb(Vec3(x[i], y[i], z[i]), Vec3(extent_x[i], extent_y[i], extent_z[i]))) {
+            visible[i / 8] |= bit;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+inline size_t Frustum::visible_indices(const uint8_t* visible, const size_t n,
+                                       uint32_t* indices) {
+    size_t count = 0;
+    for (size_t byte = 0; byte * 8 < n; byte++) {
+        const uint8_t bits = visible[byte];
+        for (size_t bit = 0; bits >> bit != 0 && byte * 8 + bit < n; bit++) {
+            if (bits & (1 << bit)) {
+                indices[count++] = static_cast<uint32_t>(byte * 8 + bit);
+            }
+        }
+    }
+    return count;
+}
+
+}  // namespace sml
+
+#endif
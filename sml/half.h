@@ -0,0 +1,371 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_HALF_H_
+#define SLIPPYS_MATH_LIBRARY_HALF_H_
+
+#include <cstdint>
+#include <cstring>
+#include <sml/color.h>
+#include <sml/quaternion.h>
+#include <sml/simd.h>
+#include <sml/vector3.h>
+
+/*
+
+Half-precision storage
+
+Vec3h, Quath and Colorh hold IEEE 754 binary16 bit patterns: 1 sign bit, 5
+exponent bits and 10 mantissa bits. That is about 3 decimal digits, values up
+to 65504 and a step of 2^-24 near zero. They are meant for storing and
+uploading big buffers at half the size; convert back to the float types to do
+any math.
+
+Conversion to half rounds to nearest even. Values too large become infinity and
+NaNs stay NaNs. Conversion back to float is exact.
+
+The bulk routines use F16C when the compiler targets it (-mf16c, or any
+-march from Ivy Bridge on). Plain SSE2 builds run the same bit tricks as the
+scalar path on 4 lanes at once, which stays correct with denormals-are-zero
+enabled.
+
+*/
+
+namespace sml {
+
+class Vec3h {
+   public:
+    Vec3h() = default;
+    explicit Vec3h(const Vec3& v);
+
+    // data
+    uint16_t x, y, z;
+
+    Vec3 to_vec3() const;
+};
+
+class Quath {
+   public:
+    Quath() = default;
+    explicit Quath(const Quat& q);
+
+    // data
+    uint16_t w, x, y, z;
+
+    Quat to_quat() const;
+};
+
+class Colorh {
+   public:
+    Colorh() = default;
+    explicit Colorh(const Color& c);
+
+    // data
+    uint16_t r, g, b, a;
+
+    Color to_color() const;
+};
+
+// single values
+uint16_t half_from_float(const float f);
+float float_from_half(const uint16_t h);
+
+// bulk conversion
+void to_half(const Vec3* in, Vec3h* out, const size_t n);
+void to_half(const Quat* in, Quath* out, const size_t n);
+void to_half(const Color* in, Colorh* out, const size_t n);
+
+void to_float(const Vec3h* in, Vec3* out, const size_t n);
+void to_float(const Quath* in, Quat* out, const size_t n);
+void to_float(const Colorh* in, Color* out, const size_t n);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+// Single values
+
+inline uint16_t half_from_float(const float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half;
+    if (bits >= 0x47800000u) {
+        // 65536 and up (the largest half is 65504), infinities and NaNs
+        half = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+    } else if (bits < 0x38800000u) {
+        // below the smallest normal half (2^-14): adding 0.5 lines the bits up
+        // with the half's denormal mantissa and lets the FPU do the rounding
+        const uint32_t magic_bits = 126u << 23;
+        float magic, value;
+        std::memcpy(&magic, &magic_bits, sizeof(magic));
+        std::memcpy(&value, &bits, sizeof(value));
+        value += magic;
+        uint32_t rounded;
+        std::memcpy(&rounded, &value, sizeof(rounded));
+        half = rounded - magic_bits;
+    } else {
+        // rebias the exponent and round the 13 dropped mantissa bits to even
+        const uint32_t odd = (bits >> 13) & 1;
+        bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff + odd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+inline float float_from_half(const uint16_t h) {
+    const uint32_t shifted_exponent = 0x7c00u << 13;
+    uint32_t bits = (h & 0x7fffu) << 13;
+    const uint32_t exponent = bits & shifted_exponent;
+    bits += static_cast<uint32_t>(127 - 15) << 23;
+
+    if (exponent == shifted_exponent) {
+        // infinities and NaNs keep an all-ones exponent, NaNs come out quiet
+        bits += static_cast<uint32_t>(128 - 16) << 23;
+        if ((bits & 0x7fffffu) != 0) {
+            bits |= 0x400000u;
+        }
+    } else if (exponent == 0) {
+        // denormals: renormalize by subtracting the implicit one back out
+        const uint32_t magic_bits = 113u << 23;
+        float magic, value;
+        std::memcpy(&magic, &magic_bits, sizeof(magic));
+        bits += 1u << 23;
+        std::memcpy(&value, &bits, sizeof(value));
+        value -= magic;
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    bits |= static_cast<uint32_t>(h & 0x8000u) << 16;
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Kernels
+
+namespace detail {
+
+#if defined(SML_SIMD_SSE) && !defined(SML_SIMD_F16C)
+
+// half_from_float on 4 lanes without branches, each result in the low 16 bits
+inline __m128i halves_from_floats(const __m128 f) {
+    const __m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(INT32_MIN)));
+    const __m128 magnitude = _mm_xor_ps(f, sign);
+    const __m128i bits = _mm_castps_si128(magnitude);
+
+    const __m128i magic_bits = _mm_set1_epi32(126 << 23);
+    const __m128i denormal = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(magnitude, _mm_castsi128_ps(magic_bits))), magic_bits);
+
+    const __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    const __m128i bias = _mm_set1_epi32(static_cast<int32_t>((15u - 127u) << 23) + 0xfff);
+    const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, bias), odd), 13);
+
+    const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(magnitude, magnitude));
+    const __m128i special =
+        _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(nan, _mm_set1_epi32(0x200)));
+
+    const __m128i is_denormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x38800000));
+    const __m128i is_finite = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x47800000));
+    const __m128i finite = _mm_or_si128(_mm_and_si128(is_denormal, denormal),
+                                        _mm_andnot_si128(is_denormal, normal));
+    const __m128i half =
+        _mm_or_si128(_mm_and_si128(is_finite, finite), _mm_andnot_si128(is_finite, special));
+    return _mm_or_si128(half, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+
+// float_from_half on 4 lanes without branches, halves in the low 16 bits
+inline __m128 floats_from_halves(const __m128i h) {
+    const __m128i shifted_exponent = _mm_set1_epi32(0x7c00 << 13);
+    const __m128i magnitude = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    const __m128i shifted = _mm_slli_epi32(magnitude, 13);
+    const __m128i exponent = _mm_and_si128(shifted, shifted_exponent);
+    const __m128i bits = _mm_add_epi32(shifted, _mm_set1_epi32((127 - 15) << 23));
+
+    const __m128i is_special = _mm_cmpeq_epi32(exponent, shifted_exponent);
+    const __m128i is_nan = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7c00));
+    const __m128i special = _mm_or_si128(
+        _mm_add_epi32(bits, _mm_set1_epi32((128 - 16) << 23)),
+        _mm_and_si128(is_nan, _mm_set1_epi32(0x400000)));
+
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+    const __m128i denormal = _mm_castps_si128(
+        _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(1 << 23))), magic));
+    const __m128i is_denormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+
+    __m128i result = _mm_or_si128(_mm_and_si128(is_special, special),
+                                  _mm_andnot_si128(is_special, bits));
+    result = _mm_or_si128(_mm_and_si128(is_denormal, denormal),
+                          _mm_andnot_si128(is_denormal, result));
+    const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    return _mm_castsi128_ps(_mm_or_si128(result, sign));
+}
+
+#endif
+
+inline void floats_to_halves(const float* in, uint16_t* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_F16C) && defined(SML_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), halves);
+    }
+#endif
+#if defined(SML_SIMD_F16C)
+    for (; i + 4 <= n; i += 4) {
+        const __m128i halves = _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), halves);
+    }
+#elif defined(SML_SIMD_SSE)
+    for (; i + 8 <= n; i += 8) {
+        // sign-extend the halves so the saturating pack keeps their bits
+        const __m128i low = halves_from_floats(_mm_loadu_ps(in + i));
+        const __m128i high = halves_from_floats(_mm_loadu_ps(in + i + 4));
+        const __m128i halves = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(low, 16), 16),
+                                               _mm_srai_epi32(_mm_slli_epi32(high, 16), 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), halves);
+    }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        const float16x4_t halves = vcvt_f16_f32(vld1q_f32(in + i));
+        vst1_u16(out + i, vreinterpret_u16_f16(halves));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = half_from_float(in[i]);
+    }
+}
+
+inline void halves_to_floats(const uint16_t* in, float* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_F16C) && defined(SML_SIMD_AVX)
+    for (; i + 8 <= n; i += 8) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(halves));
+    }
+#endif
+#if defined(SML_SIMD_F16C)
+    for (; i + 4 <= n; i += 4) {
+        const __m128i halves = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, _mm_cvtph_ps(halves));
+    }
+#elif defined(SML_SIMD_SSE)
+    for (; i + 8 <= n; i += 8) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_ps(out + i, floats_from_halves(_mm_unpacklo_epi16(halves, zero)));
+        _mm_storeu_ps(out + i + 4, floats_from_halves(_mm_unpackhi_epi16(halves, zero)));
+    }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        const float16x4_t halves = vreinterpret_f16_u16(vld1_u16(in + i));
+        vst1q_f32(out + i, vcvt_f32_f16(halves));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = float_from_half(in[i]);
+    }
+}
+
+}  // namespace detail
+
+// Constructors
+
+inline Vec3h::Vec3h(const Vec3& v)
+    : x{half_from_float(v.x)}, y{half_from_float(v.y)}, z{half_from_float(v.z)} {}
+
+inline Quath::Quath(const Quat& q)
+    : w{half_from_float(q.w)},
+      x{half_from_float(q.x)},
+      y{half_from_float(q.y)},
+      z{half_from_float(q.z)} {}
+
+inline Colorh::Colorh(const Color& c)
+    : r{half_from_float(c.r)},
+      g{half_from_float(c.g)},
+      b{half_from_float(c.b)},
+      a{half_from_float(c.a)} {}
+
+// Methods
+
+inline Vec3 Vec3h::to_vec3() const {
+    return Vec3(float_from_half(x), float_from_half(y), float_from_half(z));
+}
+
+inline Quat Quath::to_quat() const {
+    return Quat(float_from_half(w), float_from_half(x), float_from_half(y), float_from_half(z));
+}
+
+inline Color Colorh::to_color() const {
+    Color c;
+    c.r = float_from_half(r);
+    c.g = float_from_half(g);
+    c.b = float_from_half(b);
+    c.a = float_from_half(a);
+    return c;
+}
+
+// Bulk conversion
+
+inline void to_half(const Vec3* in, Vec3h* out, const size_t n) {
+    detail::floats_to_halves(reinterpret_cast<const float*>(in), reinterpret_cast<uint16_t*>(out),
+                             n * 3);
+}
+
+inline void to_half(const Quat* in, Quath* out, const size_t n) {
+    detail::floats_to_halves(reinterpret_cast<const float*>(in), reinterpret_cast<uint16_t*>(out),
+                             n * 4);
+}
+
+inline void to_half(const Color* in, Colorh* out, const size_t n) {
+    detail::floats_to_halves(reinterpret_cast<const float*>(in), reinterpret_cast<uint16_t*>(out),
+                             n * 4);
+}
+
+inline void to_float(const Vec3h* in, Vec3* out, const size_t n) {
+    detail::halves_to_floats(reinterpret_cast<const uint16_t*>(in), reinterpret_cast<float*>(out),
+                             n * 3);
+}
+
+inline void to_float(const Quath* in, Quat* out, const size_t n) {
+    detail::halves_to_floats(reinterpret_cast<const uint16_t*>(in), reinterpret_cast<float*>(out),
+                             n * 4);
+}
+
+inline void to_float(const Colorh* in, Color* out, const size_t n) {
+    detail::halves_to_floats(reinterpret_cast<const uint16_t*>(in), reinterpret_cast<float*>(out),
+                             n * 4);
+}
+
+static_assert(sizeof(Vec3h) == 3 * sizeof(uint16_t), "Vec3h must be three packed halves");
+static_assert(sizeof(Quath) == 4 * sizeof(uint16_t), "Quath must be four packed halves");
+static_assert(sizeof(Colorh) == 4 * sizeof(uint16_t), "Colorh must be four packed halves");
+
+}  // namespace sml
+
+#endif
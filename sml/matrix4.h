@@ -23,8 +23,12 @@
 #define SLIPPYS_MATH_LIBRARY_MATRIX4_H_
 
 #include <cstring>
+#include <sml/format.h>
+#include <sml/precision.h>
 #include <sml/quaternion.h>
+#include <sml/simd.h>
 #include <sml/transform.h>
+#include <sml/trig.h>
 #include <sml/vector3.h>
 
 namespace sml {
@@ -35,42 +39,71 @@ struct Points16 {
 
 class Mat4 {
    public:
-    Mat4();
-    Mat4(const Points16& points);
+    constexpr Mat4();
+    constexpr Mat4(const Points16& points);
 
     // transformation methods
     Mat4 translated(const Vec3& v) const;
     Mat4& translate(const Vec3& v);
-    Mat4& scale(const float a);
-    Mat4 scaled(const float a) const;
+    constexpr Mat4& scale(const float a);
+    constexpr Mat4 scaled(const float a) const;
+    constexpr Mat4& scale(const Vec3& v);  // scales the x, y and z axes only
+    constexpr Mat4 scaled(const Vec3& v) const;
     Mat4 rotated(const Vec3& axis, const float angle) const;
     Mat4& rotate(const Vec3& axis, const float angle);
-    Mat4 transposed() const;
-    Mat4& transpose();
+    constexpr Mat4 transposed() const;
+    constexpr Mat4& transpose();
+
+    // inversion methods (singular matrices yield non-finite entries)
+    float determinant() const;
+    Mat4 inverted() const;
+    Mat4& invert();
+    Mat4 inverted_affine() const;  // last row must be (0, 0, 0, 1)
+    Mat4& invert_affine();
+    Mat4 inverted_rigid() const;  // rotation and translation only
+    Mat4& invert_rigid();
+
+    // rotation part as a quaternion (scale is divided out; shear and mirroring are not handled)
+    Quat to_quat() const;
+
+    // batch methods (w = 1 for points, w = 0 for directions, 'out' may be 'in')
+    void transform_points(const Vec3* in, Vec3* out, size_t n) const;
+    void transform_directions(const Vec3* in, Vec3* out, size_t n) const;
 
     // misc methods
     std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
     Mat4& round();
     Mat4& copy(const Mat4& m);
 
     // useful constant matrices
-    static Mat4 identity();
-    static Mat4 zero();
+    static constexpr Mat4 identity();
+    static constexpr Mat4 zero();
 
     // useful dynamic matrices
-    static Mat4 orthogonal_projection(float min_x, float min_y, float max_x, float max_y,
-                                      float z_near, float z_far);
-    static Mat4 conical_projection(float fov, float aspect, float z_near, float z_far);
+    static constexpr Mat4 orthogonal_projection(float min_x, float min_y, float max_x,
+                                                float max_y, float z_near, float z_far);
+    static Mat4 conical_projection(float fov, float aspect, float z_near, float z_far,
+                                   const Precision precision = Precision::EXACT);
     static Mat4 look_at(const Vec3& from, const Vec3& target, const Vec3& up);
     static Mat4 look_at(const Vec3& from, const Vec3& target);
+    static Mat4 from_quat(const Quat& q);  // m * v == Transform::rotated(v, q)
+    static Mat4 from_trs(const Vec3& translation, const Quat& rotation, const Vec3& scale);
 
     static const size_t SIZE = 4;
     static const size_t MEM_SIZE = SIZE * SIZE * sizeof(float);
 
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 754;
+
     operator std::string();
 
-    const float* operator[](const size_t n) const;
-    float* operator[](const size_t n);
+    constexpr const float* operator[](const size_t n) const;
+    constexpr float* operator[](const size_t n);
+
+    // all 16 entries, column after column
+    const float* data() const;
+    float* data();
 
    private:
     float _data[4][4];
@@ -81,19 +114,26 @@ class Mat4 {
 bool operator==(const Mat4& a, const Mat4& b);
 bool operator!=(const Mat4& a, const Mat4& b);
 
-Mat4 operator+(const Mat4& a, const Mat4& b);
-Mat4 operator-(const Mat4& a, const Mat4& b);
-Mat4 operator-(const Mat4& m);
+constexpr Mat4 operator+(const Mat4& a, const Mat4& b);
+constexpr Mat4 operator-(const Mat4& a, const Mat4& b);
+constexpr Mat4 operator-(const Mat4& m);
 
 Mat4 operator*(const Mat4& a, const Mat4& b);
-Vec3 operator*(const Mat4& m, const Vec3& v);
-Mat4 operator*(const Mat4& m, const float a);
-Mat4 operator*(const float a, const Mat4& m);
+constexpr Vec3 operator*(const Mat4& m, const Vec3& v);
+constexpr Mat4 operator*(const Mat4& m, const float a);
+constexpr Mat4 operator*(const float a, const Mat4& m);
 
-Mat4& operator+=(Mat4& a, const Mat4& b);
-Mat4& operator-=(Mat4& a, const Mat4& b);
+constexpr Mat4& operator+=(Mat4& a, const Mat4& b);
+constexpr Mat4& operator-=(Mat4& a, const Mat4& b);
 Mat4& operator*=(Mat4& a, const Mat4& b);
-Mat4& operator*=(Mat4& m, const float a);
+constexpr Mat4& operator*=(Mat4& m, const float a);
+
+// Batch composition
+
+// out[i] = Mat4::from_trs(t[i], r[i], s[i]), from one array per component
+void compose_trs(const float* tx, const float* ty, const float* tz, const float* rw,
+                 const float* rx, const float* ry, const float* rz, const float* sx,
+                 const float* sy, const float* sz, Mat4* out, const size_t n);
 
 /*
 
@@ -103,30 +143,568 @@ Mat4& operator*=(Mat4& m, const float a);
 
 */
 
-// Constructors
+// Kernels
+
+namespace detail {
+
+/*
+Matrix multiplication by column broadcast
+Every column of the result is the columns of 'a' weighted by one column of 'b':
 
-inline Mat4::Mat4() : Mat4({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}) {}
+  out[c] = a[0] * b[c][0] + a[1] * b[c][1] + a[2] * b[c][2] + a[3] * b[c][3]
 
-inline Mat4::Mat4(const Points16& points) : _data{} {
-    std::memcpy(_data, points.f, Mat4::MEM_SIZE);
+The vector kernels add the four products in the same order as the scalar one,
+and never fuse them, so every path produces the same bits. All of 'a' and 'b'
+is read before 'out' is written, so 'out' may alias either of them.
+*/
+inline void multiply_mat4_scalar(const float* a, const float* b, float* out) {
+    float result[16];
+    for (size_t c = 0; c < Mat4::SIZE; c++) {
+        const float* column = b + c * Mat4::SIZE;
+        for (size_t r = 0; r < Mat4::SIZE; r++) {
+            result[c * Mat4::SIZE + r] = a[r] * column[0] + a[4 + r] * column[1] +
+                                         a[8 + r] * column[2] + a[12 + r] * column[3];
+        }
+    }
+    std::memcpy(out, result, Mat4::MEM_SIZE);
 }
 
-// Useful static members
+inline void multiply_mat4(const float* a, const float* b, float* out) {
+#if defined(SML_SIMD_SSE)
+    const __m128 a0 = _mm_loadu_ps(a);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+
+    __m128 result[4];
+    for (size_t c = 0; c < Mat4::SIZE; c++) {
+        const float* column = b + c * Mat4::SIZE;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+        result[c] = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+    }
 
-inline Mat4 Mat4::identity() {
-    static const Mat4 m = Mat4({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1});
-    return m;
+    for (size_t c = 0; c < Mat4::SIZE; c++) {
+        _mm_storeu_ps(out + c * Mat4::SIZE, result[c]);
+    }
+#elif defined(SML_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(a);
+    const float32x4_t a1 = vld1q_f32(a + 4);
+    const float32x4_t a2 = vld1q_f32(a + 8);
+    const float32x4_t a3 = vld1q_f32(a + 12);
+
+    float32x4_t result[4];
+    for (size_t c = 0; c < Mat4::SIZE; c++) {
+        const float* column = b + c * Mat4::SIZE;
+        float32x4_t sum = vmulq_n_f32(a0, column[0]);
+        sum = vaddq_f32(sum, vmulq_n_f32(a1, column[1]));
+        sum = vaddq_f32(sum, vmulq_n_f32(a2, column[2]));
+        result[c] = vaddq_f32(sum, vmulq_n_f32(a3, column[3]));
+    }
+
+    for (size_t c = 0; c < Mat4::SIZE; c++) {
+        vst1q_f32(out + c * Mat4::SIZE, result[c]);
+    }
+#else
+    multiply_mat4_scalar(a, b, out);
+#endif
 }
 
-inline Mat4 Mat4::zero() {
-    static const Mat4 m = Mat4({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
-    return m;
+/*
+Post-multiplication by a translation
+Only the last column changes, and the sums keep the order of a full product:
+
+  out[3] = a[0] * v.x + a[1] * v.y + a[2] * v.z + a[3]
+*/
+inline void translate_mat4(float* m, const Vec3& v) {
+#if defined(SML_SIMD_SSE)
+    __m128 sum = _mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(v.x));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v.y)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v.z)));
+    _mm_storeu_ps(m + 12, _mm_add_ps(sum, _mm_loadu_ps(m + 12)));
+#elif defined(SML_SIMD_NEON)
+    float32x4_t sum = vmulq_n_f32(vld1q_f32(m), v.x);
+    sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m + 4), v.y));
+    sum = vaddq_f32(sum, vmulq_n_f32(vld1q_f32(m + 8), v.z));
+    vst1q_f32(m + 12, vaddq_f32(sum, vld1q_f32(m + 12)));
+#else
+    for (size_t r = 0; r < Mat4::SIZE; r++) {
+        m[12 + r] = m[r] * v.x + m[4 + r] * v.y + m[8 + r] * v.z + m[12 + r];
+    }
+#endif
+}
+
+/*
+Post-multiplication by a 3x3 linear map 'l', stored column after column
+Only the first three columns change, and the last one is left as is:
+
+  out[c] = a[0] * l[c][0] + a[1] * l[c][1] + a[2] * l[c][2]
+*/
+inline void multiply_linear_mat4(float* m, const float* l) {
+#if defined(SML_SIMD_SSE)
+    const __m128 a0 = _mm_loadu_ps(m);
+    const __m128 a1 = _mm_loadu_ps(m + 4);
+    const __m128 a2 = _mm_loadu_ps(m + 8);
+    for (size_t c = 0; c < 3; c++) {
+        const float* column = l + c * 3;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+        _mm_storeu_ps(m + c * Mat4::SIZE,
+                      _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(column[2]))));
+    }
+#elif defined(SML_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(m);
+    const float32x4_t a1 = vld1q_f32(m + 4);
+    const float32x4_t a2 = vld1q_f32(m + 8);
+    for (size_t c = 0; c < 3; c++) {
+        const float* column = l + c * 3;
+        float32x4_t sum = vmulq_n_f32(a0, column[0]);
+        sum = vaddq_f32(sum, vmulq_n_f32(a1, column[1]));
+        vst1q_f32(m + c * Mat4::SIZE, vaddq_f32(sum, vmulq_n_f32(a2, column[2])));
+    }
+#else
+    float result[12];
+    for (size_t c = 0; c < 3; c++) {
+        const float* column = l + c * 3;
+        for (size_t r = 0; r < Mat4::SIZE; r++) {
+            result[c * Mat4::SIZE + r] =
+                m[r] * column[0] + m[4 + r] * column[1] + m[8 + r] * column[2];
+        }
+    }
+    std::memcpy(m, result, sizeof(result));
+#endif
+}
+
+/*
+Rotation used by Mat4::rotated, stored column after column in 'out'
+Entries within FLT_EPSILON of zero are snapped to zero, so right angles stay
+exact.
+*/
+inline void rotation_mat3(const Vec3& axis, const float angle, float* out) {
+    const Quat q = Transform::quaternion_from_rotation(axis, angle);
+
+    out[0] = 1 - 2 * (q.y * q.y + q.z * q.z);
+    out[1] = 2 * (q.x * q.y - q.z * q.w);
+    out[2] = 2 * (q.x * q.z + q.y * q.w);
+
+    out[3] = 2 * (q.x * q.y + q.z * q.w);
+    out[4] = 1 - 2 * (q.x * q.x + q.z * q.z);
+    out[5] = 2 * (q.y * q.z - q.x * q.w);
+
+    out[6] = 2 * (q.x * q.z - q.y * q.w);
+    out[7] = 2 * (q.y * q.z + q.x * q.w);
+    out[8] = 1 - 2 * (q.x * q.x + q.y * q.y);
+
+    for (size_t i = 0; i < 9; i++) {
+        if (std::fabs(out[i]) <= FLT_EPSILON) {
+            out[i] = 0;
+        }
+    }
+}
+
+/*
+Translation * rotation * scale, written straight into 'out'
+The rotation follows Transform::rotated, so the columns are the rotated axes:
+
+  out[0] = s.x * q(x_axis)    out[1] = s.y * q(y_axis)    out[2] = s.z * q(z_axis)    out[3] = t
+*/
+inline void compose_trs(const Vec3& t, const Quat& q, const Vec3& s, float* out) {
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    out[0] = s.x * (1 - 2 * (yy + zz));
+    out[1] = s.x * (2 * (xy + wz));
+    out[2] = s.x * (2 * (xz - wy));
+    out[3] = 0;
+
+    out[4] = s.y * (2 * (xy - wz));
+    out[5] = s.y * (1 - 2 * (xx + zz));
+    out[6] = s.y * (2 * (yz + wx));
+    out[7] = 0;
+
+    out[8] = s.z * (2 * (xz + wy));
+    out[9] = s.z * (2 * (yz - wx));
+    out[10] = s.z * (1 - 2 * (xx + yy));
+    out[11] = 0;
+
+    out[12] = t.x;
+    out[13] = t.y;
+    out[14] = t.z;
+    out[15] = 1;
+}
+
+#if defined(SML_SIMD_SSE)
+
+// one column of four consecutive matrices, given as its four entries for all of them
+inline void store_column_sse(__m128 e0, __m128 e1, __m128 e2, __m128 e3, float* out) {
+    _MM_TRANSPOSE4_PS(e0, e1, e2, e3);
+    _mm_storeu_ps(out, e0);
+    _mm_storeu_ps(out + Mat4::SIZE * Mat4::SIZE, e1);
+    _mm_storeu_ps(out + Mat4::SIZE * Mat4::SIZE * 2, e2);
+    _mm_storeu_ps(out + Mat4::SIZE * Mat4::SIZE * 3, e3);
+}
+
+/*
+compose_trs on four consecutive matrices at once, each argument holding one
+component of all four. Every entry is computed as in the scalar kernel, one
+register holding it for all four matrices, and the four entries of a column are
+then transposed into that column of each matrix.
+*/
+inline void compose_trs_sse(const __m128 tx, const __m128 ty, const __m128 tz, const __m128 w,
+                            const __m128 x, const __m128 y, const __m128 z, const __m128 sx,
+                            const __m128 sy, const __m128 sz, float* out) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f);
+    const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    store_column_sse(_mm_mul_ps(sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)))),
+                     _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xy, wz))),
+                     _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xz, wy))), zero, out);
+    store_column_sse(_mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(xy, wz))),
+                     _mm_mul_ps(sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))),
+                     _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(yz, wx))), zero, out + 4);
+    store_column_sse(_mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(xz, wy))),
+                     _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(yz, wx))),
+                     _mm_mul_ps(sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))), zero,
+                     out + 8);
+    store_column_sse(tx, ty, tz, one, out + 12);
+}
+
+#endif
+
+/*
+Batch transformation of Vec3 arrays
+The matrix entries are broadcast once, then points are read four at a time and
+shuffled from x y z x | y z x y | z x y z into one register per axis:
+
+  x' = m00 * x + m10 * y + m20 * z + m30 * w
+
+The sums keep the order of operator*(Mat4, Vec3), so both agree. Each group is
+fully loaded before it is stored, so 'out' may be the same array as 'in'.
+*/
+inline void transform_vec3_array(const float* m, const Vec3* in, Vec3* out, size_t n,
+                                 const float w) {
+    static_assert(sizeof(Vec3) == 3 * sizeof(float), "Vec3 must be three packed floats");
+    const float* src = reinterpret_cast<const float*>(in);
+    float* dst = reinterpret_cast<float*>(out);
+    size_t i = 0;
+
+#if defined(SML_SIMD_SSE)
+    const __m128 m00 = _mm_set1_ps(m[0]), m01 = _mm_set1_ps(m[1]), m02 = _mm_set1_ps(m[2]);
+    const __m128 m10 = _mm_set1_ps(m[4]), m11 = _mm_set1_ps(m[5]), m12 = _mm_set1_ps(m[6]);
+    const __m128 m20 = _mm_set1_ps(m[8]), m21 = _mm_set1_ps(m[9]), m22 = _mm_set1_ps(m[10]);
+    const __m128 m30 = _mm_set1_ps(m[12] * w);
+    const __m128 m31 = _mm_set1_ps(m[13] * w);
+    const __m128 m32 = _mm_set1_ps(m[14] * w);
+
+    for (; i + 4 <= n; i += 4, src += 12, dst += 12) {
+        __m128 x, y, z;
+        load_vec3x4_sse(src, x, y, z);
+
+        __m128 rx = _mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y));
+        __m128 ry = _mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y));
+        __m128 rz = _mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y));
+        rx = _mm_add_ps(_mm_add_ps(rx, _mm_mul_ps(m20, z)), m30);
+        ry = _mm_add_ps(_mm_add_ps(ry, _mm_mul_ps(m21, z)), m31);
+        rz = _mm_add_ps(_mm_add_ps(rz, _mm_mul_ps(m22, z)), m32);
+
+        store_vec3x4_sse(rx, ry, rz, dst);
+    }
+#elif defined(SML_SIMD_NEON)
+    for (; i + 4 <= n; i += 4, src += 12, dst += 12) {
+        const float32x4x3_t v = vld3q_f32(src);
+        float32x4x3_t r;
+        for (size_t row = 0; row < 3; row++) {
+            float32x4_t sum = vmulq_n_f32(v.val[0], m[row]);
+            sum = vaddq_f32(sum, vmulq_n_f32(v.val[1], m[4 + row]));
+            sum = vaddq_f32(sum, vmulq_n_f32(v.val[2], m[8 + row]));
+            r.val[row] = vaddq_f32(sum, vdupq_n_f32(m[12 + row] * w));
+        }
+        vst3q_f32(dst, r);
+    }
+#endif
+
+    for (; i < n; i++, src += 3, dst += 3) {
+        const float x = src[0], y = src[1], z = src[2];
+        dst[0] = m[0] * x + m[4] * y + m[8] * z + m[12] * w;
+        dst[1] = m[1] * x + m[5] * y + m[9] * z + m[13] * w;
+        dst[2] = m[2] * x + m[6] * y + m[10] * z + m[14] * w;
+    }
+}
+
+/*
+General inverse by cofactors
+The twelve 2x2 determinants of the top and bottom halves are shared by every
+cofactor. The expansion is symmetric in rows and columns, so it works on the
+column-major storage as is.
+*/
+inline void invert_mat4_scalar(const float* m, float* out) {
+    const float s0 = m[0] * m[5] - m[4] * m[1];
+    const float s1 = m[0] * m[6] - m[4] * m[2];
+    const float s2 = m[0] * m[7] - m[4] * m[3];
+    const float s3 = m[1] * m[6] - m[5] * m[2];
+    const float s4 = m[1] * m[7] - m[5] * m[3];
+    const float s5 = m[2] * m[7] - m[6] * m[3];
+
+    const float c5 = m[10] * m[15] - m[14] * m[11];
+    const float c4 = m[9] * m[15] - m[13] * m[11];
+    const float c3 = m[9] * m[14] - m[13] * m[10];
+    const float c2 = m[8] * m[15] - m[12] * m[11];
+    const float c1 = m[8] * m[14] - m[12] * m[10];
+    const float c0 = m[8] * m[13] - m[12] * m[9];
+
+    const float d = 1.f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    const float result[16] = {
+        (m[5] * c5 - m[6] * c4 + m[7] * c3) * d,   (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d,
+        (m[13] * s5 - m[14] * s4 + m[15] * s3) * d, (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d,
+        (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d,  (m[0] * c5 - m[2] * c2 + m[3] * c1) * d,
+        (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d, (m[8] * s5 - m[10] * s2 + m[11] * s1) * d,
+        (m[4] * c4 - m[5] * c2 + m[7] * c0) * d,   (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d,
+        (m[12] * s4 - m[13] * s2 + m[15] * s0) * d, (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d,
+        (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d,  (m[0] * c3 - m[1] * c1 + m[2] * c0) * d,
+        (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d, (m[8] * s3 - m[9] * s1 + m[10] * s0) * d,
+    };
+    std::memcpy(out, result, Mat4::MEM_SIZE);
+}
+
+#if defined(SML_SIMD_SSE)
+
+// 2x2 blocks packed as (m00, m01, m10, m11): A * B, A# * B and A * B#, where # is the adjugate
+inline __m128 mat2_mul(const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+inline __m128 mat2_adj_mul(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+inline __m128 mat2_mul_adj(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// cross product of the xyz lanes, the w lane ends up as zero
+inline __m128 cross_vec3(const __m128 a, const __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2))),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+}
+
+// writes | L t | from the columns of L and the original translation t, which is moved by -L
+//        | 0 1 |
+inline void store_affine_inverse(const __m128 c0, const __m128 c1, const __m128 c2,
+                                 const __m128 t, float* out) {
+    __m128 translation = _mm_mul_ps(c0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+    translation =
+        _mm_add_ps(translation, _mm_mul_ps(c1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+    translation =
+        _mm_add_ps(translation, _mm_mul_ps(c2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+
+    const __m128 last_row_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    _mm_storeu_ps(out, _mm_and_ps(c0, last_row_mask));
+    _mm_storeu_ps(out + 4, _mm_and_ps(c1, last_row_mask));
+    _mm_storeu_ps(out + 8, _mm_and_ps(c2, last_row_mask));
+    _mm_storeu_ps(out + 12, _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f),
+                                       _mm_and_ps(translation, last_row_mask)));
+}
+
+#endif
+
+/*
+General inverse by 2x2 blocks
+With M split into | A B | and # standing for the adjugate,
+                  | C D |
+
+  M^-1 = 1 / |M| * | X# Y# |    X = |D|A - B(D#C)     Y = |B|C - D(A#B)#
+                   | Z# W# |    Z = |C|B - A(D#C)#    W = |A|D - C(A#B)
+
+  |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+*/
+inline void invert_mat4(const float* m, float* out) {
+#if defined(SML_SIMD_SSE)
+    const __m128 v0 = _mm_loadu_ps(m);
+    const __m128 v1 = _mm_loadu_ps(m + 4);
+    const __m128 v2 = _mm_loadu_ps(m + 8);
+    const __m128 v3 = _mm_loadu_ps(m + 12);
+
+    const __m128 a = _mm_movelh_ps(v0, v1);
+    const __m128 b = _mm_movehl_ps(v1, v0);
+    const __m128 c = _mm_movelh_ps(v2, v3);
+    const __m128 d = _mm_movehl_ps(v3, v2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 block_determinants =
+        _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(v0, v2, _MM_SHUFFLE(2, 0, 2, 0)),
+                              _mm_shuffle_ps(v1, v3, _MM_SHUFFLE(3, 1, 3, 1))),
+                   _mm_mul_ps(_mm_shuffle_ps(v0, v2, _MM_SHUFFLE(3, 1, 3, 1)),
+                              _mm_shuffle_ps(v1, v3, _MM_SHUFFLE(2, 0, 2, 0))));
+    const __m128 det_a =
+        _mm_shuffle_ps(block_determinants, block_determinants, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 det_b =
+        _mm_shuffle_ps(block_determinants, block_determinants, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 det_c =
+        _mm_shuffle_ps(block_determinants, block_determinants, _MM_SHUFFLE(2, 2, 2, 2));
+    const __m128 det_d =
+        _mm_shuffle_ps(block_determinants, block_determinants, _MM_SHUFFLE(3, 3, 3, 3));
+
+    const __m128 d_adj_c = mat2_adj_mul(d, c);
+    const __m128 a_adj_b = mat2_adj_mul(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_mul(b, d_adj_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_mul(c, a_adj_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_mul_adj(d, a_adj_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_mul_adj(a, d_adj_c));
+
+    __m128 trace =
+        _mm_mul_ps(a_adj_b, _mm_shuffle_ps(d_adj_c, d_adj_c, _MM_SHUFFLE(3, 1, 2, 0)));
+    trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+    trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    const __m128 determinant =
+        _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+    const __m128 inverse_determinant = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), determinant);
+
+    x = _mm_mul_ps(x, inverse_determinant);
+    y = _mm_mul_ps(y, inverse_determinant);
+    z = _mm_mul_ps(z, inverse_determinant);
+    w = _mm_mul_ps(w, inverse_determinant);
+
+    // the adjugate of each block is folded into the final shuffles
+    _mm_storeu_ps(out, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
+    invert_mat4_scalar(m, out);
+#endif
+}
+
+/*
+Affine inverse
+| L t |^-1   | L^-1  -L^-1 * t |
+| 0 1 |    = | 0      1        |
+
+The rows of L^-1 are the cross products of the columns of L over det(L). The
+last row of 'm' is never read.
+*/
+inline void invert_affine_mat4(const float* m, float* out) {
+#if defined(SML_SIMD_SSE)
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 t = _mm_loadu_ps(m + 12);
+
+    __m128 r0 = cross_vec3(c1, c2);
+    __m128 r1 = cross_vec3(c2, c0);
+    __m128 r2 = cross_vec3(c0, c1);
+    __m128 r3 = _mm_setzero_ps();
+
+    __m128 determinant = _mm_mul_ps(c0, r0);
+    determinant = _mm_add_ps(determinant,
+                             _mm_shuffle_ps(determinant, determinant, _MM_SHUFFLE(2, 3, 0, 1)));
+    determinant = _mm_add_ps(determinant,
+                             _mm_shuffle_ps(determinant, determinant, _MM_SHUFFLE(1, 0, 3, 2)));
+    const __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.f), determinant);
+
+    r0 = _mm_mul_ps(r0, inverse_determinant);
+    r1 = _mm_mul_ps(r1, inverse_determinant);
+    r2 = _mm_mul_ps(r2, inverse_determinant);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    store_affine_inverse(r0, r1, r2, t, out);
+#else
+    const float c0[3] = {m[0], m[1], m[2]};
+    const float c1[3] = {m[4], m[5], m[6]};
+    const float c2[3] = {m[8], m[9], m[10]};
+    const float t[3] = {m[12], m[13], m[14]};
+
+    float r[3][3] = {{c1[1] * c2[2] - c1[2] * c2[1], c1[2] * c2[0] - c1[0] * c2[2],
+                      c1[0] * c2[1] - c1[1] * c2[0]},
+                     {c2[1] * c0[2] - c2[2] * c0[1], c2[2] * c0[0] - c2[0] * c0[2],
+                      c2[0] * c0[1] - c2[1] * c0[0]},
+                     {c0[1] * c1[2] - c0[2] * c1[1], c0[2] * c1[0] - c0[0] * c1[2],
+                      c0[0] * c1[1] - c0[1] * c1[0]}};
+    const float d = 1.f / (c0[0] * r[0][0] + c0[1] * r[0][1] + c0[2] * r[0][2]);
+
+    for (size_t i = 0; i < 3; i++) {
+        r[i][0] *= d;
+        r[i][1] *= d;
+        r[i][2] *= d;
+    }
+
+    const float result[16] = {r[0][0], r[1][0], r[2][0], 0,  // force format
+                              r[0][1], r[1][1], r[2][1], 0,  //
+                              r[0][2], r[1][2], r[2][2], 0,  //
+                              -(r[0][0] * t[0] + r[0][1] * t[1] + r[0][2] * t[2]),
+                              -(r[1][0] * t[0] + r[1][1] * t[1] + r[1][2] * t[2]),
+                              -(r[2][0] * t[0] + r[2][1] * t[1] + r[2][2] * t[2]),
+                              1};
+    std::memcpy(out, result, Mat4::MEM_SIZE);
+#endif
 }
 
+/*
+Rigid inverse
+For an orthonormal rotation R, R^-1 is its transpose, so the translation is
+only rotated back and negated. The last row of 'm' is never read.
+*/
+inline void invert_rigid_mat4(const float* m, float* out) {
+#if defined(SML_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_setzero_ps();
+    const __m128 t = _mm_loadu_ps(m + 12);
+
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    store_affine_inverse(c0, c1, c2, t, out);
+#else
+    const float result[16] = {m[0], m[4], m[8], 0,  // force format
+                              m[1], m[5], m[9], 0,  //
+                              m[2], m[6], m[10], 0,  //
+                              -(m[0] * m[12] + m[1] * m[13] + m[2] * m[14]),
+                              -(m[4] * m[12] + m[5] * m[13] + m[6] * m[14]),
+                              -(m[8] * m[12] + m[9] * m[13] + m[10] * m[14]),
+                              1};
+    std::memcpy(out, result, Mat4::MEM_SIZE);
+#endif
+}
+
+}  // namespace detail
+
+// Constructors
+
+constexpr Mat4::Mat4() : _data{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}} {}
+
+constexpr Mat4::Mat4(const Points16& points) : _data{} {
+    for (size_t x = 0; x < Mat4::SIZE; x++) {
+        for (size_t y = 0; y < Mat4::SIZE; y++) {
+            _data[x][y] = points.f[x * Mat4::SIZE + y];
+        }
+    }
+}
+
+// Useful static members
+
+constexpr Mat4 Mat4::identity() { return Mat4(); }
+
+constexpr Mat4 Mat4::zero() { return Mat4({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}); }
+
 // Useful dynamic matrices
 
-inline Mat4 Mat4::orthogonal_projection(float min_x, float min_y, float max_x, float max_y,
-                                        float z_near, float z_far) {
+constexpr Mat4 Mat4::orthogonal_projection(float min_x, float min_y, float max_x, float max_y,
+                                           float z_near, float z_far) {
     Mat4 m = Mat4::zero();
 
     m[0][0] = 2.f / (max_x - min_x);
@@ -140,9 +718,13 @@ inline Mat4 Mat4::orthogonal_projection(float min_x, float min_y, float max_x, f
     return m;
 }
 
-inline Mat4 Mat4::conical_projection(float fov, float aspect, float z_near, float z_far) {
-    float rect_height = 1.f / static_cast<float>(tan(fov * 0.5));
-    float rect_width = 1.f / (aspect * static_cast<float>(tan(fov * 0.5)));
+inline Mat4 Mat4::conical_projection(float fov, float aspect, float z_near, float z_far,
+                                     const Precision precision) {
+    const float half_fov_tangent = precision == Precision::FAST
+                                       ? tangent(fov * 0.5f, precision)
+                                       : static_cast<float>(tan(fov * 0.5));
+    float rect_height = 1.f / half_fov_tangent;
+    float rect_width = 1.f / (aspect * half_fov_tangent);
 
     Mat4 m = Mat4::zero();
 
@@ -189,27 +771,33 @@ inline Mat4 Mat4::look_at(const Vec3& from, const Vec3& target) {
     return look_at(from, target, Vec3::up());
 }
 
+inline Mat4 Mat4::from_quat(const Quat& q) {
+    Mat4 m;
+    detail::compose_trs(Vec3::zero(), q, Vec3(1, 1, 1), m.data());
+    return m;
+}
+
+inline Mat4 Mat4::from_trs(const Vec3& translation, const Quat& rotation, const Vec3& scale) {
+    Mat4 m;
+    detail::compose_trs(translation, rotation, scale, m.data());
+    return m;
+}
+
 // Tranformation Methods
 
 inline Mat4 Mat4::translated(const Vec3& v) const {
-    Mat4 m = Mat4::identity();
-    m[3][0] += v.x;
-    m[3][1] += v.y;
-    m[3][2] += v.z;
-    return (*this) * m;
+    Mat4 m = (*this);
+    return m.translate(v);
 }
 
 inline Mat4& Mat4::translate(const Vec3& v) {
-    Mat4 m = Mat4::identity();
-    m[3][0] += v.x;
-    m[3][1] += v.y;
-    m[3][2] += v.z;
-    return (*this) *= m;
+    detail::translate_mat4(data(), v);
+    return (*this);
 }
 
-inline Mat4 Mat4::scaled(const float a) const { return (*this) * a; }
+constexpr Mat4 Mat4::scaled(const float a) const { return (*this) * a; }
 
-inline Mat4& Mat4::scale(const float a) {
+constexpr Mat4& Mat4::scale(const float a) {
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
             _data[x][y] *= a;
@@ -218,48 +806,140 @@ inline Mat4& Mat4::scale(const float a) {
     return (*this);
 }
 
+constexpr Mat4 Mat4::scaled(const Vec3& v) const {
+    Mat4 m = (*this);
+    return m.scale(v);
+}
+
+constexpr Mat4& Mat4::scale(const Vec3& v) {
+    for (size_t y = 0; y < Mat4::SIZE; y++) {
+        _data[0][y] *= v.x;
+        _data[1][y] *= v.y;
+        _data[2][y] *= v.z;
+    }
+    return (*this);
+}
+
 inline Mat4 Mat4::rotated(const Vec3& axis, const float angle) const {
-    Quat q = Transform::quaternion_from_rotation(axis, angle);
-    Mat4 m = Mat4::identity();
+    Mat4 m = (*this);
+    return m.rotate(axis, angle);
+}
+
+inline Mat4& Mat4::rotate(const Vec3& axis, const float angle) {
+    float rotation[9];
+    detail::rotation_mat3(axis, angle, rotation);
+    detail::multiply_linear_mat4(data(), rotation);
+    return (*this);
+}
+
+constexpr Mat4 Mat4::transposed() const {
+    Mat4 m{};
+    for (size_t x = 0; x < Mat4::SIZE; x++) {
+        for (size_t y = 0; y < Mat4::SIZE; y++) {
+            m._data[x][y] = _data[y][x];
+        }
+    }
+    return m;
+}
 
-    m[0][0] = 1 - 2 * (q.y * q.y + q.z * q.z);
-    m[0][1] = 2 * (q.x * q.y - q.z * q.w);
-    m[0][2] = 2 * (q.x * q.z + q.y * q.w);
+constexpr Mat4& Mat4::transpose() { return (*this) = transposed(); }
 
-    m[1][0] = 2 * (q.x * q.y + q.z * q.w);
-    m[1][1] = 1 - 2 * (q.x * q.x + q.z * q.z);
-    m[1][2] = 2 * (q.y * q.z - q.x * q.w);
+// Inversion Methods
 
-    m[2][0] = 2 * (q.x * q.z - q.y * q.w);
-    m[2][1] = 2 * (q.y * q.z + q.x * q.w);
-    m[2][2] = 1 - 2 * (q.x * q.x + q.y * q.y);
+inline float Mat4::determinant() const {
+    const float* m = _data[0];
 
-    return (*this) * m.round();
+    const float s0 = m[0] * m[5] - m[4] * m[1];
+    const float s1 = m[0] * m[6] - m[4] * m[2];
+    const float s2 = m[0] * m[7] - m[4] * m[3];
+    const float s3 = m[1] * m[6] - m[5] * m[2];
+    const float s4 = m[1] * m[7] - m[5] * m[3];
+    const float s5 = m[2] * m[7] - m[6] * m[3];
+
+    const float c5 = m[10] * m[15] - m[14] * m[11];
+    const float c4 = m[9] * m[15] - m[13] * m[11];
+    const float c3 = m[9] * m[14] - m[13] * m[10];
+    const float c2 = m[8] * m[15] - m[12] * m[11];
+    const float c1 = m[8] * m[14] - m[12] * m[10];
+    const float c0 = m[8] * m[13] - m[12] * m[9];
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 }
 
-inline Mat4& Mat4::rotate(const Vec3& axis, const float angle) {
-    Mat4 m = Mat4::identity().rotated(axis, angle);
-    return (*this) *= m.round();
+inline Mat4 Mat4::inverted() const {
+    Mat4 m;
+    detail::invert_mat4(data(), m.data());
+    return m;
 }
 
-inline Mat4 Mat4::transposed() const {
-    Mat4 m{};
+inline Mat4& Mat4::invert() {
+    detail::invert_mat4(data(), data());
+    return (*this);
+}
+
+inline Mat4 Mat4::inverted_affine() const {
+    Mat4 m;
+    detail::invert_affine_mat4(data(), m.data());
+    return m;
+}
 
-    m.copy(*this);
-    m.transpose();
+inline Mat4& Mat4::invert_affine() {
+    detail::invert_affine_mat4(data(), data());
+    return (*this);
+}
 
+inline Mat4 Mat4::inverted_rigid() const {
+    Mat4 m;
+    detail::invert_rigid_mat4(data(), m.data());
     return m;
 }
 
-inline Mat4& Mat4::transpose() {
-    float buffer[16] = {_data[0][0], _data[0][1], _data[0][2], _data[0][3],  // force format
-                        _data[1][0], _data[1][1], _data[1][2], _data[1][3],
-                        _data[2][0], _data[2][1], _data[3][2], _data[2][3],
-                        _data[3][0], _data[3][1], _data[4][2], _data[3][3]};
-    std::memcpy(_data, buffer, Mat4::MEM_SIZE);
+inline Mat4& Mat4::invert_rigid() {
+    detail::invert_rigid_mat4(data(), data());
     return (*this);
 }
 
+/*
+Rotation to quaternion, after Shepperd: the biggest of 4w^2, 4x^2, 4y^2 and 4z^2
+is read off the diagonal (with r = row, c = column of the rotation)
+
+  4w^2 = 1 + r00 + r11 + r22    4x^2 = 1 + r00 - r11 - r22    ...
+
+and the other components come from sums and differences of mirrored entries,
+divided by the biggest one, which is never less than 1/2.
+*/
+inline Quat Mat4::to_quat() const {
+    const Vec3 c0 = Vec3(_data[0][0], _data[0][1], _data[0][2]).normalized();
+    const Vec3 c1 = Vec3(_data[1][0], _data[1][1], _data[1][2]).normalized();
+    const Vec3 c2 = Vec3(_data[2][0], _data[2][1], _data[2][2]).normalized();
+
+    const float trace = c0.x + c1.y + c2.z;
+    if (trace > 0) {
+        const float s = 2 * std::sqrt(1 + trace);
+        return Quat(s / 4, (c1.z - c2.y) / s, (c2.x - c0.z) / s, (c0.y - c1.x) / s);
+    }
+    if (c0.x > c1.y && c0.x > c2.z) {
+        const float s = 2 * std::sqrt(1 + c0.x - c1.y - c2.z);
+        return Quat((c1.z - c2.y) / s, s / 4, (c1.x + c0.y) / s, (c2.x + c0.z) / s);
+    }
+    if (c1.y > c2.z) {
+        const float s = 2 * std::sqrt(1 + c1.y - c0.x - c2.z);
+        return Quat((c2.x - c0.z) / s, (c1.x + c0.y) / s, s / 4, (c2.y + c1.z) / s);
+    }
+    const float s = 2 * std::sqrt(1 + c2.z - c0.x - c1.y);
+    return Quat((c0.y - c1.x) / s, (c2.x + c0.z) / s, (c2.y + c1.z) / s, s / 4);
+}
+
+// Batch Methods
+
+inline void Mat4::transform_points(const Vec3* in, Vec3* out, size_t n) const {
+    detail::transform_vec3_array(data(), in, out, n, 1.f);
+}
+
+inline void Mat4::transform_directions(const Vec3* in, Vec3* out, size_t n) const {
+    detail::transform_vec3_array(data(), in, out, n, 0.f);
+}
+
 // Misc Methods
 
 inline Mat4& Mat4::round() {
@@ -279,30 +959,38 @@ inline Mat4& Mat4::copy(const Mat4& m) {
 }
 
 inline std::string Mat4::to_string() const {
-    std::stringstream stream;
-    stream << "Mat4 {\n";
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Mat4::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Mat4 {\n");
 
     for (size_t y = 0; y < Mat4::SIZE; y++) {
-        stream << "      { ";
+        writer.append("      { ");
         for (size_t x = 0; x < Mat4::SIZE; x++) {
-            char buffer[64];
-            std::snprintf(buffer, 64, "%+.2f", _data[x][y]);
-            stream << buffer << " ";
+            writer.append_fixed(_data[x][y]);
+            writer.append(" ");
         }
-        stream << "}\n";
+        writer.append("}\n");
     }
-    stream << "}\n";
+    writer.append("}\n");
 
-    return stream.str();
+    return writer.finish();
 }
 
 // Conversion operators
 
 inline Mat4::operator std::string() { return to_string(); }
 
-inline const float* Mat4::operator[](const size_t n) const { return _data[n]; }
+constexpr const float* Mat4::operator[](const size_t n) const { return _data[n]; }
 
-inline float* Mat4::operator[](const size_t n) { return _data[n]; }
+constexpr float* Mat4::operator[](const size_t n) { return _data[n]; }
+
+inline const float* Mat4::data() const { return reinterpret_cast<const float*>(_data); }
+
+inline float* Mat4::data() { return reinterpret_cast<float*>(_data); }
 
 // Imutable operators
 
@@ -328,7 +1016,7 @@ inline bool operator!=(const Mat4& a, const Mat4& b) {
     return false;
 }
 
-inline Mat4 operator+(const Mat4& a, const Mat4& b) {
+constexpr Mat4 operator+(const Mat4& a, const Mat4& b) {
     Mat4 m{};
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
@@ -338,7 +1026,7 @@ inline Mat4 operator+(const Mat4& a, const Mat4& b) {
     return m;
 }
 
-inline Mat4 operator-(const Mat4& a, const Mat4& b) {
+constexpr Mat4 operator-(const Mat4& a, const Mat4& b) {
     Mat4 m{};
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
@@ -350,38 +1038,18 @@ inline Mat4 operator-(const Mat4& a, const Mat4& b) {
 
 inline Mat4 operator*(const Mat4& a, const Mat4& b) {
     Mat4 m;
-
-    m[0][0] = a[0][0] * b[0][0] + a[1][0] * b[0][1] + a[2][0] * b[0][2] + a[3][0] * b[0][3];
-    m[1][0] = a[0][0] * b[1][0] + a[1][0] * b[1][1] + a[2][0] * b[1][2] + a[3][0] * b[1][3];
-    m[2][0] = a[0][0] * b[2][0] + a[1][0] * b[2][1] + a[2][0] * b[2][2] + a[3][0] * b[2][3];
-    m[3][0] = a[0][0] * b[3][0] + a[1][0] * b[3][1] + a[2][0] * b[3][2] + a[3][0] * b[3][3];
-
-    m[0][1] = a[0][1] * b[0][0] + a[1][1] * b[0][1] + a[2][1] * b[0][2] + a[3][1] * b[0][3];
-    m[1][1] = a[0][1] * b[1][0] + a[1][1] * b[1][1] + a[2][1] * b[1][2] + a[3][1] * b[1][3];
-    m[2][1] = a[0][1] * b[2][0] + a[1][1] * b[2][1] + a[2][1] * b[2][2] + a[3][1] * b[2][3];
-    m[3][1] = a[0][1] * b[3][0] + a[1][1] * b[3][1] + a[2][1] * b[3][2] + a[3][1] * b[3][3];
-
-    m[0][2] = a[0][2] * b[0][0] + a[1][2] * b[0][1] + a[2][2] * b[0][2] + a[3][2] * b[0][3];
-    m[1][2] = a[0][2] * b[1][0] + a[1][2] * b[1][1] + a[2][2] * b[1][2] + a[3][2] * b[1][3];
-    m[2][2] = a[0][2] * b[2][0] + a[1][2] * b[2][1] + a[2][2] * b[2][2] + a[3][2] * b[2][3];
-    m[3][2] = a[0][2] * b[3][0] + a[1][2] * b[3][1] + a[2][2] * b[3][2] + a[3][2] * b[3][3];
-
-    m[0][3] = a[0][3] * b[0][0] + a[1][3] * b[0][1] + a[2][3] * b[0][2] + a[3][3] * b[0][3];
-    m[1][3] = a[0][3] * b[1][0] + a[1][3] * b[1][1] + a[2][3] * b[1][2] + a[3][3] * b[1][3];
-    m[2][3] = a[0][3] * b[2][0] + a[1][3] * b[2][1] + a[2][3] * b[2][2] + a[3][3] * b[2][3];
-    m[3][3] = a[0][3] * b[3][0] + a[1][3] * b[3][1] + a[2][3] * b[3][2] + a[3][3] * b[3][3];
-
+    detail::multiply_mat4(a.data(), b.data(), m.data());
     return m;
 }
 
 // We always assume vector is susceptible to translations (w = 1)
-inline Vec3 operator*(const Mat4& m, const Vec3& v) {
+constexpr Vec3 operator*(const Mat4& m, const Vec3& v) {
     return Vec3(m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0],
                 m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1],
                 m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2]);
 }
 
-inline Mat4 operator*(const Mat4& m, const float a) {
+constexpr Mat4 operator*(const Mat4& m, const float a) {
     Mat4 n{};
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
@@ -391,7 +1059,7 @@ inline Mat4 operator*(const Mat4& m, const float a) {
     return n;
 }
 
-inline Mat4 operator*(const float a, const Mat4& m) {
+constexpr Mat4 operator*(const float a, const Mat4& m) {
     Mat4 n{};
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
@@ -401,7 +1069,7 @@ inline Mat4 operator*(const float a, const Mat4& m) {
     return n;
 }
 
-inline Mat4 operator-(const Mat4& m) {
+constexpr Mat4 operator-(const Mat4& m) {
     Mat4 n{};
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
@@ -413,7 +1081,7 @@ inline Mat4 operator-(const Mat4& m) {
 
 // Mutable operators
 
-inline Mat4& operator+=(Mat4& a, const Mat4& b) {
+constexpr Mat4& operator+=(Mat4& a, const Mat4& b) {
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
             a[x][y] += b[x][y];
@@ -422,7 +1090,7 @@ inline Mat4& operator+=(Mat4& a, const Mat4& b) {
     return a;
 }
 
-inline Mat4& operator-=(Mat4& a, const Mat4& b) {
+constexpr Mat4& operator-=(Mat4& a, const Mat4& b) {
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
             a[x][y] -= b[x][y];
@@ -432,12 +1100,11 @@ inline Mat4& operator-=(Mat4& a, const Mat4& b) {
 }
 
 inline Mat4& operator*=(Mat4& a, const Mat4& b) {
-    Mat4 result = a * b;
-    std::memcpy(&a, &result, Mat4::MEM_SIZE);
+    detail::multiply_mat4(a.data(), b.data(), a.data());
     return a;
 }
 
-inline Mat4& operator*=(Mat4& m, const float a) {
+constexpr Mat4& operator*=(Mat4& m, const float a) {
     for (size_t x = 0; x < Mat4::SIZE; x++) {
         for (size_t y = 0; y < Mat4::SIZE; y++) {
             m[x][y] *= a;
@@ -446,6 +1113,26 @@ inline Mat4& operator*=(Mat4& m, const float a) {
     return m;
 }
 
+// Batch composition
+
+inline void compose_trs(const float* tx, const float* ty, const float* tz, const float* rw,
+                        const float* rx, const float* ry, const float* rz, const float* sx,
+                        const float* sy, const float* sz, Mat4* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        detail::compose_trs_sse(_mm_loadu_ps(tx + i), _mm_loadu_ps(ty + i), _mm_loadu_ps(tz + i),
+                                _mm_loadu_ps(rw + i), _mm_loadu_ps(rx + i), _mm_loadu_ps(ry + i),
+                                _mm_loadu_ps(rz + i), _mm_loadu_ps(sx + i), _mm_loadu_ps(sy + i),
+                                _mm_loadu_ps(sz + i), out[i].data());
+    }
+#endif
+    for (; i < n; i++) {
+        detail::compose_trs(Vec3(tx[i], ty[i], tz[i]), Quat(rw[i], rx[i], ry[i], rz[i]),
+                            Vec3(sx[i], sy[i], sz[i]), out[i].data());
+    }
+}
+
 }  // namespace sml
 
 namespace std {
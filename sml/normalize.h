@@ -0,0 +1,340 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_NORMALIZE_H_
+#define SLIPPYS_MATH_LIBRARY_NORMALIZE_H_
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <sml/precision.h>
+#include <sml/quaternion.h>
+#include <sml/quaternion_columns.h>
+#include <sml/simd.h>
+#include <sml/transform.h>
+#include <sml/vector3.h>
+
+/*
+
+Normalization with a choice of precision
+
+Precision::EXACT computes 1 / sqrt(length squared) in float, summing the
+squares in the same order as Vec3::normalized and Quat::normalized, so every
+element matches them to the bit (unless the compiler fuses the members'
+multiplies and adds, as GCC does with FMA enabled). Precision::FAST starts
+from the hardware reciprocal square root estimate and refines it with Newton
+steps:
+
+  r' = r * (1.5 - (0.5 * x) * (r * r))
+
+grouped like that in the single element functions and in every kernel, so
+FAST batches match normalized(v, Precision::FAST) to the bit too, under the
+same caveat. SSE and AVX estimates are good to 12 bits, so one step leaves
+lengths within 1e-6 of 1. The NEON estimate has 8 bits and gets two steps for about the same
+result. Without SIMD, FAST is EXACT.
+
+Unlike the member functions, these never make NaNs out of short inputs: a
+vector whose length squared is below FLT_MIN, zero included, normalizes to
+Vec3::zero(), and such a quaternion to Quat::identity().
+
+normalize_all works in place, over packed Vec3s, x/y/z arrays (Vec3Array) or
+packed Quats.
+
+*/
+
+namespace sml {
+
+// single elements
+Vec3 normalized(const Vec3& v, const Precision precision);
+Quat normalized(const Quat& q, const Precision precision);
+
+// in place
+void normalize_all(Vec3* v, const size_t n, const Precision precision);
+void normalize_all(float* x, float* y, float* z, const size_t n, const Precision precision);
+void normalize_all(Quat* q, const size_t n, const Precision precision);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+// 1 / sqrt(length_squared), or 0 when the length is too short to divide by
+inline float inverse_length(const float length_squared, const Precision precision) {
+    if (!(length_squared >= FLT_MIN)) {
+        return 0.f;
+    }
+#if defined(SML_SIMD_SSE)
+    if (precision == Precision::FAST) {
+        const float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(length_squared)));
+        return r * (1.5f - (0.5f * length_squared) * (r * r));
+    }
+#elif defined(SML_SIMD_NEON)
+    if (precision == Precision::FAST) {
+        const float32x2_t x = vdup_n_f32(length_squared);
+        float32x2_t r = vrsqrte_f32(x);
+        r = vmul_f32(r, vrsqrts_f32(vmul_f32(x, r), r));
+        r = vmul_f32(r, vrsqrts_f32(vmul_f32(x, r), r));
+        return vget_lane_f32(r, 0);
+    }
+#else
+    (void)precision;
+#endif
+    return 1.f / std::sqrt(length_squared);
+}
+
+#if defined(SML_SIMD_SSE)
+
+inline __m128 inverse_length_sse(const __m128 length_squared, const Precision precision) {
+    __m128 r;
+    if (precision == Precision::FAST) {
+        r = _mm_rsqrt_ps(length_squared);
+        const __m128 half_x_r_r = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(.5f), length_squared),
+                                             _mm_mul_ps(r, r));
+        r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), half_x_r_r));
+    } else {
+        r = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(length_squared));
+    }
+    return _mm_and_ps(r, _mm_cmpge_ps(length_squared, _mm_set1_ps(FLT_MIN)));
+}
+
+inline void normalize_vec3x4_sse(__m128& x, __m128& y, __m128& z, const Precision precision) {
+    const __m128 length_squared =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    const __m128 factor = inverse_length_sse(length_squared, precision);
+    x = _mm_mul_ps(x, factor);
+    y = _mm_mul_ps(y, factor);
+    z = _mm_mul_ps(z, factor);
+}
+
+#endif
+
+#if defined(SML_SIMD_AVX)
+
+inline __m256 inverse_length_avx(const __m256 length_squared, const Precision precision) {
+    __m256 r;
+    if (precision == Precision::FAST) {
+        r = _mm256_rsqrt_ps(length_squared);
+        const __m256 half_x_r_r = _mm256_mul_ps(
+            _mm256_mul_ps(_mm256_set1_ps(.5f), length_squared), _mm256_mul_ps(r, r));
+        r = _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f), half_x_r_r));
+    } else {
+        r = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(length_squared));
+    }
+    const __m256 long_enough = _mm256_cmp_ps(length_squared, _mm256_set1_ps(FLT_MIN), _CMP_GE_OQ);
+    return _mm256_and_ps(r, long_enough);
+}
+
+inline void normalize_vec3x8_avx(__m256& x, __m256& y, __m256& z, const Precision precision) {
+    const __m256 length_squared = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+    const __m256 factor = inverse_length_avx(length_squared, precision);
+    x = _mm256_mul_ps(x, factor);
+    y = _mm256_mul_ps(y, factor);
+    z = _mm256_mul_ps(z, factor);
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON)
+
+inline float32x4_t inverse_length_neon(const float32x4_t length_squared,
+                                       const Precision precision) {
+    float32x4_t r;
+    if (precision == Precision::FAST) {
+        r = vrsqrteq_f32(length_squared);
+        r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(length_squared, r), r));
+        r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(length_squared, r), r));
+    } else {
+#if defined(__aarch64__)
+        r = vdivq_f32(vdupq_n_f32(1.f), vsqrtq_f32(length_squared));
+#else
+        // 32-bit NEON has no square root or division, so EXACT goes lane by lane
+        float lanes[4];
+        vst1q_f32(lanes, length_squared);
+        for (size_t k = 0; k < 4; k++) {
+            lanes[k] = 1.f / std::sqrt(lanes[k]);
+        }
+        r = vld1q_f32(lanes);
+#endif
+    }
+    const uint32x4_t long_enough = vcgeq_f32(length_squared, vdupq_n_f32(FLT_MIN));
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(r), long_enough));
+}
+
+#endif
+
+}  // namespace detail
+
+inline Vec3 normalized(const Vec3& v, const Precision precision) {
+    return v * detail::inverse_length(v.length_squared(), precision);
+}
+
+inline Quat normalized(const Quat& q, const Precision precision) {
+    const float factor = detail::inverse_length(q.dot(q), precision);
+    if (factor == 0.f) {
+        return Quat::identity();
+    }
+    return Quat(q.w * factor, q.x * factor, q.y * factor, q.z * factor);
+}
+
+inline void normalize_all(Vec3* v, const size_t n, const Precision precision) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE) || defined(SML_SIMD_NEON)
+    float* floats = reinterpret_cast<float*>(v);
+#endif
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    for (; i < groups_end; i += 8) {
+        __m256 x, y, z;
+        detail::load_vec3x8_avx(floats + i * 3, x, y, z);
+        detail::normalize_vec3x8_avx(x, y, z, precision);
+        detail::store_vec3x8_avx(x, y, z, floats + i * 3);
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 x, y, z;
+        detail::load_vec3x4_sse(floats + i * 3, x, y, z);
+        detail::normalize_vec3x4_sse(x, y, z, precision);
+        detail::store_vec3x4_sse(x, y, z, floats + i * 3);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        float32x4x3_t c = vld3q_f32(floats + i * 3);
+        float32x4_t length_squared = vmulq_f32(c.val[0], c.val[0]);
+        length_squared = vmlaq_f32(length_squared, c.val[1], c.val[1]);
+        length_squared = vmlaq_f32(length_squared, c.val[2], c.val[2]);
+        const float32x4_t factor = detail::inverse_length_neon(length_squared, precision);
+        for (size_t k = 0; k < 3; k++) {
+            c.val[k] = vmulq_f32(c.val[k], factor);
+        }
+        vst3q_f32(floats + i * 3, c);
+    }
+#endif
+    for (; i < n; i++) {
+        v[i] = normalized(v[i], precision);
+    }
+}
+
+inline void normalize_all(float* x, float* y, float* z, const size_t n,
+                          const Precision precision) {
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    for (; i < groups_end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        detail::normalize_vec3x8_avx(vx, vy, vz, precision);
+        _mm256_storeu_ps(x + i, vx);
+        _mm256_storeu_ps(y + i, vy);
+        _mm256_storeu_ps(z + i, vz);
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        detail::normalize_vec3x4_sse(vx, vy, vz, precision);
+        _mm_storeu_ps(x + i, vx);
+        _mm_storeu_ps(y + i, vy);
+        _mm_storeu_ps(z + i, vz);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        const float32x4_t vx = vld1q_f32(x + i);
+        const float32x4_t vy = vld1q_f32(y + i);
+        const float32x4_t vz = vld1q_f32(z + i);
+        float32x4_t length_squared = vmulq_f32(vx, vx);
+        length_squared = vmlaq_f32(length_squared, vy, vy);
+        length_squared = vmlaq_f32(length_squared, vz, vz);
+        const float32x4_t factor = detail::inverse_length_neon(length_squared, precision);
+        vst1q_f32(x + i, vmulq_f32(vx, factor));
+        vst1q_f32(y + i, vmulq_f32(vy, factor));
+        vst1q_f32(z + i, vmulq_f32(vz, factor));
+    }
+#endif
+    for (; i < n; i++) {
+        const float factor = detail::inverse_length(x[i] * x[i] + y[i] * y[i] + z[i] * z[i],
+                                                    precision);
+        x[i] *= factor;
+        y[i] *= factor;
+        z[i] *= factor;
+    }
+}
+
+inline void normalize_all(Quat* q, const size_t n, const Precision precision) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        detail::QuatColumnsSSE c = detail::load_quats_sse(q + i);
+        // summed in the order Quat::dot sums
+        const __m128 norm_squared =
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c.w, c.w), _mm_mul_ps(c.x, c.x)),
+                                  _mm_mul_ps(c.y, c.y)),
+                       _mm_mul_ps(c.z, c.z));
+        const __m128 factor = detail::inverse_length_sse(norm_squared, precision);
+        // too short ones become the identity
+        const __m128 identity_w = _mm_andnot_ps(_mm_cmpneq_ps(factor, _mm_setzero_ps()),
+                                                _mm_set1_ps(1.f));
+        c.w = _mm_add_ps(_mm_mul_ps(c.w, factor), identity_w);
+        c.x = _mm_mul_ps(c.x, factor);
+        c.y = _mm_mul_ps(c.y, factor);
+        c.z = _mm_mul_ps(c.z, factor);
+        detail::store_quats_sse(c, q + i);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        float* floats = reinterpret_cast<float*>(q + i);
+        float32x4x4_t c = vld4q_f32(floats);
+        float32x4_t norm_squared = vmulq_f32(c.val[0], c.val[0]);
+        for (size_t k = 1; k < 4; k++) {
+            norm_squared = vmlaq_f32(norm_squared, c.val[k], c.val[k]);
+        }
+        const float32x4_t factor = detail::inverse_length_neon(norm_squared, precision);
+        const uint32x4_t too_short = vceqq_f32(factor, vdupq_n_f32(0.f));
+        const float32x4_t identity_w =
+            vreinterpretq_f32_u32(vandq_u32(too_short, vreinterpretq_u32_f32(vdupq_n_f32(1.f))));
+        c.val[0] = vmlaq_f32(identity_w, c.val[0], factor);
+        for (size_t k = 1; k < 4; k++) {
+            c.val[k] = vmulq_f32(c.val[k], factor);
+        }
+        vst4q_f32(floats, c);
+    }
+#endif
+    for (; i < n; i++) {
+        q[i] = normalized(q[i], precision);
+    }
+}
+
+}  // namespace sml
+
+#endif
@@ -24,7 +24,7 @@
 
 #include <cfloat>
 #include <cmath>
-#include <sstream>
+#include <sml/format.h>
 #include <string>
 
 /*
@@ -50,41 +50,52 @@ namespace sml {
 
 class Quat {
    public:
-    Quat();
-    Quat(float _w, float _x, float _y, float _z);
+    constexpr Quat();
+    constexpr Quat(float _w, float _x, float _y, float _z);
 
     // data
     float w, x, y, z;
 
     // methods
     const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
 
-    Quat& add(const Quat& q);
-    Quat added(const Quat& q) const;
+    constexpr Quat& add(const Quat& q);
+    constexpr Quat added(const Quat& q) const;
 
-    Quat& scale(const float a);
-    Quat scaled(const float a) const;
+    constexpr Quat& scale(const float a);
+    constexpr Quat scaled(const float a) const;
 
-    Quat multiplied(const Quat& q) const;
+    constexpr Quat multiplied(const Quat& q) const;
 
     Quat& normalize();
     Quat normalized() const;
 
-    Quat& conjugate();
-    Quat conjugated() const;
+    constexpr Quat& conjugate();
+    constexpr Quat conjugated() const;
 
     float norm() const;
-    float norm_squared() const;
+    constexpr float norm_squared() const;
+
+    constexpr float dot(const Quat& q) const;
+
+    // interpolation, along the shortest path and with t in [0, 1]
+    static Quat nlerp(const Quat& a, const Quat& b, const float t);
+    static Quat slerp(const Quat& a, const Quat& b, const float t);
+    static Quat fast_slerp(const Quat& a, const Quat& b, const float t);
 
     // convenient
-    static Quat identity();
-    static Quat zero();
-    static Quat i();
-    static Quat j();
-    static Quat k();
+    static constexpr Quat identity();
+    static constexpr Quat zero();
+    static constexpr Quat i();
+    static constexpr Quat j();
+    static constexpr Quat k();
 
     // conversions
     operator std::string();
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 61;
 };
 
 // Imutable operators
@@ -92,22 +103,33 @@ class Quat {
 bool operator==(const Quat& a, const Quat& b);
 bool operator!=(const Quat& a, const Quat& b);
 
-Quat operator*(const float a, const Quat& q);
-Quat operator*(const Quat& q, const float a);
-Quat operator/(const Quat& q, const float a);
+constexpr Quat operator*(const float a, const Quat& q);
+constexpr Quat operator*(const Quat& q, const float a);
+constexpr Quat operator/(const Quat& q, const float a);
 
-Quat operator*(const Quat& a, const Quat& b);
-Quat operator+(const Quat& a, const Quat& b);
-Quat operator-(const Quat& a, const Quat& b);
+constexpr Quat operator*(const Quat& a, const Quat& b);
+constexpr Quat operator+(const Quat& a, const Quat& b);
+constexpr Quat operator-(const Quat& a, const Quat& b);
 
-Quat operator-(const Quat& q);
+constexpr Quat operator-(const Quat& q);
 
 // Mutable operators
 
-Quat& operator*=(Quat& q, const float a);
-Quat& operator/=(Quat& q, const float a);
-Quat& operator+=(Quat& a, const Quat& b);
-Quat& operator-=(Quat& a, const Quat& b);
+constexpr Quat& operator*=(Quat& q, const float a);
+constexpr Quat& operator/=(Quat& q, const float a);
+constexpr Quat& operator+=(Quat& a, const Quat& b);
+constexpr Quat& operator-=(Quat& a, const Quat& b);
+
+// Fused operations, one pass and no temporaries even in debug builds (see vector3.h)
+
+// a * s + b
+constexpr Quat madd(const Quat& a, const float s, const Quat& b);
+
+// a + (b - a) * t, not normalized
+constexpr Quat lerp(const Quat& a, const Quat& b, const float t);
+
+// a * sa + b * sb
+constexpr Quat lincomb2(const Quat& a, const float sa, const Quat& b, const float sb);
 
 /*
 
@@ -117,52 +139,87 @@ Quat& operator-=(Quat& a, const Quat& b);
 
 */
 
-inline Quat::Quat() : Quat(1.0f, 0.0f, 0.0f, 0.0f) {}
+namespace detail {
 
-inline Quat::Quat(float _w, float _x, float _y, float _z) : w{_w}, x{_x}, y{_y}, z{_z} {}
+/*
 
-// Static members
+Fast slerp
 
-inline Quat Quat::identity() {
-    static const Quat q = Quat(1.0f, 0.0f, 0.0f, 0.0f);
-    return q;
-}
+slerp weighs its ends by sin((1 - t) * angle) / sin(angle) and
+sin(t * angle) / sin(angle). As a function of x = cos(angle), each of those is
 
-inline Quat Quat::zero() {
-    static const Quat q = Quat(0.0f, 0.0f, 0.0f, 0.0f);
-    return q;
-}
+  w(t) = t * (1 + b1 * (1 + b2 * (1 + b3 * (...)))),  bi = (x - 1) * (t^2 - i^2) / (i * (2i + 1))
 
-inline Quat Quat::i() {
-    static const Quat q = Quat(0.0f, 1.0f, 0.0f, 0.0f);
-    return q;
-}
+which needs no acos or sin at all. fast_slerp cuts it at 8 terms and scales the
+last one up to make up for the rest, as in D. Eberly's "A Fast and Accurate
+Algorithm for Computing SLERP". Along the shortest path x never drops below 0,
+and there either weight is off by at most 2e-5 from the exact one: the result is
+within 0.002 degrees of slerp and its norm within 3e-5 of 1. Both ends are exact.
 
-inline Quat Quat::j() {
-    static const Quat q = Quat(0.0f, 0.0f, 1.0f, 0.0f);
-    return q;
-}
+*/
 
-inline Quat Quat::k() {
-    static const Quat q = Quat(0.0f, 0.0f, 0.0f, 1.0f);
-    return q;
+const size_t FAST_SLERP_TERMS = 8;
+const float FAST_SLERP_U[FAST_SLERP_TERMS] = {1.f / 3,  1.f / 10, 1.f / 21,  1.f / 36,
+                                              1.f / 55, 1.f / 78, 1.f / 105, 1.853f / 136};
+const float FAST_SLERP_V[FAST_SLERP_TERMS] = {1.f / 3,  2.f / 5,  3.f / 7,  4.f / 9,
+                                              5.f / 11, 6.f / 13, 7.f / 15, 1.853f * 8 / 17};
+
+inline float fast_slerp_weight(const float cos_angle_minus_one, const float t) {
+    const float t_squared = t * t;
+    float weight = 1.f;
+    for (size_t i = FAST_SLERP_TERMS; i-- > 0;) {
+        const float term = (FAST_SLERP_U[i] * t_squared - FAST_SLERP_V[i]) * cos_angle_minus_one;
+        weight = 1.f + term * weight;
+    }
+    return t * weight;
 }
 
+}  // namespace detail
+
+constexpr Quat::Quat() : Quat(1.0f, 0.0f, 0.0f, 0.0f) {}
+
+constexpr Quat::Quat(float _w, float _x, float _y, float _z) : w{_w}, x{_x}, y{_y}, z{_z} {}
+
+// Static members
+
+constexpr Quat Quat::identity() { return Quat(1.0f, 0.0f, 0.0f, 0.0f); }
+
+constexpr Quat Quat::zero() { return Quat(0.0f, 0.0f, 0.0f, 0.0f); }
+
+constexpr Quat Quat::i() { return Quat(0.0f, 1.0f, 0.0f, 0.0f); }
+
+constexpr Quat Quat::j() { return Quat(0.0f, 0.0f, 1.0f, 0.0f); }
+
+constexpr Quat Quat::k() { return Quat(0.0f, 0.0f, 0.0f, 1.0f); }
+
 // Methods
 
 inline const std::string Quat::to_string() const {
-    std::ostringstream stream{};
-    stream << "Quat(" << w << ", " << x << ", " << y << ", " << z << ")";
-    return stream.str();
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
 }
 
-inline Quat& Quat::add(const Quat& q) { return (*this) += q; }
-inline Quat Quat::added(const Quat& q) const { return (*this) + q; }
+inline size_t Quat::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Quat(");
+    writer.append_general(w);
+    writer.append(", ");
+    writer.append_general(x);
+    writer.append(", ");
+    writer.append_general(y);
+    writer.append(", ");
+    writer.append_general(z);
+    writer.append(")");
+    return writer.finish();
+}
+
+constexpr Quat& Quat::add(const Quat& q) { return (*this) += q; }
+constexpr Quat Quat::added(const Quat& q) const { return (*this) + q; }
 
-inline Quat& Quat::scale(const float a) { return (*this) *= a; }
-inline Quat Quat::scaled(const float a) const { return (*this) * a; }
+constexpr Quat& Quat::scale(const float a) { return (*this) *= a; }
+constexpr Quat Quat::scaled(const float a) const { return (*this) * a; }
 
-inline Quat Quat::multiplied(const Quat& q) const { return (*this) * q; }
+constexpr Quat Quat::multiplied(const Quat& q) const { return (*this) * q; }
 
 inline Quat& Quat::normalize() {
     float factor = 1 / norm();
@@ -178,18 +235,48 @@ inline Quat Quat::normalized() const {
     return Quat(w * factor, x * factor, y * factor, z * factor);
 }
 
-inline Quat& Quat::conjugate() {
+constexpr Quat& Quat::conjugate() {
     x = -x;
     y = -y;
     z = -z;
     return *this;
 }
 
-inline Quat Quat::conjugated() const { return Quat(w, -x, -y, -z); }
+constexpr Quat Quat::conjugated() const { return Quat(w, -x, -y, -z); }
+
+inline float Quat::norm() const { return std::sqrt(w * w + x * x + y * y + z * z); }
 
-inline float Quat::norm() const { return static_cast<float>(sqrt(w * w + x * x + y * y + z * z)); }
+constexpr float Quat::norm_squared() const { return w * w + x * x + y * y + z * z; }
 
-inline float Quat::norm_squared() const { return w * w + x * x + y * y + z * z; }
+constexpr float Quat::dot(const Quat& q) const { return w * q.w + x * q.x + y * q.y + z * q.z; }
+
+// Interpolation
+
+inline Quat Quat::nlerp(const Quat& a, const Quat& b, const float t) {
+    const Quat end = a.dot(b) < 0 ? -b : b;
+    return lerp(a, end, t).normalized();
+}
+
+inline Quat Quat::slerp(const Quat& a, const Quat& b, const float t) {
+    const float dot = a.dot(b);
+    const Quat end = dot < 0 ? -b : b;
+    const float cos_angle = std::fabs(dot);
+    // sin(angle) is too small to divide by, but then a straight line is just as good
+    if (cos_angle > 1.f - 1e-6f) {
+        return nlerp(a, end, t);
+    }
+    const float angle = std::acos(cos_angle);
+    const float factor = 1 / std::sin(angle);
+    return lincomb2(a, std::sin((1 - t) * angle) * factor, end, std::sin(t * angle) * factor);
+}
+
+inline Quat Quat::fast_slerp(const Quat& a, const Quat& b, const float t) {
+    const float dot = a.dot(b);
+    const Quat end = dot < 0 ? -b : b;
+    const float cos_angle_minus_one = std::fabs(dot) - 1;
+    return lincomb2(a, detail::fast_slerp_weight(cos_angle_minus_one, 1 - t), end,
+                    detail::fast_slerp_weight(cos_angle_minus_one, t));
+}
 
 // Conversion operators
 
@@ -207,15 +294,15 @@ inline bool operator!=(const Quat& a, const Quat& b) {
            fabs(a.y - b.y) > FLT_EPSILON || fabs(a.z - b.z) > FLT_EPSILON;
 }
 
-inline Quat operator*(const float a, const Quat& q) {
+constexpr Quat operator*(const float a, const Quat& q) {
     return Quat(a * q.w, a * q.x, a * q.y, a * q.z);
 }
 
-inline Quat operator*(const Quat& q, const float a) {
+constexpr Quat operator*(const Quat& q, const float a) {
     return Quat(a * q.w, a * q.x, a * q.y, a * q.z);
 }
 
-inline Quat operator/(const Quat& q, const float a) {
+constexpr Quat operator/(const Quat& q, const float a) {
     const float factor = 1 / a;
     return Quat(factor * q.w, factor * q.x, factor * q.y, factor * q.z);
 }
@@ -228,26 +315,26 @@ a | w -x -y -z |   b | w |
   | z  y  x  w |     | z |
 
 */
-inline Quat operator*(const Quat& a, const Quat& b) {
+constexpr Quat operator*(const Quat& a, const Quat& b) {
     return Quat(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
                 a.x * b.w + a.w * b.x - a.z * b.y - a.y * b.z,
                 a.y * b.w + a.z * b.x + a.w * b.y - a.x * b.z,
                 a.z * b.w + a.y * b.x + a.x * b.y + a.w * b.z);
 }
 
-inline Quat operator+(const Quat& a, const Quat& b) {
+constexpr Quat operator+(const Quat& a, const Quat& b) {
     return Quat(a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z);
 }
 
-inline Quat operator-(const Quat& a, const Quat& b) {
+constexpr Quat operator-(const Quat& a, const Quat& b) {
     return Quat(a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z);
 }
 
-inline Quat operator-(const Quat& q) { return Quat(-q.w, -q.x, -q.y, -q.z); }
+constexpr Quat operator-(const Quat& q) { return Quat(-q.w, -q.x, -q.y, -q.z); }
 
 // Mutable operators
 
-inline Quat& operator*=(Quat& q, const float a) {
+constexpr Quat& operator*=(Quat& q, const float a) {
     q.w *= a;
     q.x *= a;
     q.y *= a;
@@ -255,7 +342,7 @@ inline Quat& operator*=(Quat& q, const float a) {
     return q;
 }
 
-inline Quat& operator/=(Quat& q, const float a) {
+constexpr Quat& operator/=(Quat& q, const float a) {
     q.w /= a;
     q.x /= a;
     q.y /= a;
@@ -263,7 +350,7 @@ inline Quat& operator/=(Quat& q, const float a) {
     return q;
 }
 
-inline Quat& operator+=(Quat& a, const Quat& b) {
+constexpr Quat& operator+=(Quat& a, const Quat& b) {
     a.w += b.w;
     a.x += b.x;
     a.y += b.y;
@@ -271,7 +358,7 @@ inline Quat& operator+=(Quat& a, const Quat& b) {
     return a;
 }
 
-inline Quat& operator-=(Quat& a, const Quat& b) {
+constexpr Quat& operator-=(Quat& a, const Quat& b) {
     a.w -= b.w;
     a.x -= b.x;
     a.y -= b.y;
@@ -279,6 +366,22 @@ inline Quat& operator-=(Quat& a, const Quat& b) {
     return a;
 }
 
+// Fused operations
+
+constexpr Quat madd(const Quat& a, const float s, const Quat& b) {
+    return Quat(a.w * s + b.w, a.x * s + b.x, a.y * s + b.y, a.z * s + b.z);
+}
+
+constexpr Quat lerp(const Quat& a, const Quat& b, const float t) {
+    return Quat(a.w + (b.w - a.w) * t, a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+                a.z + (b.z - a.z) * t);
+}
+
+constexpr Quat lincomb2(const Quat& a, const float sa, const Quat& b, const float sb) {
+    return Quat(a.w * sa + b.w * sb, a.x * sa + b.x * sb, a.y * sa + b.y * sb,
+                a.z * sa + b.z * sb);
+}
+
 }  // namespace sml
 
 namespace std {
@@ -0,0 +1,414 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_QUATERNION_CODEC_H_
+#define SLIPPYS_MATH_LIBRARY_QUATERNION_CODEC_H_
+
+#include <cmath>
+#include <cstdint>
+#include <sml/quaternion.h>
+#include <sml/simd.h>
+
+/*
+
+Smallest-three quaternion compression
+
+A unit quaternion's largest component (by magnitude) can be rebuilt from the
+other three, since w^2 + x^2 + y^2 + z^2 = 1. And because q and -q are the same
+rotation, the sign can be flipped so the largest one is positive. So only the
+index of the largest component and the three others are stored. Those three
+always lie within [-1/sqrt(2), 1/sqrt(2)], which is the range they are
+quantized over, with 0 falling exactly on a code (so the identity and axis
+rotations survive unchanged).
+
+  Quat32   | index:2 | a:10 | b:10 | c:10 |           max error 0.28 degrees
+  Quat48   | 0:1 | index:2 | a:15 | b:15 | c:15 |    max error 0.009 degrees
+
+The worst case is when all four components are about equal: each stored one
+is off by half a step and the rebuilt one adds up their three errors.
+
+Index 0 to 3 means w, x, y, z (the Quat layout), and a, b, c are the remaining
+components in that same order. Quat48 keeps its 48 bits as three 16-bit words,
+least significant first.
+
+Quaternions are normalized before encoding, so any non-zero quaternion can go
+in. Decoding always yields a unit quaternion with a non-negative largest
+component, possibly the negation of what was encoded.
+
+*/
+
+namespace sml {
+
+class Quat32 {
+   public:
+    Quat32() = default;
+    explicit Quat32(const Quat& q);
+
+    // data
+    uint32_t bits;
+
+    Quat to_quat() const;
+};
+
+class Quat48 {
+   public:
+    Quat48() = default;
+    explicit Quat48(const Quat& q);
+
+    // data
+    uint16_t bits[3];
+
+    Quat to_quat() const;
+};
+
+// bulk conversion
+void encode(const Quat* in, Quat32* out, const size_t n);
+void encode(const Quat* in, Quat48* out, const size_t n);
+
+void decode(const Quat32* in, Quat* out, const size_t n);
+void decode(const Quat48* in, Quat* out, const size_t n);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+const float SMALLEST_THREE_RANGE = 0.707106781186547524f;  // 1 / sqrt(2)
+// an even number of steps, so that 0 gets a code of its own
+const uint32_t SMALLEST_THREE_MAX_10 = (1u << 10) - 2;
+const uint32_t SMALLEST_THREE_MAX_15 = (1u << 15) - 2;
+
+struct SmallestThree {
+    uint32_t index;
+    uint32_t a, b, c;
+};
+
+// [-range, range] to [0, max], rounding half up
+inline uint32_t quantize_component(const float v, const uint32_t max) {
+    const float center = static_cast<float>(max / 2);
+    const float t = v * (center / SMALLEST_THREE_RANGE) + (center + .5f);
+    return static_cast<uint32_t>(std::fmin(std::fmax(t, 0.f), static_cast<float>(max)));
+}
+
+inline float dequantize_component(const uint32_t code, const uint32_t max) {
+    const int32_t center = static_cast<int32_t>(max / 2);
+    const float step = SMALLEST_THREE_RANGE / static_cast<float>(center);
+    return static_cast<float>(static_cast<int32_t>(code) - center) * step;
+}
+
+inline SmallestThree smallest_three(const Quat& q, const uint32_t max) {
+    const Quat n = q.normalized();
+    const float components[4] = {n.w, n.x, n.y, n.z};
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++) {
+        if (std::fabs(components[i]) > std::fabs(components[largest])) {
+            largest = i;
+        }
+    }
+    const float sign = components[largest] < 0 ? -1.f : 1.f;
+
+    uint32_t codes[3];
+    for (uint32_t i = 0, k = 0; i < 4; i++) {
+        if (i != largest) {
+            codes[k++] = quantize_component(components[i] * sign, max);
+        }
+    }
+    return {largest, codes[0], codes[1], codes[2]};
+}
+
+inline Quat from_smallest_three(const SmallestThree& s, const uint32_t max) {
+    const float a = dequantize_component(s.a, max);
+    const float b = dequantize_component(s.b, max);
+    const float c = dequantize_component(s.c, max);
+    const float d = std::sqrt(std::fmax(0.f, 1.f - (a * a + b * b + c * c)));
+    switch (s.index) {
+        case 0: return Quat(d, a, b, c);
+        case 1: return Quat(a, d, b, c);
+        case 2: return Quat(a, b, d, c);
+        default: return Quat(a, b, c, d);
+    }
+}
+
+inline uint32_t pack_quat32(const SmallestThree& s) {
+    return (s.index << 30) | (s.a << 20) | (s.b << 10) | s.c;
+}
+
+inline SmallestThree unpack_quat32(const uint32_t bits) {
+    return {bits >> 30, (bits >> 20) & 0x3ff, (bits >> 10) & 0x3ff, bits & 0x3ff};
+}
+
+inline void pack_quat48(const SmallestThree& s, uint16_t* bits) {
+    const uint64_t packed = (static_cast<uint64_t>(s.index) << 45) |
+                            (static_cast<uint64_t>(s.a) << 30) | (s.b << 15) | s.c;
+    bits[0] = static_cast<uint16_t>(packed);
+    bits[1] = static_cast<uint16_t>(packed >> 16);
+    bits[2] = static_cast<uint16_t>(packed >> 32);
+}
+
+inline SmallestThree unpack_quat48(const uint16_t* bits) {
+    const uint64_t packed = bits[0] | (static_cast<uint64_t>(bits[1]) << 16) |
+                            (static_cast<uint64_t>(bits[2]) << 32);
+    return {static_cast<uint32_t>(packed >> 45) & 3, static_cast<uint32_t>(packed >> 30) & 0x7fff,
+            static_cast<uint32_t>(packed >> 15) & 0x7fff, static_cast<uint32_t>(packed) & 0x7fff};
+}
+
+#if defined(SML_SIMD_SSE)
+
+inline __m128 select_ps(const __m128i mask, const __m128 a, const __m128 b) {
+    const __m128 m = _mm_castsi128_ps(mask);
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+inline __m128i select_epi32(const __m128i mask, const __m128i a, const __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline __m128i quantize_components(const __m128 v, const uint32_t max) {
+    const float center = static_cast<float>(max / 2);
+    const __m128 t = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(center / SMALLEST_THREE_RANGE)),
+                                _mm_set1_ps(center + .5f));
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()),
+                                      _mm_set1_ps(static_cast<float>(max)));
+    return _mm_cvttps_epi32(clamped);
+}
+
+inline __m128 dequantize_components(const __m128i codes, const uint32_t max) {
+    const int32_t center = static_cast<int32_t>(max / 2);
+    const float step = SMALLEST_THREE_RANGE / static_cast<float>(center);
+    const __m128i centered = _mm_sub_epi32(codes, _mm_set1_epi32(center));
+    return _mm_mul_ps(_mm_cvtepi32_ps(centered), _mm_set1_ps(step));
+}
+
+// smallest_three on 4 quaternions, given as w, x, y, z columns
+inline void smallest_three(__m128 w, __m128 x, __m128 y, __m128 z, const uint32_t max,
+                           __m128i& index, __m128i& a, __m128i& b, __m128i& c) {
+    // normalize like Quat::normalized does
+    const __m128 norm = _mm_sqrt_ps(_mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)),
+        _mm_mul_ps(z, z)));
+    const __m128 factor = _mm_div_ps(_mm_set1_ps(1.f), norm);
+    w = _mm_mul_ps(w, factor);
+    x = _mm_mul_ps(x, factor);
+    y = _mm_mul_ps(y, factor);
+    z = _mm_mul_ps(z, factor);
+
+    const __m128 sign_bit = _mm_set1_ps(-0.f);
+    const __m128 abs_w = _mm_andnot_ps(sign_bit, w);
+    const __m128 abs_x = _mm_andnot_ps(sign_bit, x);
+    const __m128 abs_y = _mm_andnot_ps(sign_bit, y);
+    const __m128 abs_z = _mm_andnot_ps(sign_bit, z);
+    const __m128 largest = _mm_max_ps(_mm_max_ps(abs_w, abs_x), _mm_max_ps(abs_y, abs_z));
+
+    // the first component equal to the largest wins, as in the scalar loop
+    const __m128i is_w = _mm_castps_si128(_mm_cmpeq_ps(abs_w, largest));
+    const __m128i is_x = _mm_andnot_si128(is_w, _mm_castps_si128(_mm_cmpeq_ps(abs_x, largest)));
+    const __m128i up_to_x = _mm_or_si128(is_w, is_x);
+    const __m128i is_y = _mm_andnot_si128(up_to_x, _mm_castps_si128(_mm_cmpeq_ps(abs_y, largest)));
+    const __m128i up_to_y = _mm_or_si128(up_to_x, is_y);
+    // the masks are -1 where set: 3 for z, and one less for each earlier winner
+    index = _mm_add_epi32(_mm_set1_epi32(3), _mm_add_epi32(_mm_add_epi32(is_w, up_to_x), up_to_y));
+
+    // flip everything when the largest component is negative
+    const __m128 largest_value =
+        select_ps(is_w, w, select_ps(is_x, x, select_ps(is_y, y, z)));
+    const __m128 flip = _mm_and_ps(largest_value, sign_bit);
+    w = _mm_xor_ps(w, flip);
+    x = _mm_xor_ps(x, flip);
+    y = _mm_xor_ps(y, flip);
+    z = _mm_xor_ps(z, flip);
+
+    a = quantize_components(select_ps(is_w, x, w), max);
+    b = quantize_components(select_ps(up_to_x, y, x), max);
+    c = quantize_components(select_ps(up_to_y, z, y), max);
+}
+
+// from_smallest_three on 4 quaternions, returned as w, x, y, z columns
+inline void from_smallest_three(const __m128i index, const __m128i a_codes, const __m128i b_codes,
+                                const __m128i c_codes, const uint32_t max, __m128& w, __m128& x,
+                                __m128& y, __m128& z) {
+    const __m128 a = dequantize_components(a_codes, max);
+    const __m128 b = dequantize_components(b_codes, max);
+    const __m128 c = dequantize_components(c_codes, max);
+    const __m128 squares =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_mul_ps(c, c));
+    const __m128 d =
+        _mm_sqrt_ps(_mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(_mm_set1_ps(1.f), squares)));
+
+    const __m128i is_w = _mm_cmpeq_epi32(index, _mm_setzero_si128());
+    const __m128i is_x = _mm_cmpeq_epi32(index, _mm_set1_epi32(1));
+    const __m128i is_y = _mm_cmpeq_epi32(index, _mm_set1_epi32(2));
+    const __m128i is_z = _mm_cmpeq_epi32(index, _mm_set1_epi32(3));
+
+    w = select_ps(is_w, d, a);
+    x = select_ps(is_w, a, select_ps(is_x, d, b));
+    y = select_ps(is_z, c, select_ps(is_y, d, b));
+    z = select_ps(is_z, d, c);
+}
+
+#endif
+
+}  // namespace detail
+
+// Constructors
+
+inline Quat32::Quat32(const Quat& q)
+    : bits{detail::pack_quat32(detail::smallest_three(q, detail::SMALLEST_THREE_MAX_10))} {}
+
+inline Quat48::Quat48(const Quat& q) {
+    detail::pack_quat48(detail::smallest_three(q, detail::SMALLEST_THREE_MAX_15), bits);
+}
+
+// Methods
+
+inline Quat Quat32::to_quat() const {
+    return detail::from_smallest_three(detail::unpack_quat32(bits), detail::SMALLEST_THREE_MAX_10);
+}
+
+inline Quat Quat48::to_quat() const {
+    return detail::from_smallest_three(detail::unpack_quat48(bits), detail::SMALLEST_THREE_MAX_15);
+}
+
+// Bulk conversion
+
+inline void encode(const Quat* in, Quat32* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const float* floats = reinterpret_cast<const float*>(in);
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_loadu_ps(floats + i * 4);
+        __m128 x = _mm_loadu_ps(floats + i * 4 + 4);
+        __m128 y = _mm_loadu_ps(floats + i * 4 + 8);
+        __m128 z = _mm_loadu_ps(floats + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(w, x, y, z);
+
+        __m128i index, a, b, c;
+        detail::smallest_three(w, x, y, z, detail::SMALLEST_THREE_MAX_10, index, a, b, c);
+        const __m128i bits = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(index, 30), _mm_slli_epi32(a, 20)),
+            _mm_or_si128(_mm_slli_epi32(b, 10), c));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bits);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Quat32(in[i]);
+    }
+}
+
+inline void encode(const Quat* in, Quat48* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const float* floats = reinterpret_cast<const float*>(in);
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_loadu_ps(floats + i * 4);
+        __m128 x = _mm_loadu_ps(floats + i * 4 + 4);
+        __m128 y = _mm_loadu_ps(floats + i * 4 + 8);
+        __m128 z = _mm_loadu_ps(floats + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(w, x, y, z);
+
+        __m128i index, a, b, c;
+        detail::smallest_three(w, x, y, z, detail::SMALLEST_THREE_MAX_15, index, a, b, c);
+
+        // 47 bits per lane do not fit a 32-bit lane, so they are packed one by one
+        uint32_t indices[4], as[4], bs[4], cs[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(as), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bs), b);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cs), c);
+        for (size_t k = 0; k < 4; k++) {
+            detail::pack_quat48({indices[k], as[k], bs[k], cs[k]}, out[i + k].bits);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Quat48(in[i]);
+    }
+}
+
+inline void decode(const Quat32* in, Quat* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    float* floats = reinterpret_cast<float*>(out);
+    const __m128i mask = _mm_set1_epi32(0x3ff);
+    for (; i + 4 <= n; i += 4) {
+        const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i index = _mm_srli_epi32(bits, 30);
+        const __m128i a = _mm_and_si128(_mm_srli_epi32(bits, 20), mask);
+        const __m128i b = _mm_and_si128(_mm_srli_epi32(bits, 10), mask);
+        const __m128i c = _mm_and_si128(bits, mask);
+
+        __m128 w, x, y, z;
+        detail::from_smallest_three(index, a, b, c, detail::SMALLEST_THREE_MAX_10, w, x, y, z);
+        _MM_TRANSPOSE4_PS(w, x, y, z);
+        _mm_storeu_ps(floats + i * 4, w);
+        _mm_storeu_ps(floats + i * 4 + 4, x);
+        _mm_storeu_ps(floats + i * 4 + 8, y);
+        _mm_storeu_ps(floats + i * 4 + 12, z);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i].to_quat();
+    }
+}
+
+inline void decode(const Quat48* in, Quat* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    float* floats = reinterpret_cast<float*>(out);
+    for (; i + 4 <= n; i += 4) {
+        uint32_t indices[4], as[4], bs[4], cs[4];
+        for (size_t k = 0; k < 4; k++) {
+            const detail::SmallestThree s = detail::unpack_quat48(in[i + k].bits);
+            indices[k] = s.index;
+            as[k] = s.a;
+            bs[k] = s.b;
+            cs[k] = s.c;
+        }
+
+        __m128 w, x, y, z;
+        detail::from_smallest_three(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(as)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(bs)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(cs)),
+                                    detail::SMALLEST_THREE_MAX_15, w, x, y, z);
+        _MM_TRANSPOSE4_PS(w, x, y, z);
+        _mm_storeu_ps(floats + i * 4, w);
+        _mm_storeu_ps(floats + i * 4 + 4, x);
+        _mm_storeu_ps(floats + i * 4 + 8, y);
+        _mm_storeu_ps(floats + i * 4 + 12, z);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i].to_quat();
+    }
+}
+
+static_assert(sizeof(Quat32) == 4, "Quat32 must be 4 bytes");
+static_assert(sizeof(Quat48) == 6, "Quat48 must be 6 bytes");
+
+}  // namespace sml
+
+#endif
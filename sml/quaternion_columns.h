@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_QUATERNION_COLUMNS_H_
+#define SLIPPYS_MATH_LIBRARY_QUATERNION_COLUMNS_H_
+
+#include <sml/quaternion.h>
+#include <sml/simd.h>
+
+/*
+
+Transposes between packed quaternions and w, x, y, z columns for the SIMD
+kernels of quaternion_interpolation.h and normalize.h. Nothing public here.
+
+*/
+
+namespace sml {
+
+namespace detail {
+
+#if defined(SML_SIMD_SSE)
+
+// four quaternions as w, x, y, z columns
+struct QuatColumnsSSE {
+    __m128 w, x, y, z;
+};
+
+inline QuatColumnsSSE load_quats_sse(const Quat* q) {
+    const float* floats = reinterpret_cast<const float*>(q);
+    QuatColumnsSSE c = {_mm_loadu_ps(floats), _mm_loadu_ps(floats + 4), _mm_loadu_ps(floats + 8),
+                        _mm_loadu_ps(floats + 12)};
+    _MM_TRANSPOSE4_PS(c.w, c.x, c.y, c.z);
+    return c;
+}
+
+inline void store_quats_sse(QuatColumnsSSE c, Quat* q) {
+    float* floats = reinterpret_cast<float*>(q);
+    _MM_TRANSPOSE4_PS(c.w, c.x, c.y, c.z);
+    _mm_storeu_ps(floats, c.w);
+    _mm_storeu_ps(floats + 4, c.x);
+    _mm_storeu_ps(floats + 8, c.y);
+    _mm_storeu_ps(floats + 12, c.z);
+}
+
+#endif
+
+}  // namespace detail
+
+}  // namespace sml
+
+#endif
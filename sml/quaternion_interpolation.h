@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_QUATERNION_INTERPOLATION_H_
+#define SLIPPYS_MATH_LIBRARY_QUATERNION_INTERPOLATION_H_
+
+#include <cstddef>
+#include <sml/quaternion.h>
+#include <sml/quaternion_columns.h>
+#include <sml/simd.h>
+
+/*
+
+Batch quaternion interpolation
+
+Each function blends out[i] from a[i] to b[i] by t[i], exactly like the Quat
+static member of the same name would, four quaternions at a time where SIMD is
+available. The lanes do the same float operations in the same order, so the
+results match the member to the bit, as long as the compiler does not fuse the
+member's multiplies and adds (GCC does with FMA enabled, unless given
+-ffp-contract=off); then they differ in the last bits. out may be a or b.
+
+nlerp has no vector square root on 32-bit ARM and runs the plain loop there.
+
+nlerp and fast_slerp are vectorized. slerp needs an acos and two sines per
+quaternion, so it stays a plain loop; fast_slerp is the one to use in hot loops,
+as it is within 0.002 degrees of slerp (see Quat::fast_slerp).
+
+*/
+
+namespace sml {
+
+void nlerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n);
+void slerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n);
+void fast_slerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+#if defined(SML_SIMD_SSE)
+
+// negates b where it is more than 90 degrees away from a, returns the new a.dot(b)
+inline __m128 shortest_path_sse(const QuatColumnsSSE& a, QuatColumnsSSE& b) {
+    // summed in the order Quat::dot sums, so the lanes match it to the bit
+    const __m128 dot = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.w), _mm_mul_ps(a.x, b.x)), _mm_mul_ps(a.y, b.y)),
+        _mm_mul_ps(a.z, b.z));
+    const __m128 flip = _mm_and_ps(dot, _mm_set1_ps(-0.f));
+    b.w = _mm_xor_ps(b.w, flip);
+    b.x = _mm_xor_ps(b.x, flip);
+    b.y = _mm_xor_ps(b.y, flip);
+    b.z = _mm_xor_ps(b.z, flip);
+    return _mm_xor_ps(dot, flip);
+}
+
+inline __m128 fast_slerp_weight_sse(const __m128 cos_angle_minus_one, const __m128 t) {
+    const __m128 t_squared = _mm_mul_ps(t, t);
+    __m128 weight = _mm_set1_ps(1.f);
+    for (size_t i = FAST_SLERP_TERMS; i-- > 0;) {
+        const __m128 term =
+            _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(FAST_SLERP_U[i]), t_squared),
+                                  _mm_set1_ps(FAST_SLERP_V[i])),
+                       cos_angle_minus_one);
+        weight = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(term, weight));
+    }
+    return _mm_mul_ps(t, weight);
+}
+
+#elif defined(SML_SIMD_NEON)
+
+// four quaternions as w, x, y, z columns, which vld4q_f32 splits them into
+inline float32x4_t shortest_path_neon(const float32x4x4_t& a, float32x4x4_t& b) {
+    float32x4_t dot = vmulq_f32(a.val[0], b.val[0]);
+    for (size_t k = 1; k < 4; k++) {
+        dot = vaddq_f32(dot, vmulq_f32(a.val[k], b.val[k]));
+    }
+    const uint32x4_t flip = vandq_u32(vreinterpretq_u32_f32(dot), vdupq_n_u32(0x80000000u));
+    for (size_t k = 0; k < 4; k++) {
+        b.val[k] = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b.val[k]), flip));
+    }
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(dot), flip));
+}
+
+inline float32x4_t fast_slerp_weight_neon(const float32x4_t cos_angle_minus_one,
+                                          const float32x4_t t) {
+    const float32x4_t t_squared = vmulq_f32(t, t);
+    float32x4_t weight = vdupq_n_f32(1.f);
+    for (size_t i = FAST_SLERP_TERMS; i-- > 0;) {
+        const float32x4_t term = vmulq_f32(
+            vsubq_f32(vmulq_n_f32(t_squared, FAST_SLERP_U[i]), vdupq_n_f32(FAST_SLERP_V[i])),
+            cos_angle_minus_one);
+        weight = vaddq_f32(vdupq_n_f32(1.f), vmulq_f32(term, weight));
+    }
+    return vmulq_f32(t, weight);
+}
+
+#endif
+
+}  // namespace detail
+
+inline void nlerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        const detail::QuatColumnsSSE start = detail::load_quats_sse(a + i);
+        detail::QuatColumnsSSE end = detail::load_quats_sse(b + i);
+        detail::shortest_path_sse(start, end);
+        const __m128 weight = _mm_loadu_ps(t + i);
+
+        detail::QuatColumnsSSE r;
+        r.w = _mm_add_ps(start.w, _mm_mul_ps(_mm_sub_ps(end.w, start.w), weight));
+        r.x = _mm_add_ps(start.x, _mm_mul_ps(_mm_sub_ps(end.x, start.x), weight));
+        r.y = _mm_add_ps(start.y, _mm_mul_ps(_mm_sub_ps(end.y, start.y), weight));
+        r.z = _mm_add_ps(start.z, _mm_mul_ps(_mm_sub_ps(end.z, start.z), weight));
+
+        const __m128 norm_squared =
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r.w, r.w), _mm_mul_ps(r.x, r.x)),
+                                  _mm_mul_ps(r.y, r.y)),
+                       _mm_mul_ps(r.z, r.z));
+        const __m128 factor = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(norm_squared));
+        r.w = _mm_mul_ps(r.w, factor);
+        r.x = _mm_mul_ps(r.x, factor);
+        r.y = _mm_mul_ps(r.y, factor);
+        r.z = _mm_mul_ps(r.z, factor);
+        detail::store_quats_sse(r, out + i);
+    }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= n; i += 4) {
+        const float32x4x4_t start = vld4q_f32(reinterpret_cast<const float*>(a + i));
+        float32x4x4_t end = vld4q_f32(reinterpret_cast<const float*>(b + i));
+        detail::shortest_path_neon(start, end);
+        const float32x4_t weight = vld1q_f32(t + i);
+
+        float32x4x4_t r;
+        float32x4_t norm_squared = vdupq_n_f32(0.f);
+        for (size_t k = 0; k < 4; k++) {
+            r.val[k] = vmlaq_f32(start.val[k], vsubq_f32(end.val[k], start.val[k]), weight);
+            norm_squared = vmlaq_f32(norm_squared, r.val[k], r.val[k]);
+        }
+        const float32x4_t factor = vdivq_f32(vdupq_n_f32(1.f), vsqrtq_f32(norm_squared));
+        for (size_t k = 0; k < 4; k++) {
+            r.val[k] = vmulq_f32(r.val[k], factor);
+        }
+        vst4q_f32(reinterpret_cast<float*>(out + i), r);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Quat::nlerp(a[i], b[i], t[i]);
+    }
+}
+
+inline void slerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = Quat::slerp(a[i], b[i], t[i]);
+    }
+}
+
+inline void fast_slerp(const Quat* a, const Quat* b, const float* t, Quat* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    for (; i + 4 <= n; i += 4) {
+        const detail::QuatColumnsSSE start = detail::load_quats_sse(a + i);
+        detail::QuatColumnsSSE end = detail::load_quats_sse(b + i);
+        const __m128 cos_angle_minus_one =
+            _mm_sub_ps(detail::shortest_path_sse(start, end), _mm_set1_ps(1.f));
+        const __m128 weight = _mm_loadu_ps(t + i);
+        const __m128 start_weight = detail::fast_slerp_weight_sse(
+            cos_angle_minus_one, _mm_sub_ps(_mm_set1_ps(1.f), weight));
+        const __m128 end_weight = detail::fast_slerp_weight_sse(cos_angle_minus_one, weight);
+
+        detail::QuatColumnsSSE r;
+        r.w = _mm_add_ps(_mm_mul_ps(start.w, start_weight), _mm_mul_ps(end.w, end_weight));
+        r.x = _mm_add_ps(_mm_mul_ps(start.x, start_weight), _mm_mul_ps(end.x, end_weight));
+        r.y = _mm_add_ps(_mm_mul_ps(start.y, start_weight), _mm_mul_ps(end.y, end_weight));
+        r.z = _mm_add_ps(_mm_mul_ps(start.z, start_weight), _mm_mul_ps(end.z, end_weight));
+        detail::store_quats_sse(r, out + i);
+    }
+#elif defined(SML_SIMD_NEON)
+    for (; i + 4 <= n; i += 4) {
+        const float32x4x4_t start = vld4q_f32(reinterpret_cast<const float*>(a + i));
+        float32x4x4_t end = vld4q_f32(reinterpret_cast<const float*>(b + i));
+        const float32x4_t cos_angle_minus_one =
+            vsubq_f32(detail::shortest_path_neon(start, end), vdupq_n_f32(1.f));
+        const float32x4_t weight = vld1q_f32(t + i);
+        const float32x4_t start_weight = detail::fast_slerp_weight_neon(
+            cos_angle_minus_one, vsubq_f32(vdupq_n_f32(1.f), weight));
+        const float32x4_t end_weight = detail::fast_slerp_weight_neon(cos_angle_minus_one, weight);
+
+        float32x4x4_t r;
+        for (size_t k = 0; k < 4; k++) {
+            r.val[k] = vmlaq_f32(vmulq_f32(start.val[k], start_weight), end.val[k], end_weight);
+        }
+        vst4q_f32(reinterpret_cast<float*>(out + i), r);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Quat::fast_slerp(a[i], b[i], t[i]);
+    }
+}
+
+}  // namespace sml
+
+#endif
@@ -22,11 +22,29 @@
 #ifndef SLIPPYS_MATH_LIBRARY_GLOBAL_HEADER_H
 #define SLIPPYS_MATH_LIBRARY_GLOBAL_HEADER_H
 
+#include <sml/affine3.h>
+#include <sml/animation.h>
+#include <sml/array_file.h>
+#include <sml/blend.h>
 #include <sml/color.h>
+#include <sml/color32.h>
+#include <sml/compare.h>
 #include <sml/constants.h>
+#include <sml/format.h>
+#include <sml/frustum.h>
+#include <sml/half.h>
 #include <sml/matrix4.h>
+#include <sml/normalize.h>
+#include <sml/precision.h>
 #include <sml/quaternion.h>
+#include <sml/quaternion_codec.h>
+#include <sml/quaternion_interpolation.h>
+#include <sml/soa_array.h>
+#include <sml/srgb.h>
 #include <sml/transform.h>
+#include <sml/transform_hierarchy.h>
+#include <sml/trig.h>
 #include <sml/vector3.h>
+#include <sml/vector4.h>
 
 #endif
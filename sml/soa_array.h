@@ -0,0 +1,569 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_SOA_ARRAY_H_
+#define SLIPPYS_MATH_LIBRARY_SOA_ARRAY_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sml/quaternion.h>
+#include <sml/simd.h>
+#include <sml/transform.h>
+#include <sml/vector3.h>
+
+/*
+
+Vec3Array and QuatArray keep their elements one component per array, in a
+single allocation:
+
+  x  | x0 x1 x2 ... x7 | x8 ... x15 | ... | padding
+  y  | y0 y1 y2 ... y7 | y8 ... y15 | ... | padding
+  z  | z0 z1 z2 ... z7 | z8 ... z15 | ... | padding
+
+Every component array starts on a 64-byte boundary and is padded to a whole
+number of blocks of BLOCK_SIZE elements. So a kernel can work block by block
+with aligned loads, and always on full blocks: the lanes past size() in the
+last block can be read and written freely, and mean nothing.
+
+The component arrays plug straight into the x, y, z (and w) batch functions,
+like Transform::rotate_all and Frustum::cull_spheres. At the edges, elements
+read as plain Vec3 and Quat values, and array[i] also gives a small proxy that
+can be assigned one or have its components changed in place.
+
+*/
+
+namespace sml {
+
+namespace detail {
+
+// 'streams' float arrays of the same length, aligned and padded to whole blocks
+class FloatStreams {
+   public:
+    explicit FloatStreams(const size_t streams);
+    FloatStreams(const FloatStreams& other);
+    FloatStreams& operator=(const FloatStreams& other);
+    FloatStreams(FloatStreams&& other);
+    FloatStreams& operator=(FloatStreams&& other);
+
+    size_t size() const;
+    size_t capacity() const;
+    void reserve(const size_t n);
+    void resize(const size_t n);
+    void clear();
+
+    float* stream(const size_t s);
+    const float* stream(const size_t s) const;
+
+    static const size_t BLOCK_SIZE = 8;
+    static const size_t ALIGNMENT = 64;
+
+   private:
+    size_t _streams;
+    size_t _size = 0;
+    size_t _capacity = 0;
+    std::unique_ptr<float[]> _buffer;
+    float* _data = nullptr;
+};
+
+}  // namespace detail
+
+// one Vec3 of a Vec3Array, changed in place
+class Vec3Ref {
+   public:
+    Vec3Ref(float& _x, float& _y, float& _z);
+
+    // data
+    float& x;
+    float& y;
+    float& z;
+
+    Vec3Ref& operator=(const Vec3& v);
+    Vec3Ref& operator=(const Vec3Ref& v);
+    operator Vec3() const;
+};
+
+// one Quat of a QuatArray, changed in place
+class QuatRef {
+   public:
+    QuatRef(float& _w, float& _x, float& _y, float& _z);
+
+    // data
+    float& w;
+    float& x;
+    float& y;
+    float& z;
+
+    QuatRef& operator=(const Quat& q);
+    QuatRef& operator=(const QuatRef& q);
+    operator Quat() const;
+};
+
+// BLOCK_SIZE lanes of each component, 32-byte aligned, 'count' of them in use
+struct Vec3Block {
+    float* x;
+    float* y;
+    float* z;
+    size_t count;
+};
+
+struct QuatBlock {
+    float* w;
+    float* x;
+    float* y;
+    float* z;
+    size_t count;
+};
+
+class Vec3Array {
+   public:
+    Vec3Array();
+    explicit Vec3Array(const size_t n);  // n zero vectors
+    Vec3Array(const Vec3* values, const size_t n);
+
+    // size
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+    void reserve(const size_t n);
+    void resize(const size_t n);
+    void clear();
+    void push_back(const Vec3& v);
+
+    // elements
+    Vec3Ref operator[](const size_t i);
+    Vec3 operator[](const size_t i) const;
+
+    // conversion from and to packed Vec3s
+    void assign(const Vec3* values, const size_t n);
+    void copy_to(Vec3* out) const;
+
+    // component arrays
+    float* x();
+    float* y();
+    float* z();
+    const float* x() const;
+    const float* y() const;
+    const float* z() const;
+
+    // blocks of BLOCK_SIZE elements, the last one possibly partly in use
+    size_t block_count() const;
+    Vec3Block block(const size_t b);
+
+    static const size_t BLOCK_SIZE = detail::FloatStreams::BLOCK_SIZE;
+
+   private:
+    detail::FloatStreams _streams;
+};
+
+class QuatArray {
+   public:
+    QuatArray();
+    explicit QuatArray(const size_t n);  // n identity quaternions
+    QuatArray(const Quat* values, const size_t n);
+
+    // size
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+    void reserve(const size_t n);
+    void resize(const size_t n);  // new elements are identity quaternions
+    void clear();
+    void push_back(const Quat& q);
+
+    // elements
+    QuatRef operator[](const size_t i);
+    Quat operator[](const size_t i) const;
+
+    // conversion from and to packed Quats
+    void assign(const Quat* values, const size_t n);
+    void copy_to(Quat* out) const;
+
+    // component arrays
+    float* w();
+    float* x();
+    float* y();
+    float* z();
+    const float* w() const;
+    const float* x() const;
+    const float* y() const;
+    const float* z() const;
+
+    // blocks of BLOCK_SIZE elements, the last one possibly partly in use
+    size_t block_count() const;
+    QuatBlock block(const size_t b);
+
+    static const size_t BLOCK_SIZE = detail::FloatStreams::BLOCK_SIZE;
+
+   private:
+    detail::FloatStreams _streams;
+};
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+inline FloatStreams::FloatStreams(const size_t streams) : _streams{streams} {}
+
+inline FloatStreams::FloatStreams(const FloatStreams& other) : _streams{other._streams} {
+    *this = other;
+}
+
+inline FloatStreams& FloatStreams::operator=(const FloatStreams& other) {
+    if (this != &other) {
+        _streams = other._streams;
+        _size = 0;
+        reserve(other._size);
+        _size = other._size;
+        for (size_t s = 0; s < _streams && _size > 0; s++) {
+            std::memcpy(stream(s), other.stream(s), _size * sizeof(float));
+        }
+    }
+    return *this;
+}
+
+inline FloatStreams::FloatStreams(FloatStreams&& other) : _streams{other._streams} {
+    *this = std::move(other);
+}
+
+// 'other' is left empty, with no buffer
+inline FloatStreams& FloatStreams::operator=(FloatStreams&& other) {
+    if (this != &other) {
+        _streams = other._streams;
+        _size = other._size;
+        _capacity = other._capacity;
+        _buffer = std::move(other._buffer);
+        _data = other._data;
+        other._size = 0;
+        other._capacity = 0;
+        other._data = nullptr;
+    }
+    return *this;
+}
+
+inline size_t FloatStreams::size() const { return _size; }
+
+inline size_t FloatStreams::capacity() const { return _capacity; }
+
+inline void FloatStreams::reserve(const size_t n) {
+    if (n <= _capacity) {
+        return;
+    }
+    // whole 64-byte lines per stream, which are whole blocks as well
+    const size_t line = ALIGNMENT / sizeof(float);
+    const size_t capacity = std::max((n + line - 1) / line * line, 2 * _capacity);
+
+    // new float[] only promises float alignment, so the first aligned float is used
+    std::unique_ptr<float[]> buffer(new float[_streams * capacity + line]());
+    const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.get());
+    float* data = buffer.get() + (ALIGNMENT - address % ALIGNMENT) % ALIGNMENT / sizeof(float);
+
+    for (size_t s = 0; s < _streams && _size > 0; s++) {
+        std::memcpy(data + s * capacity, stream(s), _size * sizeof(float));
+    }
+    _buffer = std::move(buffer);
+    _data = data;
+    _capacity = capacity;
+}
+
+inline void FloatStreams::resize(const size_t n) {
+    reserve(n);
+    _size = n;
+}
+
+inline void FloatStreams::clear() { _size = 0; }
+
+inline float* FloatStreams::stream(const size_t s) { return _data + s * _capacity; }
+
+inline const float* FloatStreams::stream(const size_t s) const { return _data + s * _capacity; }
+
+}  // namespace detail
+
+// Element proxies
+
+inline Vec3Ref::Vec3Ref(float& _x, float& _y, float& _z) : x{_x}, y{_y}, z{_z} {}
+
+inline Vec3Ref& Vec3Ref::operator=(const Vec3& v) {
+    x = v.x;
+    y = v.y;
+    z = v.z;
+    return *this;
+}
+
+inline Vec3Ref& Vec3Ref::operator=(const Vec3Ref& v) { return *this = static_cast<Vec3>(v); }
+
+inline Vec3Ref::operator Vec3() const { return Vec3(x, y, z); }
+
+inline QuatRef::QuatRef(float& _w, float& _x, float& _y, float& _z)
+    : w{_w}, x{_x}, y{_y}, z{_z} {}
+
+inline QuatRef& QuatRef::operator=(const Quat& q) {
+    w = q.w;
+    x = q.x;
+    y = q.y;
+    z = q.z;
+    return *this;
+}
+
+inline QuatRef& QuatRef::operator=(const QuatRef& q) { return *this = static_cast<Quat>(q); }
+
+inline QuatRef::operator Quat() const { return Quat(w, x, y, z); }
+
+// Vec3Array
+
+inline Vec3Array::Vec3Array() : _streams(3) {}
+
+inline Vec3Array::Vec3Array(const size_t n) : _streams(3) { resize(n); }
+
+inline Vec3Array::Vec3Array(const Vec3* values, const size_t n) : _streams(3) {
+    assign(values, n);
+}
+
+inline size_t Vec3Array::size() const { return _streams.size(); }
+
+inline bool Vec3Array::empty() const { return _streams.size() == 0; }
+
+inline size_t Vec3Array::capacity() const { return _streams.capacity(); }
+
+inline void Vec3Array::reserve(const size_t n) { _streams.reserve(n); }
+
+inline void Vec3Array::resize(const size_t n) {
+    const size_t old_size = size();
+    _streams.resize(n);
+    for (size_t s = 0; n > old_size && s < 3; s++) {
+        std::fill(_streams.stream(s) + old_size, _streams.stream(s) + n, 0.f);
+    }
+}
+
+inline void Vec3Array::clear() { _streams.clear(); }
+
+inline void Vec3Array::push_back(const Vec3& v) {
+    const size_t i = size();
+    _streams.resize(i + 1);
+    (*this)[i] = v;
+}
+
+inline Vec3Ref Vec3Array::operator[](const size_t i) {
+    assert(i < size());
+    return Vec3Ref(x()[i], y()[i], z()[i]);
+}
+
+inline Vec3 Vec3Array::operator[](const size_t i) const {
+    assert(i < size());
+    return Vec3(x()[i], y()[i], z()[i]);
+}
+
+inline void Vec3Array::assign(const Vec3* values, const size_t n) {
+    _streams.clear();
+    _streams.resize(n);
+    const float* src = reinterpret_cast<const float*>(values);
+    float* xs = x();
+    float* ys = y();
+    float* zs = z();
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 vx, vy, vz;
+        detail::load_vec3x4_sse(src + i * 3, vx, vy, vz);
+        _mm_store_ps(xs + i, vx);
+        _mm_store_ps(ys + i, vy);
+        _mm_store_ps(zs + i, vz);
+    }
+#endif
+    for (; i < n; i++) {
+        xs[i] = src[i * 3];
+        ys[i] = src[i * 3 + 1];
+        zs[i] = src[i * 3 + 2];
+    }
+}
+
+inline void Vec3Array::copy_to(Vec3* out) const {
+    const size_t n = size();
+    float* dst = reinterpret_cast<float*>(out);
+    const float* xs = x();
+    const float* ys = y();
+    const float* zs = z();
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        detail::store_vec3x4_sse(_mm_load_ps(xs + i), _mm_load_ps(ys + i), _mm_load_ps(zs + i),
+                                 dst + i * 3);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i * 3] = xs[i];
+        dst[i * 3 + 1] = ys[i];
+        dst[i * 3 + 2] = zs[i];
+    }
+}
+
+inline float* Vec3Array::x() { return _streams.stream(0); }
+
+inline float* Vec3Array::y() { return _streams.stream(1); }
+
+inline float* Vec3Array::z() { return _streams.stream(2); }
+
+inline const float* Vec3Array::x() const { return _streams.stream(0); }
+
+inline const float* Vec3Array::y() const { return _streams.stream(1); }
+
+inline const float* Vec3Array::z() const { return _streams.stream(2); }
+
+inline size_t Vec3Array::block_count() const { return (size() + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+inline Vec3Block Vec3Array::block(const size_t b) {
+    assert(b < block_count());
+    const size_t first = b * BLOCK_SIZE;
+    return {x() + first, y() + first, z() + first, std::min(size() - first, size_t{BLOCK_SIZE})};
+}
+
+// QuatArray
+
+inline QuatArray::QuatArray() : _streams(4) {}
+
+inline QuatArray::QuatArray(const size_t n) : _streams(4) { resize(n); }
+
+inline QuatArray::QuatArray(const Quat* values, const size_t n) : _streams(4) {
+    assign(values, n);
+}
+
+inline size_t QuatArray::size() const { return _streams.size(); }
+
+inline bool QuatArray::empty() const { return _streams.size() == 0; }
+
+inline size_t QuatArray::capacity() const { return _streams.capacity(); }
+
+inline void QuatArray::reserve(const size_t n) { _streams.reserve(n); }
+
+inline void QuatArray::resize(const size_t n) {
+    const size_t old_size = size();
+    _streams.resize(n);
+    for (size_t s = 0; n > old_size && s < 4; s++) {
+        std::fill(_streams.stream(s) + old_size, _streams.stream(s) + n, s == 0 ? 1.f : 0.f);
+    }
+}
+
+inline void QuatArray::clear() { _streams.clear(); }
+
+inline void QuatArray::push_back(const Quat& q) {
+    const size_t i = size();
+    _streams.resize(i + 1);
+    (*this)[i] = q;
+}
+
+inline QuatRef QuatArray::operator[](const size_t i) {
+    assert(i < size());
+    return QuatRef(w()[i], x()[i], y()[i], z()[i]);
+}
+
+inline Quat QuatArray::operator[](const size_t i) const {
+    assert(i < size());
+    return Quat(w()[i], x()[i], y()[i], z()[i]);
+}
+
+inline void QuatArray::assign(const Quat* values, const size_t n) {
+    _streams.clear();
+    _streams.resize(n);
+    const float* src = reinterpret_cast<const float*>(values);
+    float* components[4] = {w(), x(), y(), z()};
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 qw, qx, qy, qz;
+        detail::load_quatx4_sse(values + i, qw, qx, qy, qz);
+        _mm_store_ps(components[0] + i, qw);
+        _mm_store_ps(components[1] + i, qx);
+        _mm_store_ps(components[2] + i, qy);
+        _mm_store_ps(components[3] + i, qz);
+    }
+#endif
+    for (; i < n; i++) {
+        for (size_t c = 0; c < 4; c++) {
+            components[c][i] = src[i * 4 + c];
+        }
+    }
+}
+
+inline void QuatArray::copy_to(Quat* out) const {
+    const size_t n = size();
+    float* dst = reinterpret_cast<float*>(out);
+    const float* components[4] = {w(), x(), y(), z()};
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 q0 = _mm_load_ps(components[0] + i);
+        __m128 q1 = _mm_load_ps(components[1] + i);
+        __m128 q2 = _mm_load_ps(components[2] + i);
+        __m128 q3 = _mm_load_ps(components[3] + i);
+        _MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+        _mm_storeu_ps(dst + i * 4, q0);
+        _mm_storeu_ps(dst + i * 4 + 4, q1);
+        _mm_storeu_ps(dst + i * 4 + 8, q2);
+        _mm_storeu_ps(dst + i * 4 + 12, q3);
+    }
+#endif
+    for (; i < n; i++) {
+        for (size_t c = 0; c < 4; c++) {
+            dst[i * 4 + c] = components[c][i];
+        }
+    }
+}
+
+inline float* QuatArray::w() { return _streams.stream(0); }
+
+inline float* QuatArray::x() { return _streams.stream(1); }
+
+inline float* QuatArray::y() { return _streams.stream(2); }
+
+inline float* QuatArray::z() { return _streams.stream(3); }
+
+inline const float* QuatArray::w() const { return _streams.stream(0); }
+
+inline const float* QuatArray::x() const { return _streams.stream(1); }
+
+inline const float* QuatArray::y() const { return _streams.stream(2); }
+
+inline const float* QuatArray::z() const { return _streams.stream(3); }
+
+inline size_t QuatArray::block_count() const { return (size() + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+inline QuatBlock QuatArray::block(const size_t b) {
+    assert(b < block_count());
+    const size_t first = b * BLOCK_SIZE;
+    return {w() + first, x() + first, y() + first, z() + first,
+            std::min(size() - first, size_t{BLOCK_SIZE})};
+}
+
+}  // namespace sml
+
+#endif
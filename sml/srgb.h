@@ -0,0 +1,352 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_SRGB_H_
+#define SLIPPYS_MATH_LIBRARY_SRGB_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <sml/color.h>
+#include <sml/color32.h>
+#include <sml/precision.h>
+#include <sml/simd.h>
+
+/*
+
+sRGB transfer functions
+
+Color carries no color space; these convert its r, g and b between sRGB
+encoded and linear values and leave alpha, which is linear either way, alone.
+
+  linear = s / 12.92                          s <= 0.04045
+           ((s + 0.055) / 1.055) ^ 2.4        otherwise
+  s      = 12.92 * linear                     linear <= 0.0031308
+           1.055 * linear ^ (1 / 2.4) - 0.055 otherwise
+
+Precision::EXACT evaluates those with std::pow. Precision::FAST clamps input
+and output to [0, 1] and replaces the powers with three square roots and a
+short minimax polynomial, t standing for the eighth root:
+
+  linear -> sRGB   P4(t), t = linear ^ (1 / 8)       within 3e-6
+  sRGB -> linear   u^2 * P3(t), t = u ^ (1 / 8)      within 5e-6 relative
+
+so both run the same in scalar code and four lanes at a time (SSE, AArch64
+NEON).
+
+Packed 8-bit sRGB needs no arithmetic one way: the 256 linear values sit in a
+table. The other way runs the FAST polynomial (or EXACT) and rounds to the
+nearest byte like Color32 does; being 3e-6 off only matters for values
+that fall that close to halfway between two bytes. Alpha bytes are k / 255 in
+both directions.
+
+*/
+
+namespace sml {
+
+// single values, and colors with alpha left alone
+float srgb_to_linear(const float s, const Precision precision = Precision::EXACT);
+float linear_to_srgb(const float linear, const Precision precision = Precision::EXACT);
+Color srgb_to_linear(const Color& c, const Precision precision = Precision::EXACT);
+Color linear_to_srgb(const Color& c, const Precision precision = Precision::EXACT);
+
+// in place
+void srgb_to_linear(Color* colors, const size_t n, const Precision precision);
+void linear_to_srgb(Color* colors, const size_t n, const Precision precision);
+
+// packed 8-bit sRGB, 'out' holds n colors
+void srgb_to_linear(const Color32* in, Color* out, const size_t n);
+void linear_to_srgb(const Color* in, Color32* out, const size_t n, const Precision precision);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+const float SRGB_LINEAR_LIMIT = 0.04045f;
+const float LINEAR_SRGB_LIMIT = 0.0031308f;
+
+// linear -> sRGB as a polynomial in linear ^ (1 / 8), lowest power first
+const size_t SRGB_ENCODE_TERMS = 5;
+const float SRGB_ENCODE[SRGB_ENCODE_TERMS] = {-0.06476872f, 0.07997177f, -0.29584113f,
+                                              1.09396140f, 0.18667906f};
+
+// ((s + 0.055) / 1.055) ^ 0.4 as a polynomial in its eighth root, lowest power first
+const size_t SRGB_DECODE_TERMS = 4;
+const float SRGB_DECODE[SRGB_DECODE_TERMS] = {-0.05360573f, 0.27423281f, -0.58721945f,
+                                              1.36658792f};
+
+inline float clamp_unit(const float value) { return std::max(0.f, std::min(1.f, value)); }
+
+inline float fast_srgb_to_linear(const float s) {
+    const float c = clamp_unit(s);
+    if (c <= SRGB_LINEAR_LIMIT) {
+        return c * (1 / 12.92f);
+    }
+    const float u = (c + 0.055f) * (1 / 1.055f);
+    const float t = std::sqrt(std::sqrt(std::sqrt(u)));
+    float p = SRGB_DECODE[SRGB_DECODE_TERMS - 1];
+    for (size_t i = SRGB_DECODE_TERMS - 1; i-- > 0;) {
+        p = p * t + SRGB_DECODE[i];
+    }
+    // the fit overshoots 1 by a few ulps at the top
+    return std::min(u * u * p, 1.f);
+}
+
+inline float fast_linear_to_srgb(const float linear) {
+    const float c = clamp_unit(linear);
+    if (c <= LINEAR_SRGB_LIMIT) {
+        return c * 12.92f;
+    }
+    const float t = std::sqrt(std::sqrt(std::sqrt(c)));
+    float p = SRGB_ENCODE[SRGB_ENCODE_TERMS - 1];
+    for (size_t i = SRGB_ENCODE_TERMS - 1; i-- > 0;) {
+        p = p * t + SRGB_ENCODE[i];
+    }
+    return std::min(p, 1.f);
+}
+
+// linear value of every sRGB byte
+inline const float* linear_from_srgb_byte_table() {
+    struct Table {
+        float values[256];
+        Table() {
+            for (int k = 0; k < 256; k++) {
+                values[k] = srgb_to_linear(static_cast<float>(k) / 0xff, Precision::EXACT);
+            }
+        }
+    };
+    static const Table table;
+    return table.values;
+}
+
+#if defined(SML_SIMD_SSE)
+
+inline __m128 clamp_unit_srgb_sse(const __m128 v) {
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.f));
+}
+
+// all four lanes, callers put alpha back
+inline __m128 fast_srgb_to_linear_sse(const __m128 s) {
+    const __m128 c = clamp_unit_srgb_sse(s);
+    const __m128 u = _mm_mul_ps(_mm_add_ps(c, _mm_set1_ps(0.055f)), _mm_set1_ps(1 / 1.055f));
+    const __m128 t = _mm_sqrt_ps(_mm_sqrt_ps(_mm_sqrt_ps(u)));
+    __m128 p = _mm_set1_ps(SRGB_DECODE[SRGB_DECODE_TERMS - 1]);
+    for (size_t i = SRGB_DECODE_TERMS - 1; i-- > 0;) {
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(SRGB_DECODE[i]));
+    }
+    const __m128 curve = _mm_min_ps(_mm_mul_ps(_mm_mul_ps(u, u), p), _mm_set1_ps(1.f));
+    const __m128 line = _mm_mul_ps(c, _mm_set1_ps(1 / 12.92f));
+    const __m128 on_line = _mm_cmple_ps(c, _mm_set1_ps(SRGB_LINEAR_LIMIT));
+    return _mm_or_ps(_mm_and_ps(on_line, line), _mm_andnot_ps(on_line, curve));
+}
+
+inline __m128 fast_linear_to_srgb_sse(const __m128 linear) {
+    const __m128 c = clamp_unit_srgb_sse(linear);
+    const __m128 t = _mm_sqrt_ps(_mm_sqrt_ps(_mm_sqrt_ps(c)));
+    __m128 p = _mm_set1_ps(SRGB_ENCODE[SRGB_ENCODE_TERMS - 1]);
+    for (size_t i = SRGB_ENCODE_TERMS - 1; i-- > 0;) {
+        p = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(SRGB_ENCODE[i]));
+    }
+    const __m128 line = _mm_mul_ps(c, _mm_set1_ps(12.92f));
+    const __m128 on_line = _mm_cmple_ps(c, _mm_set1_ps(LINEAR_SRGB_LIMIT));
+    const __m128 curve = _mm_min_ps(p, _mm_set1_ps(1.f));
+    return _mm_or_ps(_mm_and_ps(on_line, line), _mm_andnot_ps(on_line, curve));
+}
+
+// r, g, b from 'converted' and a from 'original'
+inline __m128 keep_alpha_sse(const __m128 converted, const __m128 original) {
+    const __m128 alpha = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+    return _mm_or_ps(_mm_andnot_ps(alpha, converted), _mm_and_ps(alpha, original));
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON) && defined(__aarch64__)
+
+inline float32x4_t clamp_unit_srgb_neon(const float32x4_t v) {
+    return vminq_f32(vmaxq_f32(v, vdupq_n_f32(0.f)), vdupq_n_f32(1.f));
+}
+
+inline float32x4_t fast_srgb_to_linear_neon(const float32x4_t s) {
+    const float32x4_t c = clamp_unit_srgb_neon(s);
+    const float32x4_t u = vmulq_n_f32(vaddq_f32(c, vdupq_n_f32(0.055f)), 1 / 1.055f);
+    const float32x4_t t = vsqrtq_f32(vsqrtq_f32(vsqrtq_f32(u)));
+    float32x4_t p = vdupq_n_f32(SRGB_DECODE[SRGB_DECODE_TERMS - 1]);
+    for (size_t i = SRGB_DECODE_TERMS - 1; i-- > 0;) {
+        p = vmlaq_f32(vdupq_n_f32(SRGB_DECODE[i]), p, t);
+    }
+    const float32x4_t curve = vminq_f32(vmulq_f32(vmulq_f32(u, u), p), vdupq_n_f32(1.f));
+    const float32x4_t line = vmulq_n_f32(c, 1 / 12.92f);
+    return vbslq_f32(vcleq_f32(c, vdupq_n_f32(SRGB_LINEAR_LIMIT)), line, curve);
+}
+
+inline float32x4_t fast_linear_to_srgb_neon(const float32x4_t linear) {
+    const float32x4_t c = clamp_unit_srgb_neon(linear);
+    const float32x4_t t = vsqrtq_f32(vsqrtq_f32(vsqrtq_f32(c)));
+    float32x4_t p = vdupq_n_f32(SRGB_ENCODE[SRGB_ENCODE_TERMS - 1]);
+    for (size_t i = SRGB_ENCODE_TERMS - 1; i-- > 0;) {
+        p = vmlaq_f32(vdupq_n_f32(SRGB_ENCODE[i]), p, t);
+    }
+    const float32x4_t line = vmulq_n_f32(c, 12.92f);
+    const float32x4_t curve = vminq_f32(p, vdupq_n_f32(1.f));
+    return vbslq_f32(vcleq_f32(c, vdupq_n_f32(LINEAR_SRGB_LIMIT)), line, curve);
+}
+
+inline float32x4_t keep_alpha_neon(const float32x4_t converted, const float32x4_t original) {
+    return vsetq_lane_f32(vgetq_lane_f32(original, 3), converted, 3);
+}
+
+#endif
+
+}  // namespace detail
+
+inline float srgb_to_linear(const float s, const Precision precision) {
+    if (precision == Precision::FAST) {
+        return detail::fast_srgb_to_linear(s);
+    }
+    if (s <= detail::SRGB_LINEAR_LIMIT) {
+        return s / 12.92f;
+    }
+    return std::pow((s + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linear_to_srgb(const float linear, const Precision precision) {
+    if (precision == Precision::FAST) {
+        return detail::fast_linear_to_srgb(linear);
+    }
+    if (linear <= detail::LINEAR_SRGB_LIMIT) {
+        return linear * 12.92f;
+    }
+    return 1.055f * std::pow(linear, 1 / 2.4f) - 0.055f;
+}
+
+inline Color srgb_to_linear(const Color& c, const Precision precision) {
+    return Color(srgb_to_linear(c.r, precision), srgb_to_linear(c.g, precision),
+                 srgb_to_linear(c.b, precision), c.a);
+}
+
+inline Color linear_to_srgb(const Color& c, const Precision precision) {
+    return Color(linear_to_srgb(c.r, precision), linear_to_srgb(c.g, precision),
+                 linear_to_srgb(c.b, precision), c.a);
+}
+
+inline void srgb_to_linear(Color* colors, const size_t n, const Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FAST) {
+        float* floats = reinterpret_cast<float*>(colors);
+#if defined(SML_SIMD_SSE)
+        for (; i < n; i++) {
+            const __m128 c = _mm_loadu_ps(floats + i * 4);
+            _mm_storeu_ps(floats + i * 4,
+                          detail::keep_alpha_sse(detail::fast_srgb_to_linear_sse(c), c));
+        }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+        for (; i < n; i++) {
+            const float32x4_t c = vld1q_f32(floats + i * 4);
+            vst1q_f32(floats + i * 4,
+                      detail::keep_alpha_neon(detail::fast_srgb_to_linear_neon(c), c));
+        }
+#else
+        (void)floats;
+#endif
+    }
+    for (; i < n; i++) {
+        colors[i] = srgb_to_linear(colors[i], precision);
+    }
+}
+
+inline void linear_to_srgb(Color* colors, const size_t n, const Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FAST) {
+        float* floats = reinterpret_cast<float*>(colors);
+#if defined(SML_SIMD_SSE)
+        for (; i < n; i++) {
+            const __m128 c = _mm_loadu_ps(floats + i * 4);
+            _mm_storeu_ps(floats + i * 4,
+                          detail::keep_alpha_sse(detail::fast_linear_to_srgb_sse(c), c));
+        }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+        for (; i < n; i++) {
+            const float32x4_t c = vld1q_f32(floats + i * 4);
+            vst1q_f32(floats + i * 4,
+                      detail::keep_alpha_neon(detail::fast_linear_to_srgb_neon(c), c));
+        }
+#else
+        (void)floats;
+#endif
+    }
+    for (; i < n; i++) {
+        colors[i] = linear_to_srgb(colors[i], precision);
+    }
+}
+
+inline void srgb_to_linear(const Color32* in, Color* out, const size_t n) {
+    const float* linear = detail::linear_from_srgb_byte_table();
+    const float* unit = detail::unit_from_byte_table();
+    for (size_t i = 0; i < n; i++) {
+        out[i] = Color(linear[in[i].r], linear[in[i].g], linear[in[i].b], unit[in[i].a]);
+    }
+}
+
+inline void linear_to_srgb(const Color* in, Color32* out, const size_t n,
+                           const Precision precision) {
+    size_t i = 0;
+#if defined(SML_SIMD_SSE)
+    if (precision == Precision::FAST) {
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            const float* floats = reinterpret_cast<const float*>(in + i);
+            __m128 colors[4];
+            for (size_t k = 0; k < 4; k++) {
+                const __m128 c = _mm_loadu_ps(floats + k * 4);
+                colors[k] = detail::keep_alpha_sse(detail::fast_linear_to_srgb_sse(c), c);
+            }
+            detail::store_color32x4_sse(colors, out + i);
+        }
+    }
+#elif defined(SML_SIMD_NEON) && defined(__aarch64__)
+    if (precision == Precision::FAST) {
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            const float* floats = reinterpret_cast<const float*>(in + i);
+            float32x4_t colors[4];
+            for (size_t k = 0; k < 4; k++) {
+                const float32x4_t c = vld1q_f32(floats + k * 4);
+                colors[k] = detail::keep_alpha_neon(detail::fast_linear_to_srgb_neon(c), c);
+            }
+            detail::store_color32x4_neon(colors, out + i);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = Color32(linear_to_srgb(in[i], precision));
+    }
+}
+
+}  // namespace sml
+
+#endif
@@ -22,9 +22,33 @@
 #ifndef SLIPPYS_MATH_LIBRARY_TRANSFORM_H_
 #define SLIPPYS_MATH_LIBRARY_TRANSFORM_H_
 
+#include <cstddef>
 #include <sml/quaternion.h>
+#include <sml/precision.h>
+#include <sml/simd.h>
+#include <sml/trig.h>
 #include <sml/vector3.h>
 
+/*
+
+Batch rotation
+
+rotate_all rotates whole arrays of vectors, either all by one quaternion or each
+by its own, with vectors given as a Vec3 array or as separate x, y, z arrays.
+Every vector goes through the same sums as rotated(), with u the vector part of
+the quaternion:
+
+  v' = v + 2 * (u x (u x v + w * v))
+
+The vector paths hold one coordinate of 8 (AVX) or 4 (SSE, NEON) vectors per
+register. Vec3 arrays are shuffled into that layout four vectors at a time and
+back on the way out. Each group is fully read before it is written, so the
+output arrays may be the input ones. (The loops run up to the last whole group
+rather than testing i + 8 <= n, which keeps GCC from warning about the scalar
+tail when n is a constant.)
+
+*/
+
 namespace sml {
 
 class Transform {
@@ -40,10 +64,23 @@ class Transform {
     static Vec3& rotate(Vec3& v, const Quat& q);
     static Vec3 rotated(const Vec3& v, const Quat& q);
 
+    // batch rotation, by one quaternion or by q[i] for in[i]
+    static void rotate_all(const Quat& q, const Vec3* in, Vec3* out, const size_t n);
+    static void rotate_all(const Quat* q, const Vec3* in, Vec3* out, const size_t n);
+    static void rotate_all(const Quat& q, const float* x, const float* y, const float* z,
+                           float* out_x, float* out_y, float* out_z, const size_t n);
+    static void rotate_all(const Quat* q, const float* x, const float* y, const float* z,
+                           float* out_x, float* out_y, float* out_z, const size_t n);
+
     // Helper static constructors
     static Quat quaternion_from_vector(const float w, const Vec3& v);
     static Quat quaternion_from_vector(const Vec3& v);
-    static Quat quaternion_from_rotation(const Vec3& axis, const float angle);
+    static Quat quaternion_from_rotation(const Vec3& axis, const float angle,
+                                         const Precision precision = Precision::EXACT);
+    // out[i] turns by angles[i] around axes[i], the sines and cosines taken a batch at a time
+    static void quaternions_from_rotations(const Vec3* axes, const float* angles, Quat* out,
+                                           const size_t n,
+                                           const Precision precision = Precision::EXACT);
     static Vec3 vector_from_quaternion(const Quat& q);
 };
 
@@ -54,6 +91,159 @@ Quat operator*(const Vec3& a, const Quat& b);
 
 // IMPLEMENTATION
 
+namespace detail {
+
+#if defined(SML_SIMD_SSE)
+
+// four packed Vec3s, from x y z x | y z x y | z x y z into one register per axis
+inline void load_vec3x4_sse(const float* src, __m128& x, __m128& y, __m128& z) {
+    const __m128 v0 = _mm_loadu_ps(src);
+    const __m128 v1 = _mm_loadu_ps(src + 4);
+    const __m128 v2 = _mm_loadu_ps(src + 8);
+
+    x = _mm_shuffle_ps(v0, _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 1, 2, 2)),
+                       _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1)),
+                       _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2)), v2,
+                       _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+// the reverse of load_vec3x4_sse
+inline void store_vec3x4_sse(const __m128 x, const __m128 y, const __m128 z, float* dst) {
+    _mm_storeu_ps(dst, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                                      _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                                      _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                          _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                                          _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                                          _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                                          _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// four Quats as w, x, y, z columns
+inline void load_quatx4_sse(const Quat* q, __m128& w, __m128& x, __m128& y, __m128& z) {
+    const float* src = reinterpret_cast<const float*>(q);
+    w = _mm_loadu_ps(src);
+    x = _mm_loadu_ps(src + 4);
+    y = _mm_loadu_ps(src + 8);
+    z = _mm_loadu_ps(src + 12);
+    _MM_TRANSPOSE4_PS(w, x, y, z);
+}
+
+inline void rotate_sse(const __m128 w, const __m128 ux, const __m128 uy, const __m128 uz,
+                       __m128& x, __m128& y, __m128& z) {
+    const __m128 tx =
+        _mm_add_ps(_mm_sub_ps(_mm_mul_ps(uy, z), _mm_mul_ps(uz, y)), _mm_mul_ps(w, x));
+    const __m128 ty =
+        _mm_add_ps(_mm_sub_ps(_mm_mul_ps(uz, x), _mm_mul_ps(ux, z)), _mm_mul_ps(w, y));
+    const __m128 tz =
+        _mm_add_ps(_mm_sub_ps(_mm_mul_ps(ux, y), _mm_mul_ps(uy, x)), _mm_mul_ps(w, z));
+    const __m128 two = _mm_set1_ps(2.f);
+    x = _mm_add_ps(x, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uy, tz), _mm_mul_ps(uz, ty))));
+    y = _mm_add_ps(y, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(uz, tx), _mm_mul_ps(ux, tz))));
+    z = _mm_add_ps(z, _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(ux, ty), _mm_mul_ps(uy, tx))));
+}
+
+#endif
+
+#if defined(SML_SIMD_AVX)
+
+// eight packed Vec3s into one register per axis, vectors 0-3 in the lower half and
+// 4-7 in the upper one, where the same in-lane shuffles pick them apart
+inline void load_vec3x8_avx(const float* src, __m256& x, __m256& y, __m256& z) {
+    const __m256 v0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)),
+                                           _mm_loadu_ps(src + 12), 1);
+    const __m256 v1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)),
+                                           _mm_loadu_ps(src + 16), 1);
+    const __m256 v2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)),
+                                           _mm_loadu_ps(src + 20), 1);
+
+    const __m256 xy = _mm256_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m256 yz = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm256_shuffle_ps(v0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm256_shuffle_ps(yz, v2, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// the reverse of load_vec3x8_avx
+inline void store_vec3x8_avx(const __m256 x, const __m256 y, const __m256 z, float* dst) {
+    const __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 v0 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 v1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 v2 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    _mm_storeu_ps(dst, _mm256_castps256_ps128(v0));
+    _mm_storeu_ps(dst + 4, _mm256_castps256_ps128(v1));
+    _mm_storeu_ps(dst + 8, _mm256_castps256_ps128(v2));
+    _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(v0, 1));
+    _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(v1, 1));
+    _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(v2, 1));
+}
+
+// eight Quats as w, x, y, z columns, transposed like _MM_TRANSPOSE4_PS within each half
+inline void load_quatx8_avx(const Quat* q, __m256& w, __m256& x, __m256& y, __m256& z) {
+    const float* src = reinterpret_cast<const float*>(q);
+    const __m256 q04 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)),
+                                            _mm_loadu_ps(src + 16), 1);
+    const __m256 q15 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)),
+                                            _mm_loadu_ps(src + 20), 1);
+    const __m256 q26 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)),
+                                            _mm_loadu_ps(src + 24), 1);
+    const __m256 q37 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 12)),
+                                            _mm_loadu_ps(src + 28), 1);
+
+    const __m256 wx01 = _mm256_unpacklo_ps(q04, q15);
+    const __m256 yz01 = _mm256_unpackhi_ps(q04, q15);
+    const __m256 wx23 = _mm256_unpacklo_ps(q26, q37);
+    const __m256 yz23 = _mm256_unpackhi_ps(q26, q37);
+    w = _mm256_shuffle_ps(wx01, wx23, _MM_SHUFFLE(1, 0, 1, 0));
+    x = _mm256_shuffle_ps(wx01, wx23, _MM_SHUFFLE(3, 2, 3, 2));
+    y = _mm256_shuffle_ps(yz01, yz23, _MM_SHUFFLE(1, 0, 1, 0));
+    z = _mm256_shuffle_ps(yz01, yz23, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+inline void rotate_avx(const __m256 w, const __m256 ux, const __m256 uy, const __m256 uz,
+                       __m256& x, __m256& y, __m256& z) {
+    const __m256 tx = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(uy, z), _mm256_mul_ps(uz, y)),
+                                    _mm256_mul_ps(w, x));
+    const __m256 ty = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(uz, x), _mm256_mul_ps(ux, z)),
+                                    _mm256_mul_ps(w, y));
+    const __m256 tz = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(ux, y), _mm256_mul_ps(uy, x)),
+                                    _mm256_mul_ps(w, z));
+    const __m256 two = _mm256_set1_ps(2.f);
+    x = _mm256_add_ps(
+        x, _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(uy, tz), _mm256_mul_ps(uz, ty))));
+    y = _mm256_add_ps(
+        y, _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(uz, tx), _mm256_mul_ps(ux, tz))));
+    z = _mm256_add_ps(
+        z, _mm256_mul_ps(two, _mm256_sub_ps(_mm256_mul_ps(ux, ty), _mm256_mul_ps(uy, tx))));
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON)
+
+inline void rotate_neon(const float32x4_t w, const float32x4_t ux, const float32x4_t uy,
+                        const float32x4_t uz, float32x4_t& x, float32x4_t& y, float32x4_t& z) {
+    const float32x4_t tx =
+        vaddq_f32(vsubq_f32(vmulq_f32(uy, z), vmulq_f32(uz, y)), vmulq_f32(w, x));
+    const float32x4_t ty =
+        vaddq_f32(vsubq_f32(vmulq_f32(uz, x), vmulq_f32(ux, z)), vmulq_f32(w, y));
+    const float32x4_t tz =
+        vaddq_f32(vsubq_f32(vmulq_f32(ux, y), vmulq_f32(uy, x)), vmulq_f32(w, z));
+    x = vaddq_f32(x, vmulq_n_f32(vsubq_f32(vmulq_f32(uy, tz), vmulq_f32(uz, ty)), 2.f));
+    y = vaddq_f32(y, vmulq_n_f32(vsubq_f32(vmulq_f32(uz, tx), vmulq_f32(ux, tz)), 2.f));
+    z = vaddq_f32(z, vmulq_n_f32(vsubq_f32(vmulq_f32(ux, ty), vmulq_f32(uy, tx)), 2.f));
+}
+
+#endif
+
+}  // namespace detail
+
 inline Vec3& translate(Vec3& a, const Vec3& b) { return a += b; }
 
 inline Vec3 translated(const Vec3& a, const Vec3& b) { return a + b; }
@@ -68,8 +258,172 @@ inline Vec3& Transform::rotate(Vec3& v, const Quat& q) {
 }
 
 inline Vec3 Transform::rotated(const Vec3& v, const Quat& q) {
-    const Vec3& qv = vector_from_quaternion(q);
-    return v + 2 * (qv.cross((qv.cross(v)) + q.w * v));
+    const Vec3 qv = vector_from_quaternion(q);
+    return madd(qv.cross(madd(v, q.w, qv.cross(v))), 2, v);
+}
+
+inline void Transform::rotate_all(const Quat& q, const Vec3* in, Vec3* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    const __m256 w = _mm256_set1_ps(q.w);
+    const __m256 ux = _mm256_set1_ps(q.x), uy = _mm256_set1_ps(q.y), uz = _mm256_set1_ps(q.z);
+    for (; i < groups_end; i += 8) {
+        __m256 x, y, z;
+        detail::load_vec3x8_avx(reinterpret_cast<const float*>(in + i), x, y, z);
+        detail::rotate_avx(w, ux, uy, uz, x, y, z);
+        detail::store_vec3x8_avx(x, y, z, reinterpret_cast<float*>(out + i));
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    const __m128 w = _mm_set1_ps(q.w);
+    const __m128 ux = _mm_set1_ps(q.x), uy = _mm_set1_ps(q.y), uz = _mm_set1_ps(q.z);
+    for (; i < groups_end; i += 4) {
+        __m128 x, y, z;
+        detail::load_vec3x4_sse(reinterpret_cast<const float*>(in + i), x, y, z);
+        detail::rotate_sse(w, ux, uy, uz, x, y, z);
+        detail::store_vec3x4_sse(x, y, z, reinterpret_cast<float*>(out + i));
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    const float32x4_t w = vdupq_n_f32(q.w);
+    const float32x4_t ux = vdupq_n_f32(q.x), uy = vdupq_n_f32(q.y), uz = vdupq_n_f32(q.z);
+    for (; i < groups_end; i += 4) {
+        float32x4x3_t v = vld3q_f32(reinterpret_cast<const float*>(in + i));
+        detail::rotate_neon(w, ux, uy, uz, v.val[0], v.val[1], v.val[2]);
+        vst3q_f32(reinterpret_cast<float*>(out + i), v);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = rotated(in[i], q);
+    }
+}
+
+inline void Transform::rotate_all(const Quat* q, const Vec3* in, Vec3* out, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    for (; i < groups_end; i += 8) {
+        __m256 w, ux, uy, uz, x, y, z;
+        detail::load_quatx8_avx(q + i, w, ux, uy, uz);
+        detail::load_vec3x8_avx(reinterpret_cast<const float*>(in + i), x, y, z);
+        detail::rotate_avx(w, ux, uy, uz, x, y, z);
+        detail::store_vec3x8_avx(x, y, z, reinterpret_cast<float*>(out + i));
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 w, ux, uy, uz, x, y, z;
+        detail::load_quatx4_sse(q + i, w, ux, uy, uz);
+        detail::load_vec3x4_sse(reinterpret_cast<const float*>(in + i), x, y, z);
+        detail::rotate_sse(w, ux, uy, uz, x, y, z);
+        detail::store_vec3x4_sse(x, y, z, reinterpret_cast<float*>(out + i));
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        const float32x4x4_t u = vld4q_f32(reinterpret_cast<const float*>(q + i));
+        float32x4x3_t v = vld3q_f32(reinterpret_cast<const float*>(in + i));
+        detail::rotate_neon(u.val[0], u.val[1], u.val[2], u.val[3], v.val[0], v.val[1], v.val[2]);
+        vst3q_f32(reinterpret_cast<float*>(out + i), v);
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = rotated(in[i], q[i]);
+    }
+}
+
+inline void Transform::rotate_all(const Quat& q, const float* x, const float* y, const float* z,
+                                  float* out_x, float* out_y, float* out_z, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    const __m256 w = _mm256_set1_ps(q.w);
+    const __m256 ux = _mm256_set1_ps(q.x), uy = _mm256_set1_ps(q.y), uz = _mm256_set1_ps(q.z);
+    for (; i < groups_end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        detail::rotate_avx(w, ux, uy, uz, vx, vy, vz);
+        _mm256_storeu_ps(out_x + i, vx);
+        _mm256_storeu_ps(out_y + i, vy);
+        _mm256_storeu_ps(out_z + i, vz);
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    const __m128 w = _mm_set1_ps(q.w);
+    const __m128 ux = _mm_set1_ps(q.x), uy = _mm_set1_ps(q.y), uz = _mm_set1_ps(q.z);
+    for (; i < groups_end; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        detail::rotate_sse(w, ux, uy, uz, vx, vy, vz);
+        _mm_storeu_ps(out_x + i, vx);
+        _mm_storeu_ps(out_y + i, vy);
+        _mm_storeu_ps(out_z + i, vz);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    const float32x4_t w = vdupq_n_f32(q.w);
+    const float32x4_t ux = vdupq_n_f32(q.x), uy = vdupq_n_f32(q.y), uz = vdupq_n_f32(q.z);
+    for (; i < groups_end; i += 4) {
+        float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+        detail::rotate_neon(w, ux, uy, uz, vx, vy, vz);
+        vst1q_f32(out_x + i, vx);
+        vst1q_f32(out_y + i, vy);
+        vst1q_f32(out_z + i, vz);
+    }
+#endif
+    for (; i < n; i++) {
+        const Vec3 v = rotated(Vec3(x[i], y[i], z[i]), q);
+        out_x[i] = v.x;
+        out_y[i] = v.y;
+        out_z[i] = v.z;
+    }
+}
+
+inline void Transform::rotate_all(const Quat* q, const float* x, const float* y, const float* z,
+                                  float* out_x, float* out_y, float* out_z, const size_t n) {
+    size_t i = 0;
+#if defined(SML_SIMD_AVX)
+    const size_t groups_end = n - n % 8;
+    for (; i < groups_end; i += 8) {
+        __m256 w, ux, uy, uz;
+        detail::load_quatx8_avx(q + i, w, ux, uy, uz);
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        detail::rotate_avx(w, ux, uy, uz, vx, vy, vz);
+        _mm256_storeu_ps(out_x + i, vx);
+        _mm256_storeu_ps(out_y + i, vy);
+        _mm256_storeu_ps(out_z + i, vz);
+    }
+#elif defined(SML_SIMD_SSE)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        __m128 w, ux, uy, uz;
+        detail::load_quatx4_sse(q + i, w, ux, uy, uz);
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        detail::rotate_sse(w, ux, uy, uz, vx, vy, vz);
+        _mm_storeu_ps(out_x + i, vx);
+        _mm_storeu_ps(out_y + i, vy);
+        _mm_storeu_ps(out_z + i, vz);
+    }
+#elif defined(SML_SIMD_NEON)
+    const size_t groups_end = n - n % 4;
+    for (; i < groups_end; i += 4) {
+        const float32x4x4_t u = vld4q_f32(reinterpret_cast<const float*>(q + i));
+        float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+        detail::rotate_neon(u.val[0], u.val[1], u.val[2], u.val[3], vx, vy, vz);
+        vst1q_f32(out_x + i, vx);
+        vst1q_f32(out_y + i, vy);
+        vst1q_f32(out_z + i, vz);
+    }
+#endif
+    for (; i < n; i++) {
+        const Vec3 v = rotated(Vec3(x[i], y[i], z[i]), q[i]);
+        out_x[i] = v.x;
+        out_y[i] = v.y;
+        out_z[i] = v.z;
+    }
 }
 
 inline Quat Transform::quaternion_from_vector(const float w, const Vec3& v) {
@@ -78,13 +432,35 @@ inline Quat Transform::quaternion_from_vector(const float w, const Vec3& v) {
 
 inline Quat Transform::quaternion_from_vector(const Vec3& v) { return Quat(0.0f, v.x, v.y, v.z); }
 
-inline Quat Transform::quaternion_from_rotation(const Vec3& axis, const float angle) {
-    float sine = static_cast<float>(std::sin(angle / 2));
-    float cosine = static_cast<float>(std::cos(angle / 2));
+inline Quat Transform::quaternion_from_rotation(const Vec3& axis, const float angle,
+                                                const Precision precision) {
+    float sine, cosine;
+    sincos(angle / 2, sine, cosine, precision);
     const Vec3 vector_component = sine * axis.normalized();
     return Quat(cosine, vector_component.x, vector_component.y, vector_component.z);
 }
 
+inline void Transform::quaternions_from_rotations(const Vec3* axes, const float* angles,
+                                                  Quat* out, const size_t n,
+                                                  const Precision precision) {
+    const size_t batch = 64;
+    float half_angles[batch];
+    float sines[batch];
+    float cosines[batch];
+    for (size_t first = 0; first < n; first += batch) {
+        const size_t count = n - first < batch ? n - first : batch;
+        for (size_t i = 0; i < count; i++) {
+            half_angles[i] = angles[first + i] / 2;
+        }
+        sincos(half_angles, sines, cosines, count, precision);
+        for (size_t i = 0; i < count; i++) {
+            const Vec3 vector_component = sines[i] * axes[first + i].normalized();
+            out[first + i] =
+                Quat(cosines[i], vector_component.x, vector_component.y, vector_component.z);
+        }
+    }
+}
+
 inline Vec3 Transform::vector_from_quaternion(const Quat& q) { return Vec3(q.x, q.y, q.z); }
 
 }  // namespace sml
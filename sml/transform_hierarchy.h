@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_TRANSFORM_HIERARCHY_H_
+#define SLIPPYS_MATH_LIBRARY_TRANSFORM_HIERARCHY_H_
+
+#include <cassert>
+#include <cstdint>
+#include <sml/matrix4.h>
+#include <sml/quaternion.h>
+#include <sml/vector3.h>
+#include <vector>
+
+/*
+
+TransformHierarchy keeps a whole tree of local transforms and their world
+matrices, one array per field:
+
+  translations  | t0 | t1 | t2 | ...
+  rotations     | r0 | r1 | r2 | ...
+  scales        | s0 | s1 | s2 | ...
+  parents       | -  | 0  | 1  | ...
+  world         | W0 | W1 | W2 | ...
+
+A node is always added after its parent, so every parent comes before its
+children. That lets update() compute every world matrix in one forward pass,
+reading each parent's matrix right after it was written:
+
+  world[i] = world[parent[i]] * translation[i] * rotation[i] * scale[i]
+
+Setting a local transform marks the node dirty. The pass carries dirtiness down
+to the children and skips the math for every node whose branch did not change.
+Node indices never change, so they can be kept as handles.
+
+*/
+
+namespace sml {
+
+class TransformHierarchy {
+   public:
+    TransformHierarchy() = default;
+
+    // nodes
+    size_t add(const Vec3& translation, const Quat& rotation, const Vec3& scale,
+               const size_t parent = NO_PARENT);
+    void reserve(const size_t n);
+    void clear();
+    size_t size() const;
+
+    size_t parent(const size_t node) const;
+    size_t depth(const size_t node) const;
+
+    // local transforms (setters mark the node's branch dirty)
+    const Vec3& local_translation(const size_t node) const;
+    const Quat& local_rotation(const size_t node) const;
+    const Vec3& local_scale(const size_t node) const;
+
+    void set_local_translation(const size_t node, const Vec3& translation);
+    void set_local_rotation(const size_t node, const Quat& rotation);
+    void set_local_scale(const size_t node, const Vec3& scale);
+
+    // world transforms (valid after update)
+    void update();
+    const Mat4& world(const size_t node) const;
+    const Mat4* world_matrices() const;
+
+    static const size_t NO_PARENT = SIZE_MAX;
+
+   private:
+    std::vector<Vec3> _translations;
+    std::vector<Quat> _rotations;
+    std::vector<Vec3> _scales;
+    std::vector<size_t> _parents;
+    std::vector<size_t> _depths;
+    std::vector<uint8_t> _dirty;
+    std::vector<uint8_t> _updated;
+    std::vector<Mat4> _world;
+};
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+// Nodes
+
+inline size_t TransformHierarchy::add(const Vec3& translation, const Quat& rotation,
+                                      const Vec3& scale, const size_t parent) {
+    assert(parent == NO_PARENT || parent < size());
+
+    _translations.push_back(translation);
+    _rotations.push_back(rotation);
+    _scales.push_back(scale);
+    _parents.push_back(parent);
+    _depths.push_back(parent == NO_PARENT ? 0 : _depths[parent] + 1);
+    _dirty.push_back(1);
+    _updated.push_back(0);
+    _world.push_back(Mat4::identity());
+
+    return size() - 1;
+}
+
+inline void TransformHierarchy::reserve(const size_t n) {
+    _translations.reserve(n);
+    _rotations.reserve(n);
+    _scales.reserve(n);
+    _parents.reserve(n);
+    _depths.reserve(n);
+    _dirty.reserve(n);
+    _updated.reserve(n);
+    _world.reserve(n);
+}
+
+inline void TransformHierarchy::clear() {
+    _translations.clear();
+    _rotations.clear();
+    _scales.clear();
+    _parents.clear();
+    _depths.clear();
+    _dirty.clear();
+    _updated.clear();
+    _world.clear();
+}
+
+inline size_t TransformHierarchy::size() const { return _parents.size(); }
+
+inline size_t TransformHierarchy::parent(const size_t node) const { return _parents[node]; }
+
+inline size_t TransformHierarchy::depth(const size_t node) const { return _depths[node]; }
+
+// Local transforms
+
+inline const Vec3& TransformHierarchy::local_translation(const size_t node) const {
+    return _translations[node];
+}
+
+inline const Quat& TransformHierarchy::local_rotation(const size_t node) const {
+    return _rotations[node];
+}
+
+inline const Vec3& TransformHierarchy::local_scale(const size_t node) const {
+    return _scales[node];
+}
+
+inline void TransformHierarchy::set_local_translation(const size_t node,
+                                                      const Vec3& translation) {
+    _translations[node] = translation;
+    _dirty[node] = 1;
+}
+
+inline void TransformHierarchy::set_local_rotation(const size_t node, const Quat& rotation) {
+    _rotations[node] = rotation;
+    _dirty[node] = 1;
+}
+
+inline void TransformHierarchy::set_local_scale(const size_t node, const Vec3& scale) {
+    _scales[node] = scale;
+    _dirty[node] = 1;
+}
+
+// World transforms
+
+inline void TransformHierarchy::update() {
+    const size_t n = size();
+    for (size_t i = 0; i < n; i++) {
+        const size_t p = _parents[i];
+        const bool is_root = p == NO_PARENT;
+        const uint8_t updated = _dirty[i] | (is_root ? 0 : _updated[p]);
+
+        _updated[i] = updated;
+        if (!updated) {
+            continue;
+        }
+
+        _dirty[i] = 0;
+        float* world = _world[i].data();
+        detail::compose_trs(_translations[i], _rotations[i], _scales[i], world);
+        if (!is_root) {
+            detail::multiply_mat4(_world[p].data(), world, world);
+        }
+    }
+}
+
+inline const Mat4& TransformHierarchy::world(const size_t node) const { return _world[node]; }
+
+inline const Mat4* TransformHierarchy::world_matrices() const { return _world.data(); }
+
+}  // namespace sml
+
+#endif
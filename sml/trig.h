@@ -0,0 +1,385 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_TRIG_H_
+#define SLIPPYS_MATH_LIBRARY_TRIG_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <sml/precision.h>
+#include <sml/simd.h>
+
+/*
+
+Sine, cosine and tangent in float
+
+Precision::EXACT calls the float overloads of std::sin, std::cos and std::tan.
+Precision::FAST evaluates polynomials, the same way in scalar and SIMD code:
+
+  q = round(angle * 2 / pi)
+  r = angle - q * pi / 2          (pi / 2 split in three, so r stays exact)
+  sin r ~ r + r^3 * S(r^2)        cos r ~ 1 - r^2 / 2 + r^4 * C(r^2)
+
+with S and C minimax fits over |r| <= pi / 4, and q % 4 picking the quadrant.
+Every path rounds q to nearest, ties to even, by adding and subtracting 1.5 * 2^23.
+
+For |angle| <= 8192 the sine and cosine are within 1e-7 of the true value
+(an absolute error) and, being built from the same r, sincos returns both for
+the price of one. Larger angles, infinities and NaNs are handed to std::sin
+and std::cos, as the reduction would lose too many bits. Tangent divides the
+two, so its relative error is about 1e-7 * (1 / |sin| + 1 / |cos|): below
+2.5e-7 where both are at least 0.5, and unbounded next to the zeros and poles.
+
+The batch forms work over arrays of angles, with SSE, AVX or NEON on FAST.
+The functions are named sine/cosine/tangent so they never hide the C library
+ones for unqualified calls inside the namespace.
+
+*/
+
+namespace sml {
+
+void sincos(const float angle, float& sine, float& cosine,
+            const Precision precision = Precision::EXACT);
+float sine(const float angle, const Precision precision = Precision::EXACT);
+float cosine(const float angle, const Precision precision = Precision::EXACT);
+float tangent(const float angle, const Precision precision = Precision::EXACT);
+
+// batches, 'out' arrays hold n floats
+void sincos(const float* angles, float* sines, float* cosines, const size_t n,
+            const Precision precision = Precision::EXACT);
+void tangent(const float* angles, float* out, const size_t n,
+             const Precision precision = Precision::EXACT);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+const float TRIG_TWO_OVER_PI = 0.636619772367581343f;
+
+// largest |angle| the FAST reduction takes, the rest goes to the C library
+const float TRIG_FAST_LIMIT = 8192.f;
+
+// adding and subtracting 1.5 * 2^23 rounds anything below 2^22 to an integer, ties to even
+const float TRIG_ROUND = 12582912.f;
+
+// pi / 2 = PIO2_A + PIO2_B + PIO2_C, PIO2_A and PIO2_B with few enough bits for exact products
+const float TRIG_PIO2_A = 1.5703125f;
+const float TRIG_PIO2_B = 4.837512969970703125e-4f;
+const float TRIG_PIO2_C = 7.54978995489188216e-8f;
+
+// minimax sine and cosine over [-pi / 4, pi / 4]
+const float TRIG_SIN_1 = -1.6666654611e-1f;
+const float TRIG_SIN_2 = 8.3321608736e-3f;
+const float TRIG_SIN_3 = -1.9515295891e-4f;
+const float TRIG_COS_1 = 4.166664568298827e-2f;
+const float TRIG_COS_2 = -1.388731625493765e-3f;
+const float TRIG_COS_3 = 2.443315711809948e-5f;
+
+inline void fast_sincos(const float angle, float& sine, float& cosine) {
+    if (!(std::fabs(angle) <= TRIG_FAST_LIMIT)) {
+        sine = std::sin(angle);
+        cosine = std::cos(angle);
+        return;
+    }
+    const float quadrant = (angle * TRIG_TWO_OVER_PI + TRIG_ROUND) - TRIG_ROUND;
+    const int32_t q = static_cast<int32_t>(quadrant);
+    const float r =
+        ((angle - quadrant * TRIG_PIO2_A) - quadrant * TRIG_PIO2_B) - quadrant * TRIG_PIO2_C;
+    const float z = r * r;
+
+    const float s = r + r * z * (TRIG_SIN_1 + z * (TRIG_SIN_2 + z * TRIG_SIN_3));
+    const float c = 1.f - .5f * z + z * z * (TRIG_COS_1 + z * (TRIG_COS_2 + z * TRIG_COS_3));
+
+    // quadrant 0: (s, c)   1: (c, -s)   2: (-s, -c)   3: (-c, s)
+    const bool swapped = (q & 1) != 0;
+    sine = (swapped ? c : s) * static_cast<float>(1 - (q & 2));
+    cosine = (swapped ? s : c) * static_cast<float>(1 - ((q + 1) & 2));
+}
+
+#if defined(SML_SIMD_SSE)
+
+// false when some angle is beyond TRIG_FAST_LIMIT or NaN, and the results are not to be used
+inline bool fast_sincos_sse(const __m128 angle, __m128& sine, __m128& cosine) {
+    const __m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), angle);
+    const __m128 in_range = _mm_cmple_ps(magnitude, _mm_set1_ps(TRIG_FAST_LIMIT));
+    const __m128 quadrant =
+        _mm_sub_ps(_mm_add_ps(_mm_mul_ps(angle, _mm_set1_ps(TRIG_TWO_OVER_PI)),
+                              _mm_set1_ps(TRIG_ROUND)),
+                   _mm_set1_ps(TRIG_ROUND));
+    const __m128i q = _mm_cvttps_epi32(quadrant);
+    __m128 r = _mm_sub_ps(angle, _mm_mul_ps(quadrant, _mm_set1_ps(TRIG_PIO2_A)));
+    r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(TRIG_PIO2_B)));
+    r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(TRIG_PIO2_C)));
+    const __m128 z = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_set1_ps(TRIG_SIN_2), _mm_mul_ps(z, _mm_set1_ps(TRIG_SIN_3)));
+    s = _mm_add_ps(_mm_set1_ps(TRIG_SIN_1), _mm_mul_ps(z, s));
+    s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), s));
+    __m128 c = _mm_add_ps(_mm_set1_ps(TRIG_COS_2), _mm_mul_ps(z, _mm_set1_ps(TRIG_COS_3)));
+    c = _mm_add_ps(_mm_set1_ps(TRIG_COS_1), _mm_mul_ps(z, c));
+    c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(.5f), z)),
+                   _mm_mul_ps(_mm_mul_ps(z, z), c));
+
+    const __m128 swapped =
+        _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    const __m128 sine_sign =
+        _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    const __m128 cosine_sign = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swapped, c), _mm_andnot_ps(swapped, s)), sine_sign);
+    cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swapped, s), _mm_andnot_ps(swapped, c)), cosine_sign);
+
+    return _mm_movemask_ps(in_range) == 0xf;
+}
+
+#endif
+
+#if defined(SML_SIMD_AVX)
+
+// without AVX2 there is no 256-bit integer math, so the quadrant is taken apart in floats
+inline bool fast_sincos_avx(const __m256 angle, __m256& sine, __m256& cosine) {
+    const __m256 magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.f), angle);
+    const __m256 in_range =
+        _mm256_cmp_ps(magnitude, _mm256_set1_ps(TRIG_FAST_LIMIT), _CMP_LE_OQ);
+    const __m256 quadrant =
+        _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(angle, _mm256_set1_ps(TRIG_TWO_OVER_PI)),
+                                    _mm256_set1_ps(TRIG_ROUND)),
+                      _mm256_set1_ps(TRIG_ROUND));
+    __m256 r = _mm256_sub_ps(angle, _mm256_mul_ps(quadrant, _mm256_set1_ps(TRIG_PIO2_A)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(quadrant, _mm256_set1_ps(TRIG_PIO2_B)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(quadrant, _mm256_set1_ps(TRIG_PIO2_C)));
+    const __m256 z = _mm256_mul_ps(r, r);
+
+    __m256 s =
+        _mm256_add_ps(_mm256_set1_ps(TRIG_SIN_2), _mm256_mul_ps(z, _mm256_set1_ps(TRIG_SIN_3)));
+    s = _mm256_add_ps(_mm256_set1_ps(TRIG_SIN_1), _mm256_mul_ps(z, s));
+    s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), s));
+    __m256 c =
+        _mm256_add_ps(_mm256_set1_ps(TRIG_COS_2), _mm256_mul_ps(z, _mm256_set1_ps(TRIG_COS_3)));
+    c = _mm256_add_ps(_mm256_set1_ps(TRIG_COS_1), _mm256_mul_ps(z, c));
+    c = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(_mm256_set1_ps(.5f), z)),
+                      _mm256_mul_ps(_mm256_mul_ps(z, z), c));
+
+    // q % 4, always in 0..3
+    const __m256 quarter = _mm256_floor_ps(_mm256_mul_ps(quadrant, _mm256_set1_ps(.25f)));
+    const __m256 k = _mm256_sub_ps(quadrant, _mm256_mul_ps(quarter, _mm256_set1_ps(4.f)));
+    const __m256 swapped = _mm256_or_ps(_mm256_cmp_ps(k, _mm256_set1_ps(1.f), _CMP_EQ_OQ),
+                                        _mm256_cmp_ps(k, _mm256_set1_ps(3.f), _CMP_EQ_OQ));
+    const __m256 sign_bit = _mm256_set1_ps(-0.f);
+    const __m256 sine_sign =
+        _mm256_and_ps(_mm256_cmp_ps(k, _mm256_set1_ps(2.f), _CMP_GE_OQ), sign_bit);
+    const __m256 cosine_sign = _mm256_and_ps(
+        _mm256_or_ps(_mm256_cmp_ps(k, _mm256_set1_ps(1.f), _CMP_EQ_OQ),
+                     _mm256_cmp_ps(k, _mm256_set1_ps(2.f), _CMP_EQ_OQ)),
+        sign_bit);
+    sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swapped), sine_sign);
+    cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swapped), cosine_sign);
+
+    return _mm256_movemask_ps(in_range) == 0xff;
+}
+
+#endif
+
+#if defined(SML_SIMD_NEON)
+
+inline bool fast_sincos_neon(const float32x4_t angle, float32x4_t& sine, float32x4_t& cosine) {
+    const uint32x4_t in_range = vcleq_f32(vabsq_f32(angle), vdupq_n_f32(TRIG_FAST_LIMIT));
+    const float32x4_t quadrant =
+        vsubq_f32(vmlaq_f32(vdupq_n_f32(TRIG_ROUND), angle, vdupq_n_f32(TRIG_TWO_OVER_PI)),
+                  vdupq_n_f32(TRIG_ROUND));
+    const int32x4_t q = vcvtq_s32_f32(quadrant);
+    float32x4_t r = vmlsq_f32(angle, quadrant, vdupq_n_f32(TRIG_PIO2_A));
+    r = vmlsq_f32(r, quadrant, vdupq_n_f32(TRIG_PIO2_B));
+    r = vmlsq_f32(r, quadrant, vdupq_n_f32(TRIG_PIO2_C));
+    const float32x4_t z = vmulq_f32(r, r);
+
+    float32x4_t s = vmlaq_f32(vdupq_n_f32(TRIG_SIN_2), z, vdupq_n_f32(TRIG_SIN_3));
+    s = vmlaq_f32(vdupq_n_f32(TRIG_SIN_1), z, s);
+    s = vmlaq_f32(r, vmulq_f32(r, z), s);
+    float32x4_t c = vmlaq_f32(vdupq_n_f32(TRIG_COS_2), z, vdupq_n_f32(TRIG_COS_3));
+    c = vmlaq_f32(vdupq_n_f32(TRIG_COS_1), z, c);
+    c = vmlaq_f32(vmlsq_f32(vdupq_n_f32(1.f), vdupq_n_f32(.5f), z), vmulq_f32(z, z), c);
+
+    const uint32x4_t swapped = vtstq_s32(q, vdupq_n_s32(1));
+    const uint32x4_t sine_sign =
+        vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(q), vdupq_n_u32(2)), 30);
+    const uint32x4_t cosine_sign = vshlq_n_u32(
+        vandq_u32(vreinterpretq_u32_s32(vaddq_s32(q, vdupq_n_s32(1))), vdupq_n_u32(2)), 30);
+    const uint32x4_t swapped_sine = vreinterpretq_u32_f32(vbslq_f32(swapped, c, s));
+    const uint32x4_t swapped_cosine = vreinterpretq_u32_f32(vbslq_f32(swapped, s, c));
+    sine = vreinterpretq_f32_u32(veorq_u32(swapped_sine, sine_sign));
+    cosine = vreinterpretq_f32_u32(veorq_u32(swapped_cosine, cosine_sign));
+
+    const uint32x2_t halves = vand_u32(vget_low_u32(in_range), vget_high_u32(in_range));
+    return vget_lane_u32(vpmin_u32(halves, halves), 0) != 0;
+}
+
+#endif
+
+}  // namespace detail
+
+inline void sincos(const float angle, float& sine, float& cosine, const Precision precision) {
+    if (precision == Precision::FAST) {
+        detail::fast_sincos(angle, sine, cosine);
+    } else {
+        sine = std::sin(angle);
+        cosine = std::cos(angle);
+    }
+}
+
+inline float sine(const float angle, const Precision precision) {
+    float s, c;
+    sincos(angle, s, c, precision);
+    return s;
+}
+
+inline float cosine(const float angle, const Precision precision) {
+    float s, c;
+    sincos(angle, s, c, precision);
+    return c;
+}
+
+inline float tangent(const float angle, const Precision precision) {
+    if (precision == Precision::FAST) {
+        float s, c;
+        detail::fast_sincos(angle, s, c);
+        return s / c;
+    }
+    return std::tan(angle);
+}
+
+inline void sincos(const float* angles, float* sines, float* cosines, const size_t n,
+                   const Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FAST) {
+#if defined(SML_SIMD_AVX)
+        const size_t groups_end = n - n % 8;
+        for (; i < groups_end; i += 8) {
+            __m256 s, c;
+            if (!detail::fast_sincos_avx(_mm256_loadu_ps(angles + i), s, c)) {
+                // some angle needs the C library, so the group goes one by one
+                for (size_t k = i; k < i + 8; k++) {
+                    detail::fast_sincos(angles[k], sines[k], cosines[k]);
+                }
+                continue;
+            }
+            _mm256_storeu_ps(sines + i, s);
+            _mm256_storeu_ps(cosines + i, c);
+        }
+#elif defined(SML_SIMD_SSE)
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            __m128 s, c;
+            if (!detail::fast_sincos_sse(_mm_loadu_ps(angles + i), s, c)) {
+                // some angle needs the C library, so the group goes one by one
+                for (size_t k = i; k < i + 4; k++) {
+                    detail::fast_sincos(angles[k], sines[k], cosines[k]);
+                }
+                continue;
+            }
+            _mm_storeu_ps(sines + i, s);
+            _mm_storeu_ps(cosines + i, c);
+        }
+#elif defined(SML_SIMD_NEON)
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            float32x4_t s, c;
+            if (!detail::fast_sincos_neon(vld1q_f32(angles + i), s, c)) {
+                // some angle needs the C library, so the group goes one by one
+                for (size_t k = i; k < i + 4; k++) {
+                    detail::fast_sincos(angles[k], sines[k], cosines[k]);
+                }
+                continue;
+            }
+            vst1q_f32(sines + i, s);
+            vst1q_f32(cosines + i, c);
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        sincos(angles[i], sines[i], cosines[i], precision);
+    }
+}
+
+inline void tangent(const float* angles, float* out, const size_t n, const Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::FAST) {
+#if defined(SML_SIMD_AVX)
+        const size_t groups_end = n - n % 8;
+        for (; i < groups_end; i += 8) {
+            __m256 s, c;
+            if (!detail::fast_sincos_avx(_mm256_loadu_ps(angles + i), s, c)) {
+                for (size_t k = i; k < i + 8; k++) {
+                    out[k] = tangent(angles[k], Precision::FAST);
+                }
+                continue;
+            }
+            _mm256_storeu_ps(out + i, _mm256_div_ps(s, c));
+        }
+#elif defined(SML_SIMD_SSE)
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            __m128 s, c;
+            if (!detail::fast_sincos_sse(_mm_loadu_ps(angles + i), s, c)) {
+                for (size_t k = i; k < i + 4; k++) {
+                    out[k] = tangent(angles[k], Precision::FAST);
+                }
+                continue;
+            }
+            _mm_storeu_ps(out + i, _mm_div_ps(s, c));
+        }
+#elif defined(SML_SIMD_NEON)
+        const size_t groups_end = n - n % 4;
+        for (; i < groups_end; i += 4) {
+            float32x4_t s, c;
+            if (!detail::fast_sincos_neon(vld1q_f32(angles + i), s, c)) {
+                for (size_t k = i; k < i + 4; k++) {
+                    out[k] = tangent(angles[k], Precision::FAST);
+                }
+                continue;
+            }
+#if defined(__aarch64__)
+            vst1q_f32(out + i, vdivq_f32(s, c));
+#else
+            // reciprocal estimate with two refinements, NEON has no vector divide before AArch64
+            float32x4_t inverse = vrecpeq_f32(c);
+            inverse = vmulq_f32(inverse, vrecpsq_f32(c, inverse));
+            inverse = vmulq_f32(inverse, vrecpsq_f32(c, inverse));
+            vst1q_f32(out + i, vmulq_f32(s, inverse));
+#endif
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        out[i] = tangent(angles[i], precision);
+    }
+}
+
+}  // namespace sml
+
+#endif
@@ -24,24 +24,27 @@
 
 #include <cfloat>
 #include <cmath>
-#include <sstream>
+#include <sml/format.h>
+#include <sml/precision.h>
+#include <sml/trig.h>
 #include <string>
 
 namespace sml {
 
 class Vec3 {
    public:
-    Vec3();
-    Vec3(float _x, float _y, float _z);
+    constexpr Vec3();
+    constexpr Vec3(float _x, float _y, float _z);
 
     // data
     float x, y, z;
 
     // methods
     const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
 
-    float dot(const Vec3& v) const;
-    Vec3 cross(const Vec3& v) const;
+    constexpr float dot(const Vec3& v) const;
+    constexpr Vec3 cross(const Vec3& v) const;
 
     Vec3 normalized() const;
     Vec3& normalize();
@@ -50,30 +53,36 @@ class Vec3 {
     Vec3& clamp(const float s);
 
     float length() const;
-    float length_squared() const;
+    constexpr float length_squared() const;
 
-    Vec3 translated(const Vec3& v) const;
-    Vec3& translate(const Vec3& v);
+    constexpr Vec3 translated(const Vec3& v) const;
+    constexpr Vec3& translate(const Vec3& v);
 
-    Vec3& rotate(const Vec3& axis, const double angle);
-    Vec3 rotated(const Vec3& axis, const double angle) const;
+    // Precision::FAST takes the sine and cosine from sml::sincos instead of double libm
+    Vec3& rotate(const Vec3& axis, const double angle,
+                 const Precision precision = Precision::EXACT);
+    Vec3 rotated(const Vec3& axis, const double angle,
+                 const Precision precision = Precision::EXACT) const;
 
-    Vec3 scaled(const float s) const;
-    Vec3& scale(const float s);
+    constexpr Vec3 scaled(const float s) const;
+    constexpr Vec3& scale(const float s);
 
     // convenient
-    static Vec3 zero();
-    static Vec3 up();
-    static Vec3 down();
-    static Vec3 front();
-    static Vec3 back();
-    static Vec3 left();
-    static Vec3 right();
+    static constexpr Vec3 zero();
+    static constexpr Vec3 up();
+    static constexpr Vec3 down();
+    static constexpr Vec3 front();
+    static constexpr Vec3 back();
+    static constexpr Vec3 left();
+    static constexpr Vec3 right();
 
     // convenient axes
-    static Vec3 x_axis();
-    static Vec3 y_axis();
-    static Vec3 z_axis();
+    static constexpr Vec3 x_axis();
+    static constexpr Vec3 y_axis();
+    static constexpr Vec3 z_axis();
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 41;
 };
 
 // Imutable operators
@@ -82,31 +91,53 @@ bool operator==(const Vec3& a, const Vec3& b);
 
 bool operator!=(const Vec3& a, const Vec3& b);
 
-Vec3 operator*(const float a, const Vec3& v);
+constexpr Vec3 operator*(const float a, const Vec3& v);
 
-Vec3 operator*(const Vec3& v, const float a);
+constexpr Vec3 operator*(const Vec3& v, const float a);
 
-Vec3 operator/(const Vec3& v, const float a);
+constexpr Vec3 operator/(const Vec3& v, const float a);
 
-float operator*(const Vec3& a, const Vec3& b);
+constexpr float operator*(const Vec3& a, const Vec3& b);
 
-Vec3 operator^(const Vec3& a, const Vec3& b);
+constexpr Vec3 operator^(const Vec3& a, const Vec3& b);
 
-Vec3 operator+(const Vec3& a, const Vec3& b);
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b);
 
-Vec3 operator-(const Vec3& a, const Vec3& b);
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b);
 
-Vec3 operator-(const Vec3& v);
+constexpr Vec3 operator-(const Vec3& v);
 
 // Mutable operators
 
-Vec3& operator*=(Vec3& v, const float a);
+constexpr Vec3& operator*=(Vec3& v, const float a);
 
-Vec3& operator/=(Vec3& v, const float a);
+constexpr Vec3& operator/=(Vec3& v, const float a);
 
-Vec3& operator+=(Vec3& a, const Vec3& b);
+constexpr Vec3& operator+=(Vec3& a, const Vec3& b);
 
-Vec3& operator-=(Vec3& a, const Vec3& b);
+constexpr Vec3& operator-=(Vec3& a, const Vec3& b);
+
+/*
+Fused operations
+
+Each one works out the whole result in a single pass over the components. An
+operator chain like a * s + b makes a Vec3 per operator, which an optimizer
+removes, but a debug build pays for every one of them.
+*/
+
+// a * s + b
+constexpr Vec3 madd(const Vec3& a, const float s, const Vec3& b);
+
+// a + (b - a) * t
+constexpr Vec3 lerp(const Vec3& a, const Vec3& b, const float t);
+
+// a * sa + b * sb + c * sc
+constexpr Vec3 lincomb3(const Vec3& a, const float sa, const Vec3& b, const float sb,
+                        const Vec3& c, const float sc);
+
+// v turned around a unit axis by the angle with the given sine and cosine (Rodrigues)
+constexpr Vec3 rotate_axis_angle(const Vec3& v, const Vec3& unit_axis, const float sine,
+                                 const float cosine);
 
 /*
 
@@ -116,78 +147,56 @@ Vec3& operator-=(Vec3& a, const Vec3& b);
 
 */
 
-inline Vec3::Vec3() : Vec3(0.0f, 0.0f, 0.0f) {}
+constexpr Vec3::Vec3() : Vec3(0.0f, 0.0f, 0.0f) {}
 
-inline Vec3::Vec3(float _x, float _y, float _z) : x{_x}, y{_y}, z{_z} {}
+constexpr Vec3::Vec3(float _x, float _y, float _z) : x{_x}, y{_y}, z{_z} {}
 
 // Static members
 
-inline Vec3 Vec3::zero() {
-    static const Vec3 v = Vec3();
-    return v;
-}
+constexpr Vec3 Vec3::zero() { return Vec3(); }
 
-inline Vec3 Vec3::up() {
-    static const Vec3 v = Vec3(0, 1, 0);
-    return v;
-}
+constexpr Vec3 Vec3::up() { return Vec3(0, 1, 0); }
 
-inline Vec3 Vec3::down() {
-    static const Vec3 v = Vec3(0, -1, 0);
-    return v;
-}
+constexpr Vec3 Vec3::down() { return Vec3(0, -1, 0); }
 
-inline Vec3 Vec3::front() {
-    static const Vec3 v = Vec3(0, 0, -1);
-    return v;
-}
+constexpr Vec3 Vec3::front() { return Vec3(0, 0, -1); }
 
-inline Vec3 Vec3::back() {
-    static const Vec3 v = Vec3(0, 0, 1);
-    return v;
-}
+constexpr Vec3 Vec3::back() { return Vec3(0, 0, 1); }
 
-inline Vec3 Vec3::left() {
-    static const Vec3 v = Vec3(-1, 0, 0);
-    return v;
-}
+constexpr Vec3 Vec3::left() { return Vec3(-1, 0, 0); }
 
-inline Vec3 Vec3::right() {
-    static const Vec3 v = Vec3(1, 0, 0);
-    return v;
-}
+constexpr Vec3 Vec3::right() { return Vec3(1, 0, 0); }
 
-inline Vec3 Vec3::x_axis() {
-    static const Vec3 v = Vec3(1.0f, 0.0f, 0.0f);
-    return v;
-}
+constexpr Vec3 Vec3::x_axis() { return Vec3(1.0f, 0.0f, 0.0f); }
 
-inline Vec3 Vec3::y_axis() {
-    static const Vec3 v = Vec3(0.0f, 1.0f, 0.0f);
-    return v;
-}
+constexpr Vec3 Vec3::y_axis() { return Vec3(0.0f, 1.0f, 0.0f); }
 
-inline Vec3 Vec3::z_axis() {
-    static const Vec3 v = Vec3(0.0f, 0.0f, 1.0f);
-    return v;
-}
+constexpr Vec3 Vec3::z_axis() { return Vec3(0.0f, 0.0f, 1.0f); }
 
 // Methods
 
 inline const std::string Vec3::to_string() const {
-    std::stringstream stream;
-    stream.precision(4);
-    stream << "Vec3(";
-    stream << std::showpos << std::showpoint;
-    stream << x << ", " << y << ", " << z << ")";
-    return stream.str();
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Vec3::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Vec3(");
+    writer.append_precise(x);
+    writer.append(", ");
+    writer.append_precise(y);
+    writer.append(", ");
+    writer.append_precise(z);
+    writer.append(")");
+    return writer.finish();
 }
 
 /*
 Dot product
 ux * vx + uy * vy + uz * vz
 */
-inline float Vec3::dot(const Vec3& v) const { return (x * v.x) + (y * v.y) + (z * v.z); }
+constexpr float Vec3::dot(const Vec3& v) const { return (x * v.x) + (y * v.y) + (z * v.z); }
 
 /*
 Cross product
@@ -195,7 +204,7 @@ Cross product
 |  a1 a2 a3  |
 |  b1 b2 b3  |
 */
-inline Vec3 Vec3::cross(const Vec3& v) const {
+constexpr Vec3 Vec3::cross(const Vec3& v) const {
     return Vec3((y * v.z) - (z * v.y), (z * v.x) - (x * v.z), (x * v.y) - (y * v.x));
 }
 
@@ -222,38 +231,41 @@ inline Vec3& Vec3::clamp(const float s) {
     return scale(s);
 }
 
-inline float Vec3::length() const { return static_cast<float>(sqrt(length_squared())); }
+inline float Vec3::length() const { return std::sqrt(length_squared()); }
 
-inline float Vec3::length_squared() const { return dot(*this); }
+constexpr float Vec3::length_squared() const { return dot(*this); }
 
-inline Vec3 Vec3::translated(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+constexpr Vec3 Vec3::translated(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
 
-inline Vec3& Vec3::translate(const Vec3& v) {
+constexpr Vec3& Vec3::translate(const Vec3& v) {
     x += v.x;
     y += v.y;
     z += v.z;
     return *this;
 }
 
-inline Vec3 Vec3::rotated(const Vec3& axis, const double angle) const {
-    const float sine = static_cast<float>(sin(angle));
-    const float cosine = static_cast<float>(cos(angle));
-    const Vec3 normal = axis.normalized();
-    const Vec3& v = (*this);
-    return (1 - cosine) * dot(normal) * normal + cosine * v + sine * normal.cross(v);
+inline Vec3 Vec3::rotated(const Vec3& axis, const double angle, const Precision precision) const {
+    float sine, cosine;
+    if (precision == Precision::FAST) {
+        sincos(static_cast<float>(angle), sine, cosine, precision);
+    } else {
+        sine = static_cast<float>(sin(angle));
+        cosine = static_cast<float>(cos(angle));
+    }
+    return rotate_axis_angle(*this, axis.normalized(), sine, cosine);
 }
 
-inline Vec3& Vec3::rotate(const Vec3& axis, const double angle) {
-    const Vec3 result = rotated(axis, angle);
+inline Vec3& Vec3::rotate(const Vec3& axis, const double angle, const Precision precision) {
+    const Vec3 result = rotated(axis, angle, precision);
     x = result.x;
     y = result.y;
     z = result.z;
     return *this;
 }
 
-inline Vec3 Vec3::scaled(const float s) const { return Vec3(x * s, y * s, z * s); }
+constexpr Vec3 Vec3::scaled(const float s) const { return Vec3(x * s, y * s, z * s); }
 
-inline Vec3& Vec3::scale(const float s) {
+constexpr Vec3& Vec3::scale(const float s) {
     x *= s;
     y *= s;
     z *= s;
@@ -272,59 +284,87 @@ inline bool operator!=(const Vec3& a, const Vec3& b) {
            fabs(a.z - b.z) > FLT_EPSILON;
 }
 
-inline Vec3 operator*(const float a, const Vec3& v) { return Vec3(v.x * a, v.y * a, v.z * a); }
+constexpr Vec3 operator*(const float a, const Vec3& v) { return Vec3(v.x * a, v.y * a, v.z * a); }
 
-inline Vec3 operator*(const Vec3& v, const float a) { return Vec3(v.x * a, v.y * a, v.z * a); }
+constexpr Vec3 operator*(const Vec3& v, const float a) { return Vec3(v.x * a, v.y * a, v.z * a); }
 
-inline Vec3 operator/(const Vec3& v, const float a) {
+constexpr Vec3 operator/(const Vec3& v, const float a) {
     const float factor = 1 / a;
     return Vec3(v.x * factor, v.y * factor, v.z * factor);
 }
 
-inline Vec3 operator+(const Vec3& a, const Vec3& b) {
+constexpr Vec3 operator+(const Vec3& a, const Vec3& b) {
     return Vec3(a.x + b.x, a.y + b.y, a.z + b.z);
 }
 
-inline Vec3 operator-(const Vec3& a, const Vec3& b) {
+constexpr Vec3 operator-(const Vec3& a, const Vec3& b) {
     return Vec3(a.x - b.x, a.y - b.y, a.z - b.z);
 }
 
-inline Vec3 operator-(const Vec3& v) { return Vec3(-v.x, -v.y, -v.z); }
+constexpr Vec3 operator-(const Vec3& v) { return Vec3(-v.x, -v.y, -v.z); }
 
-inline float operator*(const Vec3& a, const Vec3& b) { return a.dot(b); }
+constexpr float operator*(const Vec3& a, const Vec3& b) { return a.dot(b); }
 
-inline Vec3 operator^(const Vec3& a, const Vec3& b) { return a.cross(b); }
+constexpr Vec3 operator^(const Vec3& a, const Vec3& b) { return a.cross(b); }
 
 // Mutable operators
 
-inline Vec3& operator*=(Vec3& v, const float a) {
+constexpr Vec3& operator*=(Vec3& v, const float a) {
     v.x *= a;
     v.y *= a;
     v.z *= a;
     return v;
 }
 
-inline Vec3& operator/=(Vec3& v, const float a) {
+constexpr Vec3& operator/=(Vec3& v, const float a) {
     v.x /= a;
     v.y /= a;
     v.z /= a;
     return v;
 }
 
-inline Vec3& operator+=(Vec3& a, const Vec3& b) {
+constexpr Vec3& operator+=(Vec3& a, const Vec3& b) {
     a.x += b.x;
     a.y += b.y;
     a.z += b.z;
     return a;
 }
 
-inline Vec3& operator-=(Vec3& a, const Vec3& b) {
+constexpr Vec3& operator-=(Vec3& a, const Vec3& b) {
     a.x -= b.x;
     a.y -= b.y;
     a.z -= b.z;
     return a;
 }
 
+// Fused operations
+
+constexpr Vec3 madd(const Vec3& a, const float s, const Vec3& b) {
+    return Vec3(a.x * s + b.x, a.y * s + b.y, a.z * s + b.z);
+}
+
+constexpr Vec3 lerp(const Vec3& a, const Vec3& b, const float t) {
+    return Vec3(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+}
+
+constexpr Vec3 lincomb3(const Vec3& a, const float sa, const Vec3& b, const float sb,
+                        const Vec3& c, const float sc) {
+    return Vec3(a.x * sa + b.x * sb + c.x * sc, a.y * sa + b.y * sb + c.y * sc,
+                a.z * sa + b.z * sb + c.z * sc);
+}
+
+/*
+(1 - cos) * (v . n) * n + cos * v + sin * (n x v)
+*/
+constexpr Vec3 rotate_axis_angle(const Vec3& v, const Vec3& unit_axis, const float sine,
+                                 const float cosine) {
+    const Vec3& n = unit_axis;
+    const float along = (1 - cosine) * v.dot(n);
+    return Vec3(along * n.x + cosine * v.x + sine * (n.y * v.z - n.z * v.y),
+                along * n.y + cosine * v.y + sine * (n.z * v.x - n.x * v.z),
+                along * n.z + cosine * v.z + sine * (n.x * v.y - n.y * v.x));
+}
+
 }  // namespace sml
 
 namespace std {
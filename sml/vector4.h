@@ -0,0 +1,620 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SLIPPYS_MATH_LIBRARY_VECTOR4_H_
+#define SLIPPYS_MATH_LIBRARY_VECTOR4_H_
+
+#include <cfloat>
+#include <cmath>
+#include <sml/format.h>
+#include <sml/precision.h>
+#include <sml/simd.h>
+#include <sml/trig.h>
+#include <sml/vector3.h>
+#include <string>
+
+/*
+
+Register sized vectors
+
+Vec3 is three packed floats, which is what files, GPU buffers and the batch
+functions want, but its 12 bytes never line up with a SIMD register. Vec3A is
+the same vector padded and aligned to 16 bytes, and Vec4 is a real four
+component vector with the same layout. Both load into a single register, so
+their methods and operators are a handful of vector instructions each, and a
+chain of them can stay in registers once inlined.
+
+Vec3A keeps the Vec3 method set and reads the same way. Converting between
+the two is a copy of three floats. The padding lane of a Vec3A is never read
+as part of a result, so it needs no care.
+
+Every operation is written once over detail::Float4, which maps to SSE, NEON,
+or four plain floats with SML_NO_SIMD.
+
+*/
+
+namespace sml {
+
+namespace detail {
+
+#if defined(SML_SIMD_SSE)
+using Float4 = __m128;
+#elif defined(SML_SIMD_NEON)
+using Float4 = float32x4_t;
+#else
+struct Float4 {
+    float lane[4];
+};
+#endif
+
+Float4 load4(const float* aligned);
+void store4(float* aligned, const Float4 v);
+Float4 set4(const float x, const float y, const float z, const float w);
+Float4 splat4(const float s);
+Float4 add4(const Float4 a, const Float4 b);
+Float4 sub4(const Float4 a, const Float4 b);
+Float4 mul4(const Float4 a, const Float4 b);
+Float4 yzxw4(const Float4 v);
+float sum3(const Float4 v);  // x + y + z
+float sum4(const Float4 v);
+
+}  // namespace detail
+
+class alignas(16) Vec3A {
+   public:
+    constexpr Vec3A();
+    constexpr Vec3A(float _x, float _y, float _z);
+    constexpr explicit Vec3A(const Vec3& v);
+    explicit Vec3A(const detail::Float4 v);
+
+    // data
+    float x, y, z;
+
+    // conversion
+    constexpr Vec3 to_vec3() const;
+    detail::Float4 simd() const;
+
+    // methods
+    const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
+
+    float dot(const Vec3A& v) const;
+    Vec3A cross(const Vec3A& v) const;
+
+    Vec3A normalized() const;
+    Vec3A& normalize();
+
+    Vec3A clamped(const float s) const;
+    Vec3A& clamp(const float s);
+
+    float length() const;
+    float length_squared() const;
+
+    Vec3A translated(const Vec3A& v) const;
+    Vec3A& translate(const Vec3A& v);
+
+    // Precision::FAST takes the sine and cosine from sml::sincos, as Vec3::rotated does
+    Vec3A& rotate(const Vec3A& axis, const double angle,
+                  const Precision precision = Precision::EXACT);
+    Vec3A rotated(const Vec3A& axis, const double angle,
+                  const Precision precision = Precision::EXACT) const;
+
+    Vec3A scaled(const float s) const;
+    Vec3A& scale(const float s);
+
+    // convenient
+    static constexpr Vec3A zero();
+    static constexpr Vec3A up();
+    static constexpr Vec3A down();
+    static constexpr Vec3A front();
+    static constexpr Vec3A back();
+    static constexpr Vec3A left();
+    static constexpr Vec3A right();
+
+    // convenient axes
+    static constexpr Vec3A x_axis();
+    static constexpr Vec3A y_axis();
+    static constexpr Vec3A z_axis();
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 42;
+
+   private:
+    float _padding;
+
+    // all four floats, through the whole object rather than the member x
+    const float* lanes() const;
+    float* lanes();
+};
+
+class alignas(16) Vec4 {
+   public:
+    constexpr Vec4();
+    constexpr Vec4(float _x, float _y, float _z, float _w);
+    constexpr Vec4(const Vec3& v, float _w);
+    explicit Vec4(const detail::Float4 v);
+
+    // data
+    float x, y, z, w;
+
+    // conversion
+    constexpr Vec3 xyz() const;
+    detail::Float4 simd() const;
+
+    // methods
+    const std::string to_string() const;
+    size_t format_to(char* buffer, size_t capacity) const;
+
+    float dot(const Vec4& v) const;
+
+    Vec4 normalized() const;
+    Vec4& normalize();
+
+    float length() const;
+    float length_squared() const;
+
+    Vec4 scaled(const float s) const;
+    Vec4& scale(const float s);
+
+    // convenient
+    static constexpr Vec4 zero();
+
+    // longest text format_to can produce, null terminator included
+    static const size_t FORMAT_CAPACITY = 53;
+
+   private:
+    // all four floats, through the whole object rather than the member x
+    const float* lanes() const;
+    float* lanes();
+};
+
+// Imutable operators
+
+bool operator==(const Vec3A& a, const Vec3A& b);
+
+bool operator!=(const Vec3A& a, const Vec3A& b);
+
+Vec3A operator*(const float a, const Vec3A& v);
+
+Vec3A operator*(const Vec3A& v, const float a);
+
+Vec3A operator/(const Vec3A& v, const float a);
+
+float operator*(const Vec3A& a, const Vec3A& b);
+
+Vec3A operator^(const Vec3A& a, const Vec3A& b);
+
+Vec3A operator+(const Vec3A& a, const Vec3A& b);
+
+Vec3A operator-(const Vec3A& a, const Vec3A& b);
+
+Vec3A operator-(const Vec3A& v);
+
+bool operator==(const Vec4& a, const Vec4& b);
+
+bool operator!=(const Vec4& a, const Vec4& b);
+
+Vec4 operator*(const float a, const Vec4& v);
+
+Vec4 operator*(const Vec4& v, const float a);
+
+Vec4 operator/(const Vec4& v, const float a);
+
+float operator*(const Vec4& a, const Vec4& b);
+
+Vec4 operator+(const Vec4& a, const Vec4& b);
+
+Vec4 operator-(const Vec4& a, const Vec4& b);
+
+Vec4 operator-(const Vec4& v);
+
+// Mutable operators
+
+Vec3A& operator*=(Vec3A& v, const float a);
+
+Vec3A& operator/=(Vec3A& v, const float a);
+
+Vec3A& operator+=(Vec3A& a, const Vec3A& b);
+
+Vec3A& operator-=(Vec3A& a, const Vec3A& b);
+
+Vec4& operator*=(Vec4& v, const float a);
+
+Vec4& operator/=(Vec4& v, const float a);
+
+Vec4& operator+=(Vec4& a, const Vec4& b);
+
+Vec4& operator-=(Vec4& a, const Vec4& b);
+
+/*
+
+====================
+== IMPLEMENTATION ==
+====================
+
+*/
+
+namespace detail {
+
+#if defined(SML_SIMD_SSE)
+
+inline Float4 load4(const float* aligned) { return _mm_load_ps(aligned); }
+
+inline void store4(float* aligned, const Float4 v) { _mm_store_ps(aligned, v); }
+
+inline Float4 set4(const float x, const float y, const float z, const float w) {
+    return _mm_setr_ps(x, y, z, w);
+}
+
+inline Float4 splat4(const float s) { return _mm_set1_ps(s); }
+
+inline Float4 add4(const Float4 a, const Float4 b) { return _mm_add_ps(a, b); }
+
+inline Float4 sub4(const Float4 a, const Float4 b) { return _mm_sub_ps(a, b); }
+
+inline Float4 mul4(const Float4 a, const Float4 b) { return _mm_mul_ps(a, b); }
+
+inline Float4 yzxw4(const Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+
+inline float sum3(const Float4 v) {
+    const __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z = _mm_movehl_ps(v, v);
+    return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(v, y), z));
+}
+
+inline float sum4(const Float4 v) {
+    const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+#elif defined(SML_SIMD_NEON)
+
+inline Float4 load4(const float* aligned) { return vld1q_f32(aligned); }
+
+inline void store4(float* aligned, const Float4 v) { vst1q_f32(aligned, v); }
+
+inline Float4 set4(const float x, const float y, const float z, const float w) {
+    const float lanes[4] = {x, y, z, w};
+    return vld1q_f32(lanes);
+}
+
+inline Float4 splat4(const float s) { return vdupq_n_f32(s); }
+
+inline Float4 add4(const Float4 a, const Float4 b) { return vaddq_f32(a, b); }
+
+inline Float4 sub4(const Float4 a, const Float4 b) { return vsubq_f32(a, b); }
+
+inline Float4 mul4(const Float4 a, const Float4 b) { return vmulq_f32(a, b); }
+
+inline Float4 yzxw4(const Float4 v) {
+    // y z w x, then the upper pair swapped
+    const float32x4_t rotated = vextq_f32(v, v, 1);
+    return vcombine_f32(vget_low_f32(rotated), vrev64_f32(vget_high_f32(rotated)));
+}
+
+inline float sum3(const Float4 v) {
+    const float32x2_t xy = vget_low_f32(v);
+    return vget_lane_f32(vpadd_f32(xy, xy), 0) + vgetq_lane_f32(v, 2);
+}
+
+inline float sum4(const Float4 v) {
+    const float32x2_t pairs = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+}
+
+#else
+
+inline Float4 load4(const float* aligned) {
+    return {{aligned[0], aligned[1], aligned[2], aligned[3]}};
+}
+
+inline void store4(float* aligned, const Float4 v) {
+    for (int i = 0; i < 4; i++) {
+        aligned[i] = v.lane[i];
+    }
+}
+
+inline Float4 set4(const float x, const float y, const float z, const float w) {
+    return {{x, y, z, w}};
+}
+
+inline Float4 splat4(const float s) { return {{s, s, s, s}}; }
+
+inline Float4 add4(const Float4 a, const Float4 b) {
+    return {{a.lane[0] + b.lane[0], a.lane[1] + b.lane[1], a.lane[2] + b.lane[2],
+             a.lane[3] + b.lane[3]}};
+}
+
+inline Float4 sub4(const Float4 a, const Float4 b) {
+    return {{a.lane[0] - b.lane[0], a.lane[1] - b.lane[1], a.lane[2] - b.lane[2],
+             a.lane[3] - b.lane[3]}};
+}
+
+inline Float4 mul4(const Float4 a, const Float4 b) {
+    return {{a.lane[0] * b.lane[0], a.lane[1] * b.lane[1], a.lane[2] * b.lane[2],
+             a.lane[3] * b.lane[3]}};
+}
+
+inline Float4 yzxw4(const Float4 v) { return {{v.lane[1], v.lane[2], v.lane[0], v.lane[3]}}; }
+
+inline float sum3(const Float4 v) { return v.lane[0] + v.lane[1] + v.lane[2]; }
+
+inline float sum4(const Float4 v) { return (v.lane[0] + v.lane[1]) + (v.lane[2] + v.lane[3]); }
+
+#endif
+
+}  // namespace detail
+
+// Vec3A
+
+constexpr Vec3A::Vec3A() : Vec3A(0.0f, 0.0f, 0.0f) {}
+
+constexpr Vec3A::Vec3A(float _x, float _y, float _z) : x{_x}, y{_y}, z{_z}, _padding{0.0f} {}
+
+constexpr Vec3A::Vec3A(const Vec3& v) : Vec3A(v.x, v.y, v.z) {}
+
+inline Vec3A::Vec3A(const detail::Float4 v) { detail::store4(lanes(), v); }
+
+constexpr Vec3 Vec3A::to_vec3() const { return Vec3(x, y, z); }
+
+inline detail::Float4 Vec3A::simd() const { return detail::load4(lanes()); }
+
+inline const float* Vec3A::lanes() const { return reinterpret_cast<const float*>(this); }
+
+inline float* Vec3A::lanes() { return reinterpret_cast<float*>(this); }
+
+// Static members
+
+constexpr Vec3A Vec3A::zero() { return Vec3A(); }
+
+constexpr Vec3A Vec3A::up() { return Vec3A(0, 1, 0); }
+
+constexpr Vec3A Vec3A::down() { return Vec3A(0, -1, 0); }
+
+constexpr Vec3A Vec3A::front() { return Vec3A(0, 0, -1); }
+
+constexpr Vec3A Vec3A::back() { return Vec3A(0, 0, 1); }
+
+constexpr Vec3A Vec3A::left() { return Vec3A(-1, 0, 0); }
+
+constexpr Vec3A Vec3A::right() { return Vec3A(1, 0, 0); }
+
+constexpr Vec3A Vec3A::x_axis() { return Vec3A(1.0f, 0.0f, 0.0f); }
+
+constexpr Vec3A Vec3A::y_axis() { return Vec3A(0.0f, 1.0f, 0.0f); }
+
+constexpr Vec3A Vec3A::z_axis() { return Vec3A(0.0f, 0.0f, 1.0f); }
+
+// Methods
+
+inline const std::string Vec3A::to_string() const {
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Vec3A::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Vec3A(");
+    writer.append_precise(x);
+    writer.append(", ");
+    writer.append_precise(y);
+    writer.append(", ");
+    writer.append_precise(z);
+    writer.append(")");
+    return writer.finish();
+}
+
+inline float Vec3A::dot(const Vec3A& v) const {
+    return detail::sum3(detail::mul4(simd(), v.simd()));
+}
+
+/*
+Cross product, on rotated lanes
+a x b = yzx(a * yzx(b) - yzx(a) * b)
+*/
+inline Vec3A Vec3A::cross(const Vec3A& v) const {
+    const detail::Float4 a = simd();
+    const detail::Float4 b = v.simd();
+    const detail::Float4 c =
+        detail::sub4(detail::mul4(a, detail::yzxw4(b)), detail::mul4(detail::yzxw4(a), b));
+    return Vec3A(detail::yzxw4(c));
+}
+
+inline Vec3A Vec3A::normalized() const { return scaled(1.0f / length()); }
+
+inline Vec3A& Vec3A::normalize() { return scale(1.0f / length()); }
+
+inline Vec3A Vec3A::clamped(const float s) const { return scaled(s / length()); }
+
+inline Vec3A& Vec3A::clamp(const float s) { return scale(s / length()); }
+
+inline float Vec3A::length() const { return std::sqrt(length_squared()); }
+
+inline float Vec3A::length_squared() const { return dot(*this); }
+
+inline Vec3A Vec3A::translated(const Vec3A& v) const {
+    return Vec3A(detail::add4(simd(), v.simd()));
+}
+
+inline Vec3A& Vec3A::translate(const Vec3A& v) { return *this = translated(v); }
+
+inline Vec3A Vec3A::rotated(const Vec3A& axis, const double angle,
+                            const Precision precision) const {
+    float sine, cosine;
+    if (precision == Precision::FAST) {
+        sincos(static_cast<float>(angle), sine, cosine, precision);
+    } else {
+        sine = static_cast<float>(sin(angle));
+        cosine = static_cast<float>(cos(angle));
+    }
+    const Vec3A normal = axis.normalized();
+    const Vec3A& v = (*this);
+    return (1 - cosine) * dot(normal) * normal + cosine * v + sine * normal.cross(v);
+}
+
+inline Vec3A& Vec3A::rotate(const Vec3A& axis, const double angle, const Precision precision) {
+    return *this = rotated(axis, angle, precision);
+}
+
+inline Vec3A Vec3A::scaled(const float s) const {
+    return Vec3A(detail::mul4(simd(), detail::splat4(s)));
+}
+
+inline Vec3A& Vec3A::scale(const float s) { return *this = scaled(s); }
+
+// Vec4
+
+constexpr Vec4::Vec4() : Vec4(0.0f, 0.0f, 0.0f, 0.0f) {}
+
+constexpr Vec4::Vec4(float _x, float _y, float _z, float _w) : x{_x}, y{_y}, z{_z}, w{_w} {}
+
+constexpr Vec4::Vec4(const Vec3& v, float _w) : Vec4(v.x, v.y, v.z, _w) {}
+
+inline Vec4::Vec4(const detail::Float4 v) { detail::store4(lanes(), v); }
+
+constexpr Vec3 Vec4::xyz() const { return Vec3(x, y, z); }
+
+inline detail::Float4 Vec4::simd() const { return detail::load4(lanes()); }
+
+inline const float* Vec4::lanes() const { return reinterpret_cast<const float*>(this); }
+
+inline float* Vec4::lanes() { return reinterpret_cast<float*>(this); }
+
+constexpr Vec4 Vec4::zero() { return Vec4(); }
+
+inline const std::string Vec4::to_string() const {
+    char buffer[FORMAT_CAPACITY];
+    return std::string(buffer, format_to(buffer, FORMAT_CAPACITY));
+}
+
+inline size_t Vec4::format_to(char* buffer, size_t capacity) const {
+    detail::FormatWriter writer(buffer, capacity);
+    writer.append("Vec4(");
+    writer.append_precise(x);
+    writer.append(", ");
+    writer.append_precise(y);
+    writer.append(", ");
+    writer.append_precise(z);
+    writer.append(", ");
+    writer.append_precise(w);
+    writer.append(")");
+    return writer.finish();
+}
+
+inline float Vec4::dot(const Vec4& v) const { return detail::sum4(detail::mul4(simd(), v.simd())); }
+
+inline Vec4 Vec4::normalized() const { return scaled(1.0f / length()); }
+
+inline Vec4& Vec4::normalize() { return scale(1.0f / length()); }
+
+inline float Vec4::length() const { return std::sqrt(length_squared()); }
+
+inline float Vec4::length_squared() const { return dot(*this); }
+
+inline Vec4 Vec4::scaled(const float s) const {
+    return Vec4(detail::mul4(simd(), detail::splat4(s)));
+}
+
+inline Vec4& Vec4::scale(const float s) { return *this = scaled(s); }
+
+// Imutable operators
+
+inline bool operator==(const Vec3A& a, const Vec3A& b) {
+    return fabs(a.x - b.x) <= FLT_EPSILON && fabs(a.y - b.y) <= FLT_EPSILON &&
+           fabs(a.z - b.z) <= FLT_EPSILON;
+}
+
+inline bool operator!=(const Vec3A& a, const Vec3A& b) { return !(a == b); }
+
+inline Vec3A operator*(const float a, const Vec3A& v) { return v.scaled(a); }
+
+inline Vec3A operator*(const Vec3A& v, const float a) { return v.scaled(a); }
+
+inline Vec3A operator/(const Vec3A& v, const float a) { return v.scaled(1 / a); }
+
+inline float operator*(const Vec3A& a, const Vec3A& b) { return a.dot(b); }
+
+inline Vec3A operator^(const Vec3A& a, const Vec3A& b) { return a.cross(b); }
+
+inline Vec3A operator+(const Vec3A& a, const Vec3A& b) {
+    return Vec3A(detail::add4(a.simd(), b.simd()));
+}
+
+inline Vec3A operator-(const Vec3A& a, const Vec3A& b) {
+    return Vec3A(detail::sub4(a.simd(), b.simd()));
+}
+
+inline Vec3A operator-(const Vec3A& v) { return Vec3A(detail::sub4(detail::splat4(0), v.simd())); }
+
+inline bool operator==(const Vec4& a, const Vec4& b) {
+    return fabs(a.x - b.x) <= FLT_EPSILON && fabs(a.y - b.y) <= FLT_EPSILON &&
+           fabs(a.z - b.z) <= FLT_EPSILON && fabs(a.w - b.w) <= FLT_EPSILON;
+}
+
+inline bool operator!=(const Vec4& a, const Vec4& b) { return !(a == b); }
+
+inline Vec4 operator*(const float a, const Vec4& v) { return v.scaled(a); }
+
+inline Vec4 operator*(const Vec4& v, const float a) { return v.scaled(a); }
+
+inline Vec4 operator/(const Vec4& v, const float a) { return v.scaled(1 / a); }
+
+inline float operator*(const Vec4& a, const Vec4& b) { return a.dot(b); }
+
+inline Vec4 operator+(const Vec4& a, const Vec4& b) {
+    return Vec4(detail::add4(a.simd(), b.simd()));
+}
+
+inline Vec4 operator-(const Vec4& a, const Vec4& b) {
+    return Vec4(detail::sub4(a.simd(), b.simd()));
+}
+
+inline Vec4 operator-(const Vec4& v) { return Vec4(detail::sub4(detail::splat4(0), v.simd())); }
+
+// Mutable operators
+
+inline Vec3A& operator*=(Vec3A& v, const float a) { return v.scale(a); }
+
+inline Vec3A& operator/=(Vec3A& v, const float a) { return v.scale(1 / a); }
+
+inline Vec3A& operator+=(Vec3A& a, const Vec3A& b) { return a = a + b; }
+
+inline Vec3A& operator-=(Vec3A& a, const Vec3A& b) { return a = a - b; }
+
+inline Vec4& operator*=(Vec4& v, const float a) { return v.scale(a); }
+
+inline Vec4& operator/=(Vec4& v, const float a) { return v.scale(1 / a); }
+
+inline Vec4& operator+=(Vec4& a, const Vec4& b) { return a = a + b; }
+
+inline Vec4& operator-=(Vec4& a, const Vec4& b) { return a = a - b; }
+
+}  // namespace sml
+
+namespace std {
+
+inline string to_string(const sml::Vec3A& v) { return v.to_string(); }
+
+inline string to_string(const sml::Vec4& v) { return v.to_string(); }
+
+}  // namespace std
+
+#endif
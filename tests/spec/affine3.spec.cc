@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <sml/affine3.h>
+#include <sml/matrix4.h>
+#include <type_traits>
+
+using sml::Affine3;
+using sml::Mat4;
+using sml::Vec3;
+
+DESCRIBE_CLASS(Affine3) {
+    DESCRIBE_TEST(Affine3, ConvertedFromMat4, ReturnSameMat4Back) {
+        const Mat4 mat = Mat4::identity().translated(Vec3(1, 2, 3)).rotated(Vec3(0, 1, 1), .4f);
+        const Mat4 result = Affine3(mat).to_mat4();
+        const float* raw_result = reinterpret_cast<const float*>(&result);
+        const float* raw_expected = reinterpret_cast<const float*>(&mat);
+        ASSERT_ARRAYS_ARE_EQUAL(raw_result, raw_expected, 0, 16);
+    };
+
+    DESCRIBE_TEST(operator*, MultipliedBySomeAffine, ReturnSameAsMat4) {
+        const Mat4 a({2, 8, 3, 0, 5, 7, 2, 0, 4, 7, 8, 0, 3, 4, 2, 1});
+        const Mat4 b({4, 3, 7, 0, 1, 7, 4, 0, 4, 0, 2, 0, 5, 7, 9, 1});
+        const Affine3 result = Affine3(a) * Affine3(b);
+        const float* raw_result = reinterpret_cast<const float*>(&result);
+        const float expected[12] = {51.f, 102.f, 74.f, 53.f, 85.f,  49.f,
+                                    16.f, 46.f,  28.f, 84.f, 156.f, 103.f};
+        ASSERT_ARRAYS_ARE_EQUAL(raw_result, expected, 0, 12);
+        ASSERT_ARE_EQUAL(result.to_mat4(), a * b);
+    };
+
+    DESCRIBE_TEST(operator*=, MultipliedBySelf, ReturnExpectedResult) {
+        Affine3 m = Affine3().translated(Vec3(1, 2, 3)).scaled(Vec3(2, 3, 4));
+        const Affine3 expected = m * m;
+        m *= m;
+        ASSERT_ARE_EQUAL(m, expected);
+    };
+
+    DESCRIBE_TEST(operator*, MultipliedToVec3, ReturnExpectedResult) {
+        const Affine3 m({1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15});
+        ASSERT_ARE_EQUAL(m * Vec3(17, 18, 19), Vec3(291.f, 346.f, 401.f));
+        ASSERT_ARE_EQUAL(m.transformed_direction(Vec3(1, 0, 0)), Vec3(1.f, 2.f, 3.f));
+    };
+
+    DESCRIBE_TEST(rotated, TranslatedAndRotated, ReturnSameAsMat4) {
+        const Affine3 m = Affine3().translated(Vec3(1, -2, 3)).rotated(Vec3::z_axis(), .5f);
+        const Mat4 expected =
+            Mat4::identity().translated(Vec3(1, -2, 3)).rotated(Vec3::z_axis(), .5f);
+        ASSERT_ARE_EQUAL(m.to_mat4(), expected);
+    };
+
+    DESCRIBE_TEST(inverted, ScaledRotatedTranslated, ReturnExpectedResult) {
+        const Affine3 m = Affine3()
+                              .translated(Vec3(1, 2, 3))
+                              .rotated(Vec3(1, 1, 0), .7f)
+                              .scaled(Vec3(2, 4, .5f));
+        const Vec3 point(3, -1, 2);
+        ASSERT_IS_TRUE((m.inverted() * (m * point) - point).length() < 1e-5f);
+        ASSERT_IS_TRUE((m * (m.inverted() * point) - point).length() < 1e-5f);
+    };
+
+    DESCRIBE_TEST(transform_points, SomeVertices, ReturnSameAsOperator) {
+        const Affine3 m = Affine3().translated(Vec3(1, 2, 3)).rotated(Vec3::x_axis(), .3f);
+        const Vec3 vertices[5] = {Vec3(1, 2, 3), Vec3(-4, 5, 6), Vec3(7, -8, 9), Vec3(0, 0, 0),
+                                  Vec3(.5f, 1, 2)};
+        Vec3 results[5];
+        Vec3 expected[5];
+        for (size_t i = 0; i < 5; i++) {
+            expected[i] = m * vertices[i];
+        }
+        m.transform_points(vertices, results, 5);
+        for (size_t i = 0; i < 5; i++) {
+            ASSERT_IS_TRUE((results[i] - expected[i]).length() < 1e-5f);
+        }
+    };
+
+    DESCRIBE_TEST(sizeof, CheckedByCompiler, BeTwelveFloats) {
+        ASSERT_IS_TRUE(sizeof(Affine3) == 12 * sizeof(float));
+    };
+
+    DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, BeStandardLayout) {
+        ASSERT_IS_TRUE(std::is_standard_layout<Affine3>::value);
+    };
+}
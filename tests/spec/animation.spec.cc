@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <sml/animation.h>
+
+using sml::AnimationClip;
+using sml::AnimationSampler;
+using sml::Quat;
+using sml::Vec3;
+
+DESCRIBE_CLASS(AnimationSampler) {
+    DESCRIBE_TEST(sample_vec3, BetweenAndAroundKeys, ReturnBlendedOrEndValues) {
+        const float times[3] = {0, 1, 3};
+        const Vec3 values[3] = {Vec3(0, 0, 0), Vec3(2, 4, 6), Vec3(0, 0, 2)};
+        AnimationClip clip;
+        clip.add_track(times, values, 3);
+
+        ASSERT_ARE_EQUAL(clip.sample_vec3(0, .5f), Vec3(1, 2, 3));
+        ASSERT_ARE_EQUAL(clip.sample_vec3(0, 2), Vec3(1, 2, 4));
+        ASSERT_ARE_EQUAL(clip.sample_vec3(0, 1), Vec3(2, 4, 6));
+        ASSERT_ARE_EQUAL(clip.sample_vec3(0, -1), Vec3(0, 0, 0));
+        ASSERT_ARE_EQUAL(clip.sample_vec3(0, 5), Vec3(0, 0, 2));
+        ASSERT_ARE_EQUAL(clip.duration(), 3.f);
+    };
+
+    DESCRIBE_TEST(sample_quat, HalfwayBetweenKeys, ReturnSlerpedRotation) {
+        const float times[2] = {0, 2};
+        const Quat values[2] = {Quat::identity(), Quat(0, 0, 0, 1)};
+        AnimationClip clip;
+        clip.add_track(times, values, 2);
+
+        const Quat expected = Quat::slerp(values[0], values[1], .5f);
+        const Quat sampled = clip.sample_quat(0, 1);
+        ASSERT_IS_TRUE(std::fabs(sampled.w - expected.w) < 3e-5f);
+        ASSERT_IS_TRUE(std::fabs(sampled.z - expected.z) < 3e-5f);
+        ASSERT_ARE_EQUAL(clip.sample_quat(0, 2), Quat(0, 0, 0, 1));
+    };
+
+    DESCRIBE_TEST(sample_vec3s, PlayingForwardBackAndLooping, ReturnSameAsClipSamples) {
+        AnimationClip clip;
+        float times[40];
+        Vec3 translations[40];
+        Quat rotations[40];
+        for (size_t track = 0; track < 5; track++) {
+            const size_t count = 8 * track + 1;
+            for (size_t k = 0; k < count; k++) {
+                const float f = static_cast<float>(k + track);
+                times[k] = static_cast<float>(k) * 4 / static_cast<float>(count);
+                translations[k] = Vec3(f, -f * f, 1 / (f + 1));
+                rotations[k] = Quat(1, f * .1f, -f * .2f, .5f).normalized();
+            }
+            clip.add_track(times, translations, count);
+            clip.add_track(times, rotations, count);
+        }
+
+        AnimationSampler sampler(clip);
+        const float playback[12] = {0, .1f, .2f, .25f, 1.3f, 3.9f, 4.5f, 0, .6f, .6f, 2.1f, 1};
+        float x[5], y[5], z[5], w[5];
+        for (const float time : playback) {
+            sampler.sample_vec3s(time, x, y, z);
+            for (size_t track = 0; track < 5; track++) {
+                ASSERT_ARE_EQUAL(Vec3(x[track], y[track], z[track]), clip.sample_vec3(track, time));
+            }
+            sampler.sample_quats(time, w, x, y, z);
+            for (size_t track = 0; track < 5; track++) {
+                ASSERT_ARE_EQUAL(Quat(w[track], x[track], y[track], z[track]),
+                                 clip.sample_quat(track, time));
+            }
+        }
+    };
+}
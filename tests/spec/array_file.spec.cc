@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cstdio>
+#include <sml/array_file.h>
+#include <sml/array_file_mapping.h>
+
+using sml::ArrayFileReader;
+using sml::ArrayFileStatus;
+using sml::ArrayFileWriter;
+using sml::ArrayLayout;
+using sml::Mat4;
+using sml::Quat;
+using sml::Vec3;
+
+static const char* const ARRAY_FILE_PATH = "sml_array_file_test.bin";
+
+DESCRIBE_CLASS(ArrayFileReader) {
+    DESCRIBE_TEST(open, WrittenArrays, MapSameValues) {
+        const Vec3 positions[3] = {Vec3(1, 2, 3), Vec3(4, 5, 6), Vec3(7, 8, 9)};
+        const Quat rotations[2] = {Quat::identity(), Quat(.5f, .5f, .5f, .5f)};
+        const Mat4 matrices[2] = {Mat4::identity(), Mat4::identity().translated({1, 2, 3})};
+
+        ArrayFileWriter writer;
+        writer.add("positions", positions, 3);
+        writer.add("rotations", rotations, 2);
+        writer.add("matrices", matrices, 2);
+        ASSERT_IS_TRUE(writer.write(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+
+        ArrayFileReader reader;
+        ASSERT_IS_TRUE(reader.open(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+        ASSERT_ARE_EQUAL(reader.size(), static_cast<size_t>(3));
+
+        const sml::ArraySpan<Vec3> read_positions = reader.vec3s(reader.find("positions"));
+        ASSERT_ARE_EQUAL(read_positions.size(), static_cast<size_t>(3));
+        ASSERT_ARRAYS_ARE_EQUAL(read_positions.data(), positions, 0, 3);
+
+        const sml::ArraySpan<Quat> read_rotations = reader.quats(reader.find("rotations"));
+        ASSERT_ARE_EQUAL(read_rotations.size(), static_cast<size_t>(2));
+        ASSERT_ARRAYS_ARE_EQUAL(read_rotations.data(), rotations, 0, 2);
+
+        const sml::ArraySpan<Mat4> read_matrices = reader.mat4s(2);
+        ASSERT_ARE_EQUAL(std::string(reader.name(2)), std::string("matrices"));
+        ASSERT_ARE_EQUAL(read_matrices[1], matrices[1]);
+        ASSERT_IS_TRUE(reinterpret_cast<uintptr_t>(read_matrices.data()) % 64 == 0);
+
+        reader.close();
+        std::remove(ARRAY_FILE_PATH);
+    };
+
+    DESCRIBE_TEST(component, SoaArray, MapEachComponentStream) {
+        Vec3 velocities[20];
+        for (size_t i = 0; i < 20; i++) {
+            velocities[i] = Vec3(static_cast<float>(i), static_cast<float>(i) * 2, -1);
+        }
+
+        ArrayFileWriter writer;
+        writer.add("velocities", velocities, 20, ArrayLayout::SOA);
+        ASSERT_IS_TRUE(writer.write(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+
+        ArrayFileReader reader;
+        ASSERT_IS_TRUE(reader.open(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+        ASSERT_IS_TRUE(reader.vec3s(0).empty());
+        ASSERT_IS_TRUE(reader.component(0, 3).empty());
+
+        const sml::ArraySpan<float> y = reader.component(0, 1);
+        ASSERT_ARE_EQUAL(y.size(), static_cast<size_t>(20));
+        for (size_t i = 0; i < 20; i++) {
+            ASSERT_ARE_EQUAL(y[i], velocities[i].y);
+        }
+
+        reader.close();
+        std::remove(ARRAY_FILE_PATH);
+    };
+
+    DESCRIBE_TEST(find, MissingOrMistypedArray, ReturnNothing) {
+        const float weights[4] = {1, 2, 3, 4};
+
+        ArrayFileWriter writer;
+        writer.add("weights", weights, 4);
+        ASSERT_IS_TRUE(writer.write(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+
+        ArrayFileReader reader;
+        ASSERT_IS_TRUE(reader.open(ARRAY_FILE_PATH) == ArrayFileStatus::OK);
+        ASSERT_IS_TRUE(reader.find("bones") == ArrayFileReader::NOT_FOUND);
+        ASSERT_IS_TRUE(reader.vec3s(0).empty());
+        ASSERT_ARE_EQUAL(reader.floats(0)[3], 4.f);
+
+        reader.close();
+        std::remove(ARRAY_FILE_PATH);
+    };
+
+    DESCRIBE_TEST(open, NotAnArrayFile, RejectFile) {
+        std::FILE* file = std::fopen(ARRAY_FILE_PATH, "wb");
+        const char text[] = "this is not an array file, but it is long enough to hold a header";
+        std::fwrite(text, 1, sizeof(text), file);
+        std::fclose(file);
+
+        ArrayFileReader reader;
+        ASSERT_IS_TRUE(reader.open(ARRAY_FILE_PATH) == ArrayFileStatus::BAD_MAGIC);
+        ASSERT_IS_FALSE(reader.is_open());
+        ASSERT_IS_TRUE(reader.open("missing_array_file.bin") == ArrayFileStatus::CANNOT_OPEN);
+
+        std::remove(ARRAY_FILE_PATH);
+    };
+}
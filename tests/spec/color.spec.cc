@@ -20,10 +20,25 @@
  */
 
 #include <btl.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <sml/blend.h>
 #include <sml/color.h>
 
+using sml::BlendMode;
 using sml::Color;
 
+static bool nearly_equal(const Color& a, const Color& b, const float tolerance) {
+    return std::fabs(a.r - b.r) <= tolerance && std::fabs(a.g - b.g) <= tolerance &&
+           std::fabs(a.b - b.b) <= tolerance && std::fabs(a.a - b.a) <= tolerance;
+}
+
+static const BlendMode ALL_BLEND_MODES[] = {
+    BlendMode::OVER, BlendMode::SOURCE_IN, BlendMode::SOURCE_OUT, BlendMode::ATOP,
+    BlendMode::XOR,  BlendMode::MULTIPLY,  BlendMode::SCREEN,     BlendMode::ADDITIVE,
+};
+
 DESCRIBE_CLASS(Color) {
     DESCRIBE_TEST(to_string, ConvertingColorToString, ReturnExpectedResult) {
         Color c(0x80, 0x80, 0x80);
@@ -47,4 +62,86 @@ DESCRIBE_CLASS(Color) {
     DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, BeStandardLayout) {
         ASSERT_IS_TRUE(std::is_standard_layout<Color>::value);
     };
+
+    DESCRIBE_TEST(blended, HalfTransparentRedOnBlue, ReturnPorterDuffResults) {
+        const Color source = sml::premultiplied(Color(1.f, 0.f, 0.f, .5f));
+        const Color destination = Color::blue();
+        ASSERT_IS_TRUE(nearly_equal(sml::blended(source, destination, BlendMode::OVER),
+                                    Color(.5f, 0.f, .5f, 1.f), 1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(sml::blended(source, destination, BlendMode::SOURCE_IN),
+                                    source, 1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(sml::blended(source, destination, BlendMode::SOURCE_OUT),
+                                    Color::invisible(), 1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(sml::blended(source, destination, BlendMode::XOR),
+                                    Color(0.f, 0.f, .5f, .5f), 1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(sml::blended(source, destination, BlendMode::SCREEN),
+                                    Color(.5f, 0.f, 1.f, 1.f), 1e-6f));
+        const Color added = sml::blended(Color::white(), Color::gray(), BlendMode::ADDITIVE);
+        ASSERT_IS_TRUE(nearly_equal(added, Color::white(), 1e-6f));
+    };
+
+    DESCRIBE_TEST(blend, ColorSpansInEveryMode, ReturnSameAsBlended) {
+        Color source[7], destination[7];
+        for (size_t i = 0; i < 7; i++) {
+            const float f = static_cast<float>(i) / 7;
+            source[i] = sml::premultiplied(Color(f, 1 - f, .3f, .2f + f / 2));
+            destination[i] = sml::premultiplied(Color(.9f, f * f, .5f, 1 - f));
+        }
+        for (const BlendMode mode : ALL_BLEND_MODES) {
+            Color result[7];
+            for (size_t i = 0; i < 7; i++) {
+                result[i] = destination[i];
+            }
+            sml::blend(source, result, 7, mode);
+            for (size_t i = 0; i < 7; i++) {
+                ASSERT_IS_TRUE(
+                    nearly_equal(result[i], sml::blended(source[i], destination[i], mode), 1e-6f));
+            }
+        }
+    };
+
+    DESCRIBE_TEST(blend, Rgba8SpansInEveryMode, ReturnSameAsBlendedWithinOneStep) {
+        uint8_t source[11 * 4], destination[11 * 4];
+        for (size_t i = 0; i < 11 * 4; i++) {
+            source[i] = static_cast<uint8_t>(i * 37 % 256);
+            destination[i] = static_cast<uint8_t>(255 - i * 23 % 256);
+        }
+        sml::premultiply(source, 11);
+        sml::premultiply(destination, 11);
+        for (const BlendMode mode : ALL_BLEND_MODES) {
+            uint8_t result[11 * 4];
+            for (size_t i = 0; i < 11 * 4; i++) {
+                result[i] = destination[i];
+            }
+            sml::blend(source, result, 11, mode);
+            for (size_t i = 0; i < 11; i++) {
+                const Color s(source[i * 4], source[i * 4 + 1], source[i * 4 + 2],
+                              source[i * 4 + 3]);
+                const Color d(destination[i * 4], destination[i * 4 + 1], destination[i * 4 + 2],
+                              destination[i * 4 + 3]);
+                const Color expected = sml::blended(s, d, mode);
+                const float channels[4] = {expected.r, expected.g, expected.b, expected.a};
+                for (size_t k = 0; k < 4; k++) {
+                    const int byte = static_cast<int>(std::lround(channels[k] * 255));
+                    ASSERT_IS_TRUE(std::abs(result[i * 4 + k] - byte) <= 1);
+                }
+            }
+        }
+    };
+
+    DESCRIBE_TEST(unpremultiply, PremultipliedColors, ReturnOriginalColors) {
+        Color colors[5] = {Color(.2f, .4f, .6f, .5f), Color(1.f, 0.f, .25f, .25f),
+                           Color(.3f, .3f, .3f, 0.f), Color::white(), Color(.5f, .1f, 1.f, .8f)};
+        Color original[5];
+        for (size_t i = 0; i < 5; i++) {
+            original[i] = colors[i];
+        }
+        sml::premultiply(colors, 5);
+        ASSERT_IS_TRUE(nearly_equal(colors[0], Color(.1f, .2f, .3f, .5f), 1e-6f));
+        sml::unpremultiply(colors, 5);
+        ASSERT_IS_TRUE(nearly_equal(colors[2], Color::invisible(), 0.f));
+        for (const size_t i : {0, 1, 3, 4}) {
+            ASSERT_IS_TRUE(nearly_equal(colors[i], original[i], 1e-6f));
+        }
+    };
 }
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <cstdint>
+#include <sml/color.h>
+#include <sml/color32.h>
+#include <sml/srgb.h>
+#include <string>
+#include <type_traits>
+
+using sml::Color;
+using sml::Color32;
+
+DESCRIBE_CLASS(Color32) {
+    DESCRIBE_TEST(Color32, PassingOutOfRangeIntegers, ClampEveryChannel) {
+        constexpr Color32 c(-10, 1024, 0x33);
+        static_assert(c.to_hex() == 0x00FF33FFu, "evaluated at compile time");
+        ASSERT_IS_TRUE(c == Color32(0, 0xff, 0x33, 0xff));
+        ASSERT_IS_TRUE(Color32::from_hex(0x12345678u) == Color32(0x12, 0x34, 0x56, 0x78));
+    };
+
+    DESCRIBE_TEST(to_string, ConvertingColorToString, ReturnZeroPaddedHex) {
+        ASSERT_ARE_EQUAL(std::to_string(Color32(0x80, 0x05, 0, 0xff)),
+                         std::string("Color32 #0x800500FF"));
+    };
+
+    DESCRIBE_TEST(to_colors, EveryByteValue, MatchIntegerColorConstructor) {
+        Color32 packed[256];
+        Color unpacked[256];
+        for (int k = 0; k < 256; k++) {
+            packed[k] = Color32(k, 255 - k, k / 2, (k * 7) % 256);
+        }
+        Color32::to_colors(packed, unpacked, 256);
+        for (int k = 0; k < 256; k++) {
+            const Color expected(k, 255 - k, k / 2, (k * 7) % 256);
+            ASSERT_IS_TRUE(unpacked[k].r == expected.r && unpacked[k].g == expected.g &&
+                           unpacked[k].b == expected.b && unpacked[k].a == expected.a);
+            ASSERT_IS_TRUE(packed[k].to_color().g == expected.g);
+        }
+
+        Color32 repacked[256];
+        Color32::from_colors(unpacked, repacked, 256);
+        for (int k = 0; k < 256; k++) {
+            ASSERT_IS_TRUE(repacked[k] == packed[k]);
+        }
+    };
+
+    DESCRIBE_TEST(from_colors, ArbitraryFloats, RoundToNearestAndClamp) {
+        Color colors[6];
+        for (size_t i = 0; i < 6; i++) {
+            const float f = static_cast<float>(i) * .21f;
+            colors[i] = Color(f, 1 - f, .5f * f, 1.f);
+        }
+        colors[5].r = 2.f;
+        colors[5].g = -1.f;
+        Color32 packed[6];
+        Color32::from_colors(colors, packed, 6);
+        for (size_t i = 0; i < 6; i++) {
+            ASSERT_IS_TRUE(packed[i] == Color32(colors[i]));
+            ASSERT_IS_TRUE(
+                std::fabs(packed[i].b - std::max(0.f, std::min(1.f, colors[i].b)) * 255) <= .5f);
+        }
+        ASSERT_IS_TRUE(packed[5].r == 0xff && packed[5].g == 0);
+    };
+
+    DESCRIBE_TEST(srgb_to_linear, EveryByteValue, RoundTripThroughLinear) {
+        Color32 packed[256];
+        for (int k = 0; k < 256; k++) {
+            packed[k] = Color32(k, 255 - k, (k * 3) % 256, k);
+        }
+        Color linear[256];
+        sml::srgb_to_linear(packed, linear, 256);
+        for (int k = 0; k < 256; k++) {
+            ASSERT_IS_TRUE(linear[k].r == sml::srgb_to_linear(k / 255.f));
+            ASSERT_IS_TRUE(linear[k].a == packed[k].to_color().a);
+        }
+        for (sml::Precision precision : {sml::Precision::EXACT, sml::Precision::FAST}) {
+            Color32 repacked[256];
+            sml::linear_to_srgb(linear, repacked, 256, precision);
+            for (int k = 0; k < 256; k++) {
+                ASSERT_IS_TRUE(repacked[k] == packed[k]);
+            }
+        }
+    };
+
+    DESCRIBE_TEST(linear_to_srgb, FastPrecision, StayWithinDocumentedError) {
+        for (int i = 0; i <= 4096; i++) {
+            const float x = static_cast<float>(i) / 4096;
+            const float encoded = sml::linear_to_srgb(x);
+            const float decoded = sml::srgb_to_linear(x);
+            ASSERT_IS_TRUE(std::fabs(sml::linear_to_srgb(x, sml::Precision::FAST) - encoded) <=
+                           3e-6f);
+            ASSERT_IS_TRUE(std::fabs(sml::srgb_to_linear(x, sml::Precision::FAST) - decoded) <=
+                           5e-6f * decoded + 1e-9f);
+            ASSERT_IS_TRUE(std::fabs(sml::srgb_to_linear(encoded) - x) <= 1e-6f);
+        }
+        ASSERT_IS_TRUE(sml::linear_to_srgb(2.f, sml::Precision::FAST) == 1.f);
+        ASSERT_IS_TRUE(std::fabs(sml::srgb_to_linear(1.f, sml::Precision::FAST) - 1) <= 5e-6f);
+        ASSERT_IS_TRUE(sml::srgb_to_linear(-1.f, sml::Precision::FAST) == 0.f);
+    };
+
+    DESCRIBE_TEST(linear_to_srgb, BatchOfColors, MatchSingleColorsAndKeepAlpha) {
+        for (sml::Precision precision : {sml::Precision::EXACT, sml::Precision::FAST}) {
+            Color colors[7];
+            Color expected[7];
+            for (size_t i = 0; i < 7; i++) {
+                const float f = static_cast<float>(i) / 6;
+                colors[i] = Color(f, 1 - f, f * f, .5f * f);
+                expected[i] = sml::srgb_to_linear(sml::linear_to_srgb(colors[i], precision),
+                                                  precision);
+            }
+            sml::linear_to_srgb(colors, 7, precision);
+            sml::srgb_to_linear(colors, 7, precision);
+            for (size_t i = 0; i < 7; i++) {
+                ASSERT_IS_TRUE(colors[i].r == expected[i].r && colors[i].g == expected[i].g &&
+                               colors[i].b == expected[i].b);
+                ASSERT_IS_TRUE(colors[i].a == .5f * static_cast<float>(i) / 6);
+            }
+        }
+    };
+
+    DESCRIBE_TEST(linear_to_srgb, BatchOfWhites, StayWithinUnitRange) {
+        Color whites[5];
+        for (size_t i = 0; i < 5; i++) {
+            whites[i] = Color::white();
+        }
+        sml::linear_to_srgb(whites, 5, sml::Precision::FAST);
+        for (size_t i = 0; i < 5; i++) {
+            ASSERT_IS_TRUE(whites[i].r == 1.f && whites[i].g == 1.f && whites[i].b == 1.f);
+        }
+        sml::srgb_to_linear(whites, 5, sml::Precision::FAST);
+        for (size_t i = 0; i < 5; i++) {
+            ASSERT_IS_TRUE(whites[i].r <= 1.f && whites[i].r >= 1 - 5e-6f);
+            ASSERT_IS_TRUE(whites[i].g ==
+                           sml::srgb_to_linear(Color::white(), sml::Precision::FAST).g);
+        }
+    };
+
+    DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, FourBytesStandardLayout) {
+        ASSERT_IS_TRUE(std::is_standard_layout<Color32>::value && sizeof(Color32) == 4);
+    };
+}
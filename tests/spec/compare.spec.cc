@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <cstdint>
+#include <sml/compare.h>
+
+using sml::Mat4;
+using sml::Quat;
+using sml::Tolerance;
+using sml::Vec3;
+
+DESCRIBE_CLASS(Tolerance) {
+    DESCRIBE_TEST(nearly_equal, EachMode, ReturnExpectedResult) {
+        const Vec3 a(1000, 1, 0);
+        const Vec3 b(1000.05f, 1, -0.f);
+        ASSERT_IS_FALSE(sml::nearly_equal(a, b, Tolerance::absolute(.01f)));
+        ASSERT_IS_TRUE(sml::nearly_equal(a, b, Tolerance::absolute(.1f)));
+        ASSERT_IS_TRUE(sml::nearly_equal(a, b, Tolerance::relative(1e-4f)));
+        ASSERT_IS_FALSE(sml::nearly_equal(a, b, Tolerance::relative(1e-6f)));
+        ASSERT_IS_FALSE(sml::nearly_equal(a, b, Tolerance::within_ulps(700)));
+        ASSERT_IS_TRUE(sml::nearly_equal(a, b, Tolerance::within_ulps(900)));
+    };
+
+    DESCRIBE_TEST(nearly_equal, NextFloatAndNaN, ReturnExpectedResult) {
+        const Quat q(1, 2, 3, 4);
+        const Quat next(1, 2, std::nextafter(3.f, 4.f), 4);
+        const Quat nan(1, 2, NAN, 4);
+        ASSERT_IS_FALSE(sml::nearly_equal(q, next, Tolerance::within_ulps(0)));
+        ASSERT_IS_TRUE(sml::nearly_equal(q, next, Tolerance::within_ulps(1)));
+        ASSERT_IS_FALSE(sml::nearly_equal(nan, nan, Tolerance::within_ulps(1)));
+        ASSERT_IS_FALSE(sml::nearly_equal(nan, nan, Tolerance::absolute(1)));
+    };
+
+    DESCRIBE_TEST(changed_mask, SomeVec3, ReturnSameAsSingleComparisons) {
+        Vec3 a[21];
+        Vec3 b[21];
+        for (size_t i = 0; i < 21; i++) {
+            const float f = static_cast<float>(i);
+            a[i] = Vec3(f, -f * 100, f * .001f);
+            b[i] = a[i];
+        }
+        b[2].x += .5f;
+        b[7].z = -b[7].z;
+        b[8].y += 1e-3f;
+        b[15].x = NAN;
+        b[20].z += 1;
+
+        const Tolerance tolerances[3] = {Tolerance::absolute(1e-4f), Tolerance::relative(1e-4f),
+                                         Tolerance::within_ulps(16)};
+        for (const Tolerance& tolerance : tolerances) {
+            uint8_t changed[3];
+            const size_t count = sml::changed_mask(a, b, 21, tolerance, changed);
+
+            size_t expected_count = 0;
+            for (size_t i = 0; i < 21; i++) {
+                const int expected = sml::nearly_equal(a[i], b[i], tolerance) ? 0 : 1;
+                expected_count += static_cast<size_t>(expected);
+                ASSERT_ARE_EQUAL((changed[i / 8] >> (i % 8)) & 1, expected);
+            }
+            ASSERT_ARE_EQUAL(count, expected_count);
+        }
+    };
+
+    DESCRIBE_TEST(changed_indices, SomeMat4, ReturnChangedIndices) {
+        Mat4 a[11];
+        for (size_t i = 0; i < 11; i++) {
+            a[i] = Mat4::identity().translated({static_cast<float>(i), 0, 0});
+        }
+        Mat4 b[11];
+        for (size_t i = 0; i < 11; i++) {
+            b[i] = a[i];
+        }
+        b[0][2][1] = 1;
+        b[9][3][3] = 2;
+        b[1][3][0] = std::nextafter(b[1][3][0], 100.f);
+
+        uint32_t indices[11];
+        const size_t count = sml::changed_indices(a, b, 11, Tolerance::within_ulps(0), indices);
+        const uint32_t expected[3] = {0, 1, 9};
+        ASSERT_ARE_EQUAL(count, static_cast<size_t>(3));
+        ASSERT_ARRAYS_ARE_EQUAL(indices, expected, 0, 3);
+
+        const size_t tolerant_count =
+            sml::changed_indices(a, b, 11, Tolerance::epsilon(), indices);
+        ASSERT_ARE_EQUAL(tolerant_count, static_cast<size_t>(2));
+    };
+}
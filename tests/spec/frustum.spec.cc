@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <cstdint>
+#include <sml/frustum.h>
+#include <sml/matrix4.h>
+
+using sml::Frustum;
+using sml::Mat4;
+using sml::Vec3;
+
+DESCRIBE_CLASS(Frustum) {
+    DESCRIBE_TEST(Frustum, OrthogonalProjection, ReturnBoxPlanes) {
+        const Frustum frustum(Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100));
+        ASSERT_ARE_EQUAL(frustum.planes[0].normal, Vec3(1, 0, 0));
+        ASSERT_ARE_EQUAL(frustum.planes[0].distance, 10.f);
+        ASSERT_ARE_EQUAL(frustum.planes[3].normal, Vec3(0, -1, 0));
+        ASSERT_ARE_EQUAL(frustum.planes[3].distance, 5.f);
+    };
+
+    DESCRIBE_TEST(contains, ConicalProjection, AcceptOnlyPointsInFront) {
+        const Frustum frustum(Mat4::conical_projection(1.2f, 1.5f, .1f, 100.f));
+        ASSERT_IS_TRUE(frustum.contains(Vec3(0, 0, 10)));
+        ASSERT_IS_TRUE(frustum.contains(Vec3(1, -1, 50)));
+        ASSERT_IS_FALSE(frustum.contains(Vec3(0, 0, -10)));
+        ASSERT_IS_FALSE(frustum.contains(Vec3(0, 0, 200)));
+        ASSERT_IS_FALSE(frustum.contains(Vec3(100, 0, 10)));
+    };
+
+    DESCRIBE_TEST(intersects_sphere, StraddlingSphere, ReturnTrue) {
+        const Frustum frustum(Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100));
+        ASSERT_IS_TRUE(frustum.intersects_sphere(Vec3(11, 0, 0), 2.f));
+        ASSERT_IS_FALSE(frustum.intersects_sphere(Vec3(13, 0, 0), 2.f));
+    };
+
+    DESCRIBE_TEST(intersects_aabb, StraddlingBox, ReturnTrue) {
+        const Frustum frustum(Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100));
+        ASSERT_IS_TRUE(frustum.intersects_aabb(Vec3(0, 6, 0), Vec3(1, 2, 1)));
+        ASSERT_IS_FALSE(frustum.intersects_aabb(Vec3(0, 8, 0), Vec3(1, 2, 1)));
+    };
+
+    DESCRIBE_TEST(cull_spheres, SomeSpheres, ReturnSameAsSingleTests) {
+        const Frustum frustum(Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100));
+        float x[19], y[19], z[19], radius[19];
+        for (size_t i = 0; i < 19; i++) {
+            x[i] = static_cast<float>(i) - 9.f;
+            y[i] = static_cast<float>(i % 7) * 1.5f;
+            z[i] = static_cast<float>(i % 3) * 60.f - 60.f;
+            radius[i] = static_cast<float>(i % 4) * .5f;
+        }
+
+        uint8_t visible[3];
+        const size_t count = frustum.cull_spheres(x, y, z, radius, 19, visible);
+
+        size_t expected_count = 0;
+        for (size_t i = 0; i < 19; i++) {
+            const bool expected = frustum.intersects_sphere(Vec3(x[i], y[i], z[i]), radius[i]);
+            expected_count += expected ? 1 : 0;
+            ASSERT_ARE_EQUAL((visible[i / 8] >> (i % 8)) & 1, expected ? 1 : 0);
+        }
+        ASSERT_ARE_EQUAL(count, expected_count);
+    };
+
+    DESCRIBE_TEST(cull_aabbs, SomeBoxes, ReturnSameAsSingleTests) {
+        const Frustum frustum(Mat4::conical_projection(1.2f, 1.5f, .1f, 100.f));
+        float x[21], y[21], z[21], extent_x[21], extent_y[21], extent_z[21];
+        for (size_t i = 0; i < 21; i++) {
+            x[i] = static_cast<float>(i % 5) * 8.f - 16.f;
+            y[i] = static_cast<float>(i % 3) * 4.f - 4.f;
+            z[i] = static_cast<float>(i) * 6.f - 20.f;
+            extent_x[i] = 1.f;
+            extent_y[i] = static_cast<float>(i % 2) + .5f;
+            extent_z[i] = 2.f;
+        }
+
+        uint8_t visible[3];
+        frustum.cull_aabbs(x, y, z, extent_x, extent_y, extent_z, 21, visible);
+
+        for (size_t i = 0; i < 21; i++) {
+            const bool expected = frustum.intersects_aabb(
+                Vec3(x[i], y[i], z[i]), Vec3(extent_x[i], extent_y[i], extent_z[i]));
+            ASSERT_ARE_EQUAL((visible[i / 8] >> (i % 8)) & 1, expected ? 1 : 0);
+        }
+    };
+
+    DESCRIBE_TEST(cull_spheres, NaNCoordinates, CullWhereverTheyAre) {
+        const Frustum frustum(Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100));
+        float x[18], y[18], z[18], radius[18];
+        for (size_t i = 0; i < 18; i++) {
+            x[i] = y[i] = z[i] = 0.f;
+            radius[i] = 1.f;
+        }
+        x[1] = NAN;
+        radius[9] = NAN;
+        z[17] = NAN;
+
+        uint8_t visible[3];
+        ASSERT_ARE_EQUAL(frustum.cull_spheres(x, y, z, radius, 18, visible), size_t{15});
+        ASSERT_ARE_EQUAL(visible[0], uint8_t{0xfd});
+        ASSERT_ARE_EQUAL(visible[1], uint8_t{0xfd});
+        ASSERT_ARE_EQUAL(visible[2] & 3, 1);
+        ASSERT_IS_FALSE(frustum.intersects_sphere(Vec3(NAN, 0, 0), 1.f));
+        ASSERT_IS_FALSE(frustum.intersects_aabb(Vec3::zero(), Vec3(1, NAN, 1)));
+    };
+
+    DESCRIBE_TEST(visible_indices, SomeMask, ReturnSetBits) {
+        const uint8_t visible[2] = {0x85, 0xff};
+        uint32_t indices[16];
+        const size_t count = Frustum::visible_indices(visible, 11, indices);
+        const uint32_t expected[] = {0, 2, 7, 8, 9, 10};
+        ASSERT_ARE_EQUAL(count, static_cast<size_t>(6));
+        ASSERT_ARRAYS_ARE_EQUAL(indices, expected, 0, 6);
+    };
+}
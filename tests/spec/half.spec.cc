@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <cstdint>
+#include <sml/half.h>
+
+using sml::Color;
+using sml::Colorh;
+using sml::Quat;
+using sml::Quath;
+using sml::Vec3;
+using sml::Vec3h;
+
+DESCRIBE_CLASS(Vec3h) {
+    DESCRIBE_TEST(half_from_float, KnownValues, ReturnExpectedBits) {
+        ASSERT_ARE_EQUAL(sml::half_from_float(1.f), static_cast<uint16_t>(0x3c00));
+        ASSERT_ARE_EQUAL(sml::half_from_float(-2.f), static_cast<uint16_t>(0xc000));
+        ASSERT_ARE_EQUAL(sml::half_from_float(.1f), static_cast<uint16_t>(0x2e66));
+        ASSERT_ARE_EQUAL(sml::half_from_float(65504.f), static_cast<uint16_t>(0x7bff));
+        ASSERT_ARE_EQUAL(sml::half_from_float(65520.f), static_cast<uint16_t>(0x7c00));
+        ASSERT_ARE_EQUAL(sml::half_from_float(std::ldexp(1.f, -24)), static_cast<uint16_t>(1));
+        ASSERT_ARE_EQUAL(sml::half_from_float(1e-8f), static_cast<uint16_t>(0));
+        ASSERT_ARE_EQUAL(sml::half_from_float(-INFINITY), static_cast<uint16_t>(0xfc00));
+        ASSERT_IS_TRUE(std::isnan(sml::float_from_half(sml::half_from_float(NAN))));
+    };
+
+    DESCRIBE_TEST(float_from_half, EveryFiniteHalf, RoundTripExactly) {
+        for (uint32_t h = 0; h < 0x10000; h++) {
+            if ((h & 0x7c00) == 0x7c00) {
+                continue;
+            }
+            const uint16_t half = static_cast<uint16_t>(h);
+            ASSERT_ARE_EQUAL(sml::half_from_float(sml::float_from_half(half)), half);
+        }
+    };
+
+    DESCRIBE_TEST(to_half, SomeVectors, ReturnSameAsSingleConversions) {
+        Vec3 vectors[7];
+        for (size_t i = 0; i < 7; i++) {
+            const float f = static_cast<float>(i);
+            vectors[i] = Vec3(f * .37f, -f * 1000.1f, 1.f / (f + 1.f));
+        }
+
+        Vec3h halves[7];
+        sml::to_half(vectors, halves, 7);
+        Vec3 floats[7];
+        sml::to_float(halves, floats, 7);
+
+        for (size_t i = 0; i < 7; i++) {
+            const Vec3h expected(vectors[i]);
+            ASSERT_ARE_EQUAL(halves[i].x, expected.x);
+            ASSERT_ARE_EQUAL(halves[i].y, expected.y);
+            ASSERT_ARE_EQUAL(halves[i].z, expected.z);
+            ASSERT_ARE_EQUAL(floats[i], expected.to_vec3());
+        }
+    };
+
+    DESCRIBE_TEST(to_float, QuatsAndColors, ReturnValuesWithinHalfPrecision) {
+        const Quat quats[3] = {Quat::identity(), Quat(.5f, .5f, -.5f, .5f),
+                               Quat(.1f, .2f, .3f, .9f)};
+        const Color colors[3] = {Color::red(), Color(.25f, .5f, .75f, 1.f), Color::gray()};
+
+        Quath packed_quats[3];
+        Colorh packed_colors[3];
+        sml::to_half(quats, packed_quats, 3);
+        sml::to_half(colors, packed_colors, 3);
+
+        Quat unpacked_quats[3];
+        Color unpacked_colors[3];
+        sml::to_float(packed_quats, unpacked_quats, 3);
+        sml::to_float(packed_colors, unpacked_colors, 3);
+
+        for (size_t i = 0; i < 3; i++) {
+            ASSERT_IS_TRUE((unpacked_quats[i] - quats[i]).norm() < 1e-3f);
+            ASSERT_IS_TRUE(std::fabs(unpacked_colors[i].g - colors[i].g) < 1e-3f);
+            ASSERT_IS_TRUE(std::fabs(unpacked_colors[i].a - colors[i].a) < 1e-3f);
+        }
+        ASSERT_ARE_EQUAL(unpacked_quats[1], quats[1]);
+    };
+}
@@ -18,14 +18,29 @@
  * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <algorithm>
 #include <btl.h>
+#include <cmath>
+#include <cstring>
 #include <sml/constants.h>
 #include <sml/matrix4.h>
 #include <type_traits>
 
 using sml::Mat4;
+using sml::Quat;
+using sml::Transform;
 using sml::Vec3;
 
+static float max_difference(const Mat4& a, const Mat4& b) {
+    float difference = 0.f;
+    for (size_t x = 0; x < Mat4::SIZE; x++) {
+        for (size_t y = 0; y < Mat4::SIZE; y++) {
+            difference = std::max(difference, std::fabs(a[x][y] - b[x][y]));
+        }
+    }
+    return difference;
+}
+
 DESCRIBE_CLASS(Mat4) {
     DESCRIBE_TEST(operator[], SimpleMatrix, ReturnExpectedContents) {
         Mat4 mat({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
@@ -58,6 +73,25 @@ DESCRIBE_CLASS(Mat4) {
         ASSERT_ARRAYS_ARE_EQUAL(raw_result, expected, 0, 16);
     };
 
+    DESCRIBE_TEST(operator*=, MultipliedBySelf, ReturnExpectedResult) {
+        Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        const Mat4 expected = mat * mat;
+        mat *= mat;
+        const float* raw_result = reinterpret_cast<const float*>(&mat);
+        const float* raw_expected = reinterpret_cast<const float*>(&expected);
+        ASSERT_ARRAYS_ARE_EQUAL(raw_result, raw_expected, 0, 16);
+    };
+
+    DESCRIBE_TEST(detail::multiply_mat4, ComparedToScalarKernel, ReturnSameBits) {
+        const float a[16] = {2, -8, 3, 4, 5, 7, -2, 1, 4, 7, 8, 1, -3, 4, 2, 5};
+        const float b[16] = {4, 3, 7, -5, 1, 7, 4, 8, 4, 0, -2, 1, 5, 7, 9, 3};
+        float vectorized[16];
+        float scalar[16];
+        sml::detail::multiply_mat4(a, b, vectorized);
+        sml::detail::multiply_mat4_scalar(a, b, scalar);
+        ASSERT_IS_TRUE(std::memcmp(vectorized, scalar, sizeof(scalar)) == 0);
+    };
+
     DESCRIBE_TEST(operator*, MultipliedToVec3, ReturnExpectedResult) {
         Mat4 mat({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
         Vec3 result = mat * Vec3(17, 18, 19);
@@ -66,6 +100,107 @@ DESCRIBE_CLASS(Mat4) {
         ASSERT_ARRAYS_ARE_EQUAL(raw_result, expected, 0, 3);
     };
 
+    DESCRIBE_TEST(transform_points, SomeVertices, ReturnSameAsOperator) {
+        const Mat4 mat = Mat4::identity().rotated(Vec3::x_axis(), 0.3f).translated(Vec3(1, -2, 3));
+        const Vec3 vertices[7] = {Vec3(1, 2, 3),  Vec3(-4, 5, 6),  Vec3(7, -8, 9), Vec3(0, 0, 0),
+                                  Vec3(.5f, 1, 2), Vec3(3, 3, -3), Vec3(9, 8, 7)};
+        Vec3 results[7];
+        Vec3 expected[7];
+        for (size_t i = 0; i < 7; i++) {
+            expected[i] = mat * vertices[i];
+        }
+        mat.transform_points(vertices, results, 7);
+        for (size_t i = 0; i < 7; i++) {
+            ASSERT_IS_TRUE((results[i] - expected[i]).length() < 1e-5f);
+        }
+    };
+
+    DESCRIBE_TEST(transform_points, SameArrayAsOutput, ReturnSameAsOperator) {
+        Mat4 mat({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
+        Vec3 vertices[5] = {Vec3(17, 18, 19), Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1),
+                            Vec3(17, 18, 19)};
+        mat.transform_points(vertices, vertices, 5);
+        const Vec3 expected[5] = {Vec3(291, 346, 401), Vec3(14, 16, 18), Vec3(18, 20, 22),
+                                  Vec3(22, 24, 26), Vec3(291, 346, 401)};
+        ASSERT_ARRAYS_ARE_EQUAL(vertices, expected, 0, 5);
+    };
+
+    DESCRIBE_TEST(transform_directions, TranslatedMatrix, IgnoreTranslation) {
+        const Mat4 mat = Mat4::identity().translated(Vec3(10, 20, 30));
+        const Vec3 directions[5] = {Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1), Vec3(1, 2, 3),
+                                    Vec3(-1, -2, -3)};
+        Vec3 results[5];
+        mat.transform_directions(directions, results, 5);
+        ASSERT_ARRAYS_ARE_EQUAL(results, directions, 0, 5);
+    };
+
+    DESCRIBE_TEST(transposed, SimpleMatrix, ReturnExpectedContents) {
+        const Mat4 mat({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16});
+        const Mat4 result = mat.transposed();
+        const float* raw_result = reinterpret_cast<const float*>(&result);
+        const float expected[16] = {1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 4, 8, 12, 16};
+        ASSERT_ARRAYS_ARE_EQUAL(raw_result, expected, 0, 16);
+    };
+
+    DESCRIBE_TEST(determinant, SomeMatrix, ReturnExpectedResult) {
+        const Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        ASSERT_ARE_EQUAL(mat.determinant(), -703.f);
+    };
+
+    DESCRIBE_TEST(inverted, SomeMatrix, ReturnExpectedResult) {
+        const Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        ASSERT_IS_TRUE(max_difference(mat * mat.inverted(), Mat4::identity()) < 1e-6f);
+        ASSERT_IS_TRUE(max_difference(mat.inverted() * mat, Mat4::identity()) < 1e-6f);
+    };
+
+    DESCRIBE_TEST(invert, ComparedToScalarKernel, ReturnSameResult) {
+        Mat4 mat = Mat4::conical_projection(1.2f, 1.5f, .1f, 100.f) *
+                   Mat4::look_at(Vec3(3, 4, 5), Vec3(0, 1, 0));
+        Mat4 expected;
+        sml::detail::invert_mat4_scalar(mat.data(), expected.data());
+        mat.invert();
+        ASSERT_IS_TRUE(max_difference(mat, expected) < 1e-4f);
+    };
+
+    DESCRIBE_TEST(inverted_affine, ScaledRotatedTranslated, ReturnGeneralInverse) {
+        const Mat4 mat = Mat4::identity()
+                             .translated(Vec3(1, 2, 3))
+                             .rotated(Vec3(1, 1, 0), .7f)
+                             .scaled(2.f)
+                             .translated(Vec3(-3, 0, 5));
+        Mat4 affine = mat;
+        affine[3][3] = 1.f;
+        ASSERT_IS_TRUE(max_difference(affine.inverted_affine(), affine.inverted()) < 1e-5f);
+        ASSERT_IS_TRUE(max_difference(Mat4(affine).invert_affine() * affine, Mat4::identity()) <
+                       1e-5f);
+    };
+
+    DESCRIBE_TEST(inverted_rigid, LookAtMatrix, ReturnGeneralInverse) {
+        const Mat4 view = Mat4::look_at(Vec3(3, -4, 5), Vec3(1, 1, 0));
+        ASSERT_IS_TRUE(max_difference(view.inverted_rigid(), view.inverted()) < 1e-5f);
+        ASSERT_IS_TRUE(max_difference(view * view.inverted_rigid(), Mat4::identity()) < 1e-5f);
+    };
+
+    DESCRIBE_TEST(translate, SomeMatrix, ReturnSameAsFullProduct) {
+        Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        const Mat4 expected = mat * Mat4({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 3, -2, 5, 1});
+        mat.translate(Vec3(3, -2, 5));
+        ASSERT_ARE_EQUAL(mat, expected);
+    };
+
+    DESCRIBE_TEST(scaled, ScaledByVec3, ReturnSameAsFullProduct) {
+        const Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        const Mat4 expected = mat * Mat4({2, 0, 0, 0, 0, -3, 0, 0, 0, 0, .5f, 0, 0, 0, 0, 1});
+        ASSERT_ARE_EQUAL(mat.scaled(Vec3(2, -3, .5f)), expected);
+    };
+
+    DESCRIBE_TEST(rotate, QuarterTurn, ReturnSameAsFullProduct) {
+        Mat4 mat({2, 8, 3, 4, 5, 7, 2, 1, 4, 7, 8, 1, 3, 4, 2, 5});
+        const Mat4 expected = mat * Mat4({0, -1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1});
+        mat.rotate(Vec3::z_axis(), static_cast<float>(sml::PI * 0.5f));
+        ASSERT_IS_TRUE(max_difference(mat, expected) < 1e-5f);
+    };
+
     DESCRIBE_TEST(rotated, MultipliedToVec3, ReturnExpectedResult) {
         Mat4 rotation = Mat4::identity().rotated(Vec3::y_axis(), sml::PI / 6);
         Vec3 result = rotation * Vec3(-2, 1, -1);
@@ -107,7 +242,74 @@ DESCRIBE_CLASS(Mat4) {
         ASSERT_ARRAYS_ARE_EQUAL(results, expected, 0, 8);
     };
 
+    DESCRIBE_TEST(format_to, SomeMatrix, WriteSameTextAsToString) {
+        const Mat4 m = Mat4::conical_projection(1.2f, 1.5f, .1f, 100.f).translated({-3, 4, 1e6f});
+        char buffer[Mat4::FORMAT_CAPACITY];
+        const size_t length = m.format_to(buffer, sizeof(buffer));
+        ASSERT_ARE_EQUAL(std::string(buffer, length), m.to_string());
+    };
+
+    DESCRIBE_TEST(constexpr, ComputedAtCompileTime, ReturnExpectedResult) {
+        constexpr Mat4 projection = Mat4::orthogonal_projection(-10, -5, 10, 5, -100, 100);
+        constexpr Vec3 vertex = projection.transposed().transposed() * Vec3(-4, 2, 0);
+        static_assert(vertex.x == -.4f, "evaluated at compile time");
+        ASSERT_ARE_EQUAL(vertex, Vec3(-.4f, .4f, 0));
+    };
+
     DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, BeStandardLayout) {
         ASSERT_IS_TRUE(std::is_standard_layout<Mat4>::value);
     };
+
+    DESCRIBE_TEST(from_trs, SomeTransform, ReturnSameAsSeparateProducts) {
+        const Quat q = Transform::quaternion_from_rotation(Vec3(1, -2, .5f), .8f);
+        const Vec3 v(-2, 1, 3);
+        const Mat4 rotation = Mat4::from_quat(q);
+        const Vec3 rotated = Transform::rotated(v, q);
+        ASSERT_IS_TRUE((rotation * v - rotated).length() < 1e-5f);
+        ASSERT_ARE_EQUAL(Mat4::from_quat(Quat::identity()), Mat4::identity());
+
+        const Mat4 expected = Mat4::identity().translated(Vec3(4, 5, -6)) * rotation *
+                              Mat4::identity().scaled(Vec3(2, 3, .5f));
+        const Mat4 trs = Mat4::from_trs(Vec3(4, 5, -6), q, Vec3(2, 3, .5f));
+        ASSERT_IS_TRUE(max_difference(trs, expected) < 1e-5f);
+    };
+
+    DESCRIBE_TEST(to_quat, RotationsOfEveryKind, ReturnTheSameRotation) {
+        const Quat rotations[6] = {Quat::identity(),
+                                   Quat(0, 1, 0, 0),
+                                   Quat(0, 0, 1, 0),
+                                   Quat(0, 0, 0, 1),
+                                   Quat(.1f, -.7f, .2f, .3f).normalized(),
+                                   Quat(-.3f, .2f, -.4f, .9f).normalized()};
+        for (const Quat& q : rotations) {
+            const Quat extracted = Mat4::from_trs(Vec3(1, 2, 3), q, Vec3(2, .5f, 4)).to_quat();
+            ASSERT_IS_TRUE(std::fabs(std::fabs(extracted.dot(q)) - 1) < 1e-5f);
+        }
+    };
+
+    DESCRIBE_TEST(compose_trs, SomeArrays, ReturnSameAsFromTrs) {
+        float t[3][7], r[4][7], s[3][7];
+        for (size_t i = 0; i < 7; i++) {
+            const float f = static_cast<float>(i);
+            const Quat q = Quat(std::cos(f), std::sin(f * 3), -f * .1f, .5f).normalized();
+            const float components[10] = {f,   -f * 2, 1 / (f + 1), q.w, q.x,
+                                          q.y, q.z,    1 + f,       .5f, 2 - f * .1f};
+            for (size_t c = 0; c < 3; c++) {
+                t[c][i] = components[c];
+                s[c][i] = components[7 + c];
+            }
+            for (size_t c = 0; c < 4; c++) {
+                r[c][i] = components[3 + c];
+            }
+        }
+
+        Mat4 matrices[7];
+        sml::compose_trs(t[0], t[1], t[2], r[0], r[1], r[2], r[3], s[0], s[1], s[2], matrices, 7);
+        for (size_t i = 0; i < 7; i++) {
+            const Mat4 expected = Mat4::from_trs(Vec3(t[0][i], t[1][i], t[2][i]),
+                                                 Quat(r[0][i], r[1][i], r[2][i], r[3][i]),
+                                                 Vec3(s[0][i], s[1][i], s[2][i]));
+            ASSERT_IS_TRUE(max_difference(matrices[i], expected) < 1e-5f);
+        }
+    };
 }
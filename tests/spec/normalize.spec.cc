@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <cstring>
+#include <sml/normalize.h>
+#include <sml/quaternion.h>
+#include <sml/vector3.h>
+#include <vector>
+
+using sml::Precision;
+using sml::Quat;
+using sml::Vec3;
+
+DESCRIBE_CLASS(Precision) {
+    DESCRIBE_TEST(normalize_all, PackedVec3s, MatchNormalizedWithinBound) {
+        std::vector<Vec3> values;
+        for (int i = 0; i < 21; i++) {
+            values.push_back(Vec3(i * .37f - 3.f, 1.f + i * i * .1f, -i * 2.f));
+        }
+        for (const Precision precision : {Precision::EXACT, Precision::FAST}) {
+            std::vector<Vec3> normals = values;
+            sml::normalize_all(normals.data(), normals.size(), precision);
+            const float tolerance = precision == Precision::EXACT ? 2e-7f : 1e-6f;
+            for (size_t i = 0; i < values.size(); i++) {
+                ASSERT_IS_TRUE((normals[i] - values[i].normalized()).length() < tolerance);
+            }
+        }
+    };
+
+    DESCRIBE_TEST(normalize_all, FastBatchesWithTails, MatchSingleElementsToTheBit) {
+        std::vector<Vec3> vectors;
+        std::vector<float> x, y, z;
+        std::vector<Quat> quats;
+        for (int i = 0; i < 13; i++) {
+            vectors.push_back(Vec3(i * .37f - 3.f, 1.f + i * i * .1f, -i * 2.f));
+            x.push_back(vectors.back().x);
+            y.push_back(vectors.back().y);
+            z.push_back(vectors.back().z);
+            quats.push_back(Quat(1.f + i, -.5f * i, 3.f, i * i * .2f));
+        }
+        std::vector<Vec3> normal_vectors = vectors;
+        std::vector<Quat> normal_quats = quats;
+        sml::normalize_all(normal_vectors.data(), normal_vectors.size(), Precision::FAST);
+        sml::normalize_all(x.data(), y.data(), z.data(), x.size(), Precision::FAST);
+        sml::normalize_all(normal_quats.data(), normal_quats.size(), Precision::FAST);
+        for (size_t i = 0; i < vectors.size(); i++) {
+            const Vec3 expected = sml::normalized(vectors[i], Precision::FAST);
+            const Vec3 from_arrays(x[i], y[i], z[i]);
+            const Quat expected_quat = sml::normalized(quats[i], Precision::FAST);
+            ASSERT_IS_TRUE(std::memcmp(&normal_vectors[i], &expected, sizeof(Vec3)) == 0);
+            ASSERT_IS_TRUE(std::memcmp(&from_arrays, &expected, sizeof(Vec3)) == 0);
+            ASSERT_IS_TRUE(std::memcmp(&normal_quats[i], &expected_quat, sizeof(Quat)) == 0);
+        }
+    };
+
+    DESCRIBE_TEST(normalize_all, ComponentArrays, MatchPackedVersion) {
+        std::vector<Vec3> values;
+        std::vector<float> x, y, z;
+        for (int i = 0; i < 13; i++) {
+            values.push_back(Vec3(i * 1.5f, 2.f - i, .25f * i));
+            x.push_back(values.back().x);
+            y.push_back(values.back().y);
+            z.push_back(values.back().z);
+        }
+        sml::normalize_all(values.data(), values.size(), Precision::FAST);
+        sml::normalize_all(x.data(), y.data(), z.data(), x.size(), Precision::FAST);
+        for (size_t i = 0; i < values.size(); i++) {
+            ASSERT_IS_TRUE((Vec3(x[i], y[i], z[i]) - values[i]).length() < 1e-6f);
+        }
+    };
+
+    DESCRIBE_TEST(normalize_all, ZeroLengthElements, BecomeZeroOrIdentity) {
+        std::vector<Vec3> vectors(9, Vec3(3, 0, 4));
+        vectors[2] = Vec3::zero();
+        vectors[8] = Vec3::zero();
+        std::vector<Quat> quats(9, Quat(0, 0, 2, 0));
+        quats[1] = Quat(0, 0, 0, 0);
+        quats[7] = Quat(0, 0, 0, 0);
+
+        for (const Precision precision : {Precision::EXACT, Precision::FAST}) {
+            std::vector<Vec3> v = vectors;
+            std::vector<Quat> q = quats;
+            sml::normalize_all(v.data(), v.size(), precision);
+            sml::normalize_all(q.data(), q.size(), precision);
+            ASSERT_ARE_EQUAL(v[2], Vec3::zero());
+            ASSERT_ARE_EQUAL(v[8], Vec3::zero());
+            ASSERT_IS_TRUE((v[3] - Vec3(.6f, 0, .8f)).length() < 1e-6f);
+            ASSERT_ARE_EQUAL(q[1], Quat::identity());
+            ASSERT_ARE_EQUAL(q[7], Quat::identity());
+            ASSERT_IS_TRUE(std::fabs(q[0].y - 1.f) < 1e-6f && q[0].w == 0.f);
+        }
+        ASSERT_ARE_EQUAL(sml::normalized(Vec3::zero(), Precision::EXACT), Vec3::zero());
+    };
+
+    DESCRIBE_TEST(normalize_all, PackedQuats, ReturnUnitNorm) {
+        std::vector<Quat> quats;
+        for (int i = 0; i < 11; i++) {
+            quats.push_back(Quat(1.f + i, -.5f * i, 3.f, i * i * .2f));
+        }
+        sml::normalize_all(quats.data(), quats.size(), Precision::FAST);
+        for (const Quat& q : quats) {
+            ASSERT_IS_TRUE(std::fabs(q.norm() - 1.f) < 1e-6f);
+        }
+    };
+}
@@ -20,11 +20,18 @@
  */
 
 #include <btl.h>
+#include <cmath>
 #include <sml/quaternion.h>
+#include <sml/quaternion_interpolation.h>
 #include <type_traits>
 
 using sml::Quat;
 
+static bool nearly_equal(const Quat& a, const Quat& b, const float tolerance) {
+    return std::fabs(a.w - b.w) <= tolerance && std::fabs(a.x - b.x) <= tolerance &&
+           std::fabs(a.y - b.y) <= tolerance && std::fabs(a.z - b.z) <= tolerance;
+}
+
 DESCRIBE_CLASS(Quat) {
     DESCRIBE_TEST(operator+, AddingTwoQuaternions, ReturnExpectedResult) {
         const Quat a{1, 2, 3, 4};
@@ -52,6 +59,21 @@ DESCRIBE_CLASS(Quat) {
         ASSERT_ARE_EQUAL(a_translated_b, Quat({6, 5, 10, 5}));
     };
 
+    DESCRIBE_TEST(lincomb2, FusedOperations, MatchOperatorChains) {
+        constexpr Quat a{1, 2, 3, 4};
+        constexpr Quat b{-1, .5f, 0, 2};
+        static_assert(sml::lincomb2(a, 2.f, b, 3.f).w == -1.f, "evaluated at compile time");
+        ASSERT_ARE_EQUAL(sml::lincomb2(a, 2.f, b, 3.f), a * 2.f + b * 3.f);
+        ASSERT_ARE_EQUAL(sml::madd(a, -.5f, b), a * -.5f + b);
+        ASSERT_ARE_EQUAL(sml::lerp(a, b, .75f), a + (b - a) * .75f);
+    };
+
+    DESCRIBE_TEST(constexpr, ComputedAtCompileTime, ReturnExpectedResult) {
+        constexpr Quat q = Quat::i() * Quat::j() + Quat::identity().scaled(2.f);
+        static_assert(q.norm_squared() == 5.f, "evaluated at compile time");
+        ASSERT_ARE_EQUAL(q, Quat({2, 0, 0, 1}));
+    };
+
     DESCRIBE_TEST(to_string, ConvertingVectorToString, ReturnExpectedResult) {
         Quat a{1, 2, 3, 4};
         ASSERT_ARE_EQUAL(std::to_string(a), std::string("Quat(1, 2, 3, 4)"));
@@ -67,4 +89,66 @@ DESCRIBE_CLASS(Quat) {
     DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, BeStandardLayout) {
         ASSERT_IS_TRUE(std::is_standard_layout<Quat>::value);
     };
+
+    DESCRIBE_TEST(slerp, HalfwayToRightAngle, ReturnHalfTheRotation) {
+        const Quat quarter_turn{std::cos(.7853982f), 0, 0, std::sin(.7853982f)};
+        const Quat eighth_turn{std::cos(.3926991f), 0, 0, std::sin(.3926991f)};
+        ASSERT_IS_TRUE(nearly_equal(Quat::slerp(Quat::identity(), quarter_turn, .5f), eighth_turn,
+                                    1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(Quat::nlerp(Quat::identity(), quarter_turn, .5f), eighth_turn,
+                                    1e-6f));
+        ASSERT_IS_TRUE(nearly_equal(Quat::fast_slerp(Quat::identity(), quarter_turn, .5f),
+                                    eighth_turn, 3e-5f));
+    };
+
+    DESCRIBE_TEST(slerp, NegatedEnd, TakeTheShortestPath) {
+        const Quat end = Quat(.2f, -.5f, .1f, .8f).normalized();
+        for (const float t : {.1f, .5f, .9f}) {
+            const Quat expected = Quat::slerp(Quat::identity(), end, t);
+            ASSERT_IS_TRUE(nearly_equal(Quat::slerp(Quat::identity(), -end, t), expected, 1e-6f));
+            ASSERT_IS_TRUE(nearly_equal(Quat::nlerp(Quat::identity(), -end, t),
+                                        Quat::nlerp(Quat::identity(), end, t), 1e-6f));
+            ASSERT_IS_TRUE(
+                nearly_equal(Quat::fast_slerp(Quat::identity(), -end, t), expected, 3e-5f));
+        }
+    };
+
+    DESCRIBE_TEST(fast_slerp, AnyAngleAndFactor, StayCloseToSlerp) {
+        const Quat a = Quat(.9f, .1f, -.3f, .2f).normalized();
+        const Quat orthogonal = Quat(-.1f, .9f, .2f, .3f).normalized();
+        for (size_t i = 0; i <= 16; i++) {
+            const float angle = static_cast<float>(i) * .098f;  // up to about 90 degrees apart
+            const Quat b = a * std::cos(angle) + orthogonal * std::sin(angle);
+            ASSERT_ARE_EQUAL(Quat::fast_slerp(a, b, 0), a);
+            ASSERT_ARE_EQUAL(Quat::fast_slerp(a, b, 1), b);
+            for (size_t k = 1; k < 8; k++) {
+                const float t = static_cast<float>(k) / 8;
+                const Quat exact = Quat::slerp(a, b, t);
+                ASSERT_IS_TRUE(nearly_equal(Quat::fast_slerp(a, b, t), exact, 3e-5f));
+            }
+        }
+    };
+
+    DESCRIBE_TEST(fast_slerp, SomeArrays, ReturnSameAsSingleInterpolations) {
+        Quat a[11], b[11];
+        float t[11];
+        for (size_t i = 0; i < 11; i++) {
+            const float f = static_cast<float>(i);
+            a[i] = Quat(std::cos(f), std::sin(f * 3), -f * .1f, std::cos(f * 7)).normalized();
+            b[i] = Quat(std::sin(f), .5f, std::cos(f * 5), f * .2f).normalized();
+            t[i] = f / 10;
+        }
+
+        Quat slerped[11], nlerped[11], fast_slerped[11];
+        sml::slerp(a, b, t, slerped, 11);
+        sml::nlerp(a, b, t, nlerped, 11);
+        sml::fast_slerp(a, b, t, fast_slerped, 11);
+
+        for (size_t i = 0; i < 11; i++) {
+            ASSERT_IS_TRUE(nearly_equal(slerped[i], Quat::slerp(a[i], b[i], t[i]), 1e-6f));
+            ASSERT_IS_TRUE(nearly_equal(nlerped[i], Quat::nlerp(a[i], b[i], t[i]), 1e-6f));
+            ASSERT_IS_TRUE(
+                nearly_equal(fast_slerped[i], Quat::fast_slerp(a[i], b[i], t[i]), 1e-6f));
+        }
+    };
 }
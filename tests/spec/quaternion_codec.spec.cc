@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <sml/quaternion_codec.h>
+
+using sml::Quat;
+using sml::Quat32;
+using sml::Quat48;
+
+// angle of the rotation between a and b, in degrees
+static float rotation_difference(const Quat& a, const Quat& b) {
+    const float dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    const Quat difference = dot < 0 ? a + b : a - b;
+    return 4 * std::asin(std::fmin(1.f, difference.norm() / 2)) * 180 / 3.14159265f;
+}
+
+DESCRIBE_CLASS(Quat32) {
+    DESCRIBE_TEST(Quat32, SimpleRotations, DecodeWithinPrecision) {
+        const Quat rotations[4] = {Quat::identity(), Quat(0, 0, 0, -1), Quat(-.5f, .5f, .5f, -.5f),
+                                   Quat(.1f, -.7f, .2f, .3f).normalized()};
+        for (const Quat& q : rotations) {
+            ASSERT_IS_TRUE(rotation_difference(Quat32(q).to_quat(), q) < .28f);
+            ASSERT_IS_TRUE(rotation_difference(Quat48(q).to_quat(), q) < .009f);
+        }
+        ASSERT_ARE_EQUAL(Quat32(Quat::identity()).to_quat(), Quat::identity());
+        ASSERT_ARE_EQUAL(Quat48(Quat(0, 0, 0, -1)).to_quat(), Quat(0, 0, 0, 1));
+    };
+
+    DESCRIBE_TEST(Quat32, UnnormalizedQuat, EncodeItsRotation) {
+        const Quat q(2, 0, 2, 0);
+        ASSERT_ARE_EQUAL(Quat32(q).bits, Quat32(q.normalized()).bits);
+        ASSERT_IS_TRUE(rotation_difference(Quat32(q).to_quat(), q.normalized()) < .28f);
+    };
+
+    DESCRIBE_TEST(encode, SomeQuats, ReturnSameAsSingleConversions) {
+        Quat quats[11];
+        for (size_t i = 0; i < 11; i++) {
+            const float f = static_cast<float>(i);
+            quats[i] = Quat(std::cos(f), std::sin(f * 3), -f * .1f, std::cos(f * 7)).normalized();
+        }
+
+        Quat32 small[11];
+        Quat48 large[11];
+        sml::encode(quats, small, 11);
+        sml::encode(quats, large, 11);
+
+        Quat decoded_small[11];
+        Quat decoded_large[11];
+        sml::decode(small, decoded_small, 11);
+        sml::decode(large, decoded_large, 11);
+
+        for (size_t i = 0; i < 11; i++) {
+            ASSERT_IS_TRUE(rotation_difference(decoded_small[i], Quat32(quats[i]).to_quat()) < .2f);
+            ASSERT_IS_TRUE(rotation_difference(decoded_small[i], quats[i]) < .28f);
+            ASSERT_IS_TRUE(rotation_difference(decoded_large[i], quats[i]) < .009f);
+        }
+    };
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cstdint>
+#include <sml/quaternion.h>
+#include <sml/soa_array.h>
+#include <sml/vector3.h>
+#include <utility>
+#include <vector>
+
+using sml::Quat;
+using sml::QuatArray;
+using sml::Vec3;
+using sml::Vec3Array;
+
+DESCRIBE_CLASS(Vec3Array) {
+    DESCRIBE_TEST(assign, PackedVec3s, RoundTripsThroughComponentArrays) {
+        std::vector<Vec3> values;
+        for (int i = 0; i < 19; i++) {
+            values.push_back(Vec3(i * 1.f, i * -2.f, i * .5f));
+        }
+        const Vec3Array array(values.data(), values.size());
+
+        ASSERT_ARE_EQUAL(array.size(), size_t{19});
+        ASSERT_ARE_EQUAL(array.y()[7], -14.f);
+        ASSERT_ARE_EQUAL(array[12], values[12]);
+
+        std::vector<Vec3> out(values.size());
+        array.copy_to(out.data());
+        ASSERT_ARRAYS_ARE_EQUAL(out, values, 0, values.size());
+    };
+
+    DESCRIBE_TEST(x, ComponentArrays, AreAlignedToCacheLines) {
+        Vec3Array array(3);
+        for (int i = 0; i < 100; i++) {
+            array.push_back(Vec3::up());
+        }
+
+        ASSERT_IS_TRUE(reinterpret_cast<uintptr_t>(array.x()) % 64 == 0);
+        ASSERT_IS_TRUE(reinterpret_cast<uintptr_t>(array.y()) % 64 == 0);
+        ASSERT_IS_TRUE(reinterpret_cast<uintptr_t>(array.z()) % 64 == 0);
+        ASSERT_ARE_EQUAL(array[0], Vec3::zero());
+        ASSERT_ARE_EQUAL(array[102], Vec3::up());
+    };
+
+    DESCRIBE_TEST(operator[], ProxyAssignment, ChangesElementInPlace) {
+        Vec3Array array(4);
+        array[1] = Vec3(1, 2, 3);
+        array[2] = array[1];
+        array[3].y = 5.f;
+
+        ASSERT_ARE_EQUAL(array[1], Vec3(1, 2, 3));
+        ASSERT_ARE_EQUAL(array[2], Vec3(1, 2, 3));
+        ASSERT_ARE_EQUAL(array[3], Vec3(0, 5, 0));
+        ASSERT_ARE_EQUAL(array.z()[2], 3.f);
+    };
+
+    DESCRIBE_TEST(block, ArrayOf19, GivesTwoFullBlocksAndOnePartial) {
+        Vec3Array array(19);
+        ASSERT_ARE_EQUAL(array.block_count(), size_t{3});
+        ASSERT_ARE_EQUAL(array.block(1).count, size_t{8});
+        ASSERT_ARE_EQUAL(array.block(2).count, size_t{3});
+
+        for (size_t b = 0; b < array.block_count(); b++) {
+            const sml::Vec3Block block = array.block(b);
+            for (size_t lane = 0; lane < Vec3Array::BLOCK_SIZE; lane++) {
+                block.x[lane] = static_cast<float>(b * 8 + lane);
+            }
+        }
+        ASSERT_ARE_EQUAL(array[18].x, 18.f);
+        ASSERT_ARE_EQUAL(array.size(), size_t{19});
+    };
+
+    DESCRIBE_TEST(Vec3Array, MovedFrom, IsLeftEmptyAndReusable) {
+        Vec3Array array(10);
+        array[0] = Vec3(1, 2, 3);
+        Vec3Array moved = std::move(array);
+
+        ASSERT_ARE_EQUAL(moved.size(), size_t{10});
+        ASSERT_ARE_EQUAL(moved[0], Vec3(1, 2, 3));
+        ASSERT_ARE_EQUAL(array.size(), size_t{0});
+        ASSERT_ARE_EQUAL(array.capacity(), size_t{0});
+
+        array.push_back(Vec3(7, 7, 7));
+        ASSERT_ARE_EQUAL(array[0], Vec3(7, 7, 7));
+        ASSERT_ARE_EQUAL(moved[0], Vec3(1, 2, 3));
+
+        moved = std::move(array);
+        ASSERT_ARE_EQUAL(moved.size(), size_t{1});
+        ASSERT_ARE_EQUAL(moved[0], Vec3(7, 7, 7));
+        ASSERT_ARE_EQUAL(array.size(), size_t{0});
+    };
+
+    DESCRIBE_TEST(QuatArray, PackedQuats, RoundTripAndResizeToIdentity) {
+        std::vector<Quat> values;
+        for (int i = 0; i < 11; i++) {
+            values.push_back(Quat(i * 1.f, i * 2.f, i * 3.f, i * 4.f));
+        }
+        QuatArray array(values.data(), values.size());
+        QuatArray copy = array;
+        array[0] = Quat(9, 9, 9, 9);
+
+        std::vector<Quat> out(values.size());
+        copy.copy_to(out.data());
+        ASSERT_ARRAYS_ARE_EQUAL(out, values, 0, values.size());
+        ASSERT_ARE_EQUAL(copy.x()[5], 10.f);
+
+        copy.resize(13);
+        ASSERT_ARE_EQUAL(copy[12], Quat::identity());
+        ASSERT_ARE_EQUAL(copy.block(1).count, size_t{5});
+    };
+}
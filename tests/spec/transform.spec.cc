@@ -20,8 +20,10 @@
  */
 
 #include <btl.h>
+#include <cmath>
 #include <sml/quaternion.h>
 #include <sml/transform.h>
+#include <sml/trig.h>
 #include <sml/vector3.h>
 #include <type_traits>
 
@@ -54,4 +56,111 @@ DESCRIBE_CLASS(Transform) {
         // We check with this wide a range because of float point error
         ASSERT_ARE_EQUAL(result.length(), expected);
     };
+
+    DESCRIBE_TEST(rotate_all, Vec3Arrays, ReturnSameAsRotated) {
+        Vec3 vectors[19], by_one[19], by_each[19];
+        Quat rotations[19];
+        const Quat q = Transform::quaternion_from_rotation(Vec3(1, 2, -1), .9f);
+        for (size_t i = 0; i < 19; i++) {
+            const float f = static_cast<float>(i);
+            vectors[i] = Vec3(f, std::sin(f), -f * .5f);
+            rotations[i] = Transform::quaternion_from_rotation(Vec3(std::cos(f), 1, f), f * .3f);
+        }
+
+        Transform::rotate_all(q, vectors, by_one, 19);
+        Transform::rotate_all(rotations, vectors, by_each, 19);
+        for (size_t i = 0; i < 19; i++) {
+            ASSERT_IS_TRUE((by_one[i] - Transform::rotated(vectors[i], q)).length() < 1e-5f);
+            ASSERT_IS_TRUE(
+                (by_each[i] - Transform::rotated(vectors[i], rotations[i])).length() < 1e-5f);
+        }
+
+        Transform::rotate_all(q, vectors, vectors, 19);
+        ASSERT_ARRAYS_ARE_EQUAL(vectors, by_one, 0, 19);
+    };
+
+    DESCRIBE_TEST(rotate_all, SeparateCoordinates, ReturnSameAsRotated) {
+        float x[19], y[19], z[19], x1[19], y1[19], z1[19], x2[19], y2[19], z2[19];
+        Quat rotations[19];
+        const Quat q = Transform::quaternion_from_rotation(Vec3(0, 1, 3), -2.f);
+        for (size_t i = 0; i < 19; i++) {
+            const float f = static_cast<float>(i);
+            x[i] = 1 - f;
+            y[i] = std::cos(f);
+            z[i] = f * f;
+            rotations[i] = Transform::quaternion_from_rotation(Vec3(1, f, std::sin(f)), f * .2f);
+        }
+
+        Transform::rotate_all(q, x, y, z, x1, y1, z1, 19);
+        Transform::rotate_all(rotations, x, y, z, x2, y2, z2, 19);
+        for (size_t i = 0; i < 19; i++) {
+            const Vec3 v(x[i], y[i], z[i]);
+            const float tolerance = 1e-5f * (1 + v.length());
+            ASSERT_IS_TRUE((Vec3(x1[i], y1[i], z1[i]) - Transform::rotated(v, q)).length() <
+                           tolerance);
+            ASSERT_IS_TRUE(
+                (Vec3(x2[i], y2[i], z2[i]) - Transform::rotated(v, rotations[i])).length() <
+                tolerance);
+        }
+    };
+
+    DESCRIBE_TEST(sincos, FastBatchOverWideRange, StaysWithinDocumentedError) {
+        float angles[37], sines[37], cosines[37], tangents[37];
+        for (size_t i = 0; i < 37; i++) {
+            const float f = static_cast<float>(i);
+            angles[i] = (f - 18.f) * (f - 18.f) * (f - 18.f) * 1.3f + .1f * f;
+        }
+        sml::sincos(angles, sines, cosines, 37, sml::Precision::FAST);
+        sml::tangent(angles, tangents, 37, sml::Precision::FAST);
+        for (size_t i = 0; i < 37; i++) {
+            const double angle = angles[i];
+            ASSERT_IS_TRUE(std::fabs(sines[i] - std::sin(angle)) < 1e-7);
+            ASSERT_IS_TRUE(std::fabs(cosines[i] - std::cos(angle)) < 1e-7);
+            const double tangent_error = 1e-7 * (1 / std::fabs(std::sin(angle)) +
+                                                 1 / std::fabs(std::cos(angle)));
+            ASSERT_IS_TRUE(std::fabs(tangents[i] - std::tan(angle)) <
+                           tangent_error * std::fabs(std::tan(angle)));
+            ASSERT_IS_TRUE(std::fabs(sml::sine(angles[i], sml::Precision::FAST) - sines[i]) <
+                           1.2e-7f);
+        }
+    };
+
+    DESCRIBE_TEST(sincos, FastBeyondReductionRange, FallsBackToLibrary) {
+        const float huge[9] = {1e9f, -4e9f, 8192.5f, 3e38f, -1e30f, 1.f, 2.f, 3.f, 4.f};
+        float sines[9], cosines[9];
+        sml::sincos(huge, sines, cosines, 9, sml::Precision::FAST);
+        for (size_t i = 0; i < 9; i++) {
+            const double angle = huge[i];
+            ASSERT_IS_TRUE(std::fabs(sines[i] - std::sin(angle)) < 1e-7);
+            ASSERT_IS_TRUE(std::fabs(cosines[i] - std::cos(angle)) < 1e-7);
+            ASSERT_IS_TRUE(sml::sine(huge[i], sml::Precision::FAST) == sines[i]);
+        }
+
+        const float odd[4] = {INFINITY, -INFINITY, NAN, 0.f};
+        sml::sincos(odd, sines, cosines, 4, sml::Precision::FAST);
+        for (size_t i = 0; i < 3; i++) {
+            ASSERT_IS_TRUE(std::isnan(sines[i]) && std::isnan(cosines[i]));
+        }
+        ASSERT_IS_TRUE(sines[3] == 0.f && cosines[3] == 1.f);
+    };
+
+    DESCRIBE_TEST(quaternions_from_rotations, ManyAxesAndAngles, ReturnSameAsOneByOne) {
+        Vec3 axes[70];
+        float angles[70];
+        Quat fast[70];
+        for (size_t i = 0; i < 70; i++) {
+            const float f = static_cast<float>(i);
+            axes[i] = Vec3(1, f, -2 * f);
+            angles[i] = f * .37f - 9.f;
+        }
+        Transform::quaternions_from_rotations(axes, angles, fast, 70, sml::Precision::FAST);
+        for (size_t i = 0; i < 70; i++) {
+            const Quat exact = Transform::quaternion_from_rotation(axes[i], angles[i]);
+            ASSERT_IS_TRUE(std::fabs(fast[i].dot(exact) - 1.f) < 1e-6f);
+        }
+
+        const Vec3 v{1, 2, 3};
+        const Vec3 rotated = v.rotated(Vec3(0, 1, 1), 2.5, sml::Precision::FAST);
+        ASSERT_IS_TRUE((rotated - v.rotated(Vec3(0, 1, 1), 2.5)).length() < 1e-6f);
+    };
 }
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <sml/matrix4.h>
+#include <sml/transform.h>
+#include <sml/transform_hierarchy.h>
+
+using sml::Mat4;
+using sml::Quat;
+using sml::Transform;
+using sml::TransformHierarchy;
+using sml::Vec3;
+
+DESCRIBE_CLASS(TransformHierarchy) {
+    DESCRIBE_TEST(update, SingleRoot, ReturnTranslationRotationScale) {
+        TransformHierarchy hierarchy;
+        const Quat rotation = Transform::quaternion_from_rotation(Vec3::y_axis(), .6f);
+        const size_t root = hierarchy.add(Vec3(1, 2, 3), rotation, Vec3(2, 2, 2));
+        hierarchy.update();
+
+        const Vec3 point(1, -1, 4);
+        const Vec3 expected = Transform::rotated(point * 2.f, rotation) + Vec3(1, 2, 3);
+        ASSERT_IS_TRUE((hierarchy.world(root) * point - expected).length() < 1e-5f);
+    };
+
+    DESCRIBE_TEST(update, ChildOfRotatedParent, ReturnComposedWorldMatrix) {
+        TransformHierarchy hierarchy;
+        const Quat turn = Transform::quaternion_from_rotation(Vec3::z_axis(), .5f * sml::PI);
+        const size_t root = hierarchy.add(Vec3(10, 0, 0), turn, Vec3(1, 1, 1));
+        const size_t child = hierarchy.add(Vec3(1, 0, 0), Quat::identity(), Vec3(1, 1, 1), root);
+        hierarchy.update();
+
+        ASSERT_ARE_EQUAL(hierarchy.depth(child), static_cast<size_t>(1));
+        ASSERT_IS_TRUE((hierarchy.world(child) * Vec3() - Vec3(10, 1, 0)).length() < 1e-5f);
+    };
+
+    DESCRIBE_TEST(set_local_translation, ParentMoved, UpdateWholeBranch) {
+        TransformHierarchy hierarchy;
+        const size_t root = hierarchy.add(Vec3(), Quat::identity(), Vec3(1, 1, 1));
+        const size_t child = hierarchy.add(Vec3(0, 1, 0), Quat::identity(), Vec3(1, 1, 1), root);
+        const size_t grandchild =
+            hierarchy.add(Vec3(0, 0, 1), Quat::identity(), Vec3(1, 1, 1), child);
+        const size_t sibling = hierarchy.add(Vec3(5, 0, 0), Quat::identity(), Vec3(1, 1, 1));
+        hierarchy.update();
+
+        hierarchy.set_local_translation(child, Vec3(0, 3, 0));
+        hierarchy.update();
+
+        ASSERT_ARE_EQUAL(hierarchy.world(root) * Vec3(), Vec3(0, 0, 0));
+        ASSERT_ARE_EQUAL(hierarchy.world(child) * Vec3(), Vec3(0, 3, 0));
+        ASSERT_ARE_EQUAL(hierarchy.world(grandchild) * Vec3(), Vec3(0, 3, 1));
+        ASSERT_ARE_EQUAL(hierarchy.world(sibling) * Vec3(), Vec3(5, 0, 0));
+    };
+
+    DESCRIBE_TEST(set_local_scale, RootScaled, ScaleChildTranslation) {
+        TransformHierarchy hierarchy;
+        const size_t root = hierarchy.add(Vec3(), Quat::identity(), Vec3(1, 1, 1));
+        const size_t child = hierarchy.add(Vec3(1, 2, 3), Quat::identity(), Vec3(1, 1, 1), root);
+        hierarchy.update();
+
+        hierarchy.set_local_scale(root, Vec3(2, 2, 2));
+        hierarchy.update();
+
+        ASSERT_ARE_EQUAL(hierarchy.world(child) * Vec3(), Vec3(2, 4, 6));
+        ASSERT_ARE_EQUAL(hierarchy.world_matrices()[child], hierarchy.world(child));
+    };
+}
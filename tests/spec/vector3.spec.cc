@@ -20,7 +20,10 @@
  */
 
 #include <btl.h>
+#include <cmath>
+#include <cstdio>
 #include <sml/vector3.h>
+#include <string>
 #include <type_traits>
 
 using sml::Vec3;
@@ -59,11 +62,42 @@ DESCRIBE_CLASS(Vec3) {
         ASSERT_ARE_EQUAL(a_dot_b, 0.f);
     };
 
+    DESCRIBE_TEST(constexpr, ComputedAtCompileTime, ReturnExpectedResult) {
+        constexpr Vec3 v = Vec3::up().cross(Vec3::right()) + 2.f * Vec3::x_axis();
+        static_assert(v.dot(Vec3::z_axis()) == -1.f, "evaluated at compile time");
+        ASSERT_ARE_EQUAL(v, Vec3({2, 0, -1}));
+    };
+
     DESCRIBE_TEST(to_string, ConvertingVectorToString, ReturnExpectedResult) {
         Vec3 a{1, 2, 3};
         ASSERT_ARE_EQUAL(std::to_string(a), std::string("Vec3(+1.000, +2.000, +3.000)"));
     };
 
+    DESCRIBE_TEST(to_string, RoundingUpToNextPowerOfTen, MatchPrintfUnderEveryStandard) {
+        char expected[64];
+        std::snprintf(expected, sizeof(expected), "Vec3(%+#.4g, %+#.4g, %+#.4g)",
+                      static_cast<double>(-9999.5f), static_cast<double>(9999.9f), 0.0);
+        ASSERT_ARE_EQUAL(std::to_string(Vec3(-9999.5f, 9999.9f, 0)), std::string(expected));
+    };
+
+    DESCRIBE_TEST(format_to, SmallBuffer, TruncateAndReturnFullLength) {
+        Vec3 a{1, 2, 3};
+        char buffer[10];
+        ASSERT_ARE_EQUAL(a.format_to(buffer, sizeof(buffer)), static_cast<size_t>(28));
+        ASSERT_ARE_EQUAL(std::string(buffer), std::string("Vec3(+1.0"));
+    };
+
+    DESCRIBE_TEST(format_array, SomeVectors, WriteEachOnItsOwnLine) {
+        const Vec3 vectors[2] = {Vec3(1, 2, 3), Vec3(-1, 0, .5f)};
+        char buffer[Vec3::FORMAT_CAPACITY * 2];
+        const size_t length = sml::format_array(vectors, 2, buffer, sizeof(buffer));
+        const std::string expected =
+            "Vec3(+1.000, +2.000, +3.000)\n"
+            "Vec3(-1.000, +0.000, +0.5000)\n";
+        ASSERT_ARE_EQUAL(length, expected.size());
+        ASSERT_ARE_EQUAL(std::string(buffer), expected);
+    };
+
     DESCRIBE_TEST(reinterpret_cast<float*>, SimpleVector, ReturnExpectedContents) {
         Vec3 v{1, 2, 3};
         float* cast_v = reinterpret_cast<float*>(&v);
@@ -71,6 +105,26 @@ DESCRIBE_CLASS(Vec3) {
         ASSERT_ARRAYS_ARE_EQUAL(cast_v, expected, 0, 3);
     };
 
+    DESCRIBE_TEST(madd, FusedOperations, MatchOperatorChains) {
+        constexpr Vec3 a{1, 2, 3};
+        constexpr Vec3 b{-4, 0, 2};
+        constexpr Vec3 c{.5f, 8, -1};
+        static_assert(sml::madd(a, 2.f, b).x == -2.f, "evaluated at compile time");
+        ASSERT_ARE_EQUAL(sml::madd(a, 2.f, b), a * 2.f + b);
+        ASSERT_ARE_EQUAL(sml::lerp(a, b, .25f), a + (b - a) * .25f);
+        ASSERT_ARE_EQUAL(sml::lincomb3(a, 2.f, b, -1.f, c, 4.f), a * 2.f - b + c * 4.f);
+    };
+
+    DESCRIBE_TEST(rotate_axis_angle, SameAsRodriguesFormula, ReturnExpectedResult) {
+        const Vec3 v{1, 2, 3};
+        const Vec3 n = Vec3(2, -1, 1).normalized();
+        const float sine = std::sin(.8f);
+        const float cosine = std::cos(.8f);
+        const Vec3 expected = (1 - cosine) * v.dot(n) * n + cosine * v + sine * n.cross(v);
+        ASSERT_IS_TRUE((sml::rotate_axis_angle(v, n, sine, cosine) - expected).length() < 1e-6f);
+        ASSERT_IS_TRUE((v.rotated(Vec3(2, -1, 1), .8) - expected).length() < 1e-6f);
+    };
+
     DESCRIBE_TEST(std::is_standard_layout, CheckedByCompiler, BeStandardLayout) {
         ASSERT_IS_TRUE(std::is_standard_layout<Vec3>::value);
     };
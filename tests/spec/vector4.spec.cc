@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2022 W. Akira Mizutani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <btl.h>
+#include <cmath>
+#include <sml/precision.h>
+#include <sml/vector3.h>
+#include <sml/vector4.h>
+#include <string>
+
+using sml::Precision;
+using sml::Vec3;
+using sml::Vec3A;
+using sml::Vec4;
+
+DESCRIBE_CLASS(Vec4) {
+    DESCRIBE_TEST(alignment, Vec3AAndVec4, FillOneRegisterEach) {
+        ASSERT_IS_TRUE(sizeof(Vec3A) == 16 && alignof(Vec3A) == 16);
+        ASSERT_IS_TRUE(sizeof(Vec4) == 16 && alignof(Vec4) == 16);
+    };
+
+    DESCRIBE_TEST(operator+, AddingTwoVectors, ReturnExpectedResult) {
+        Vec3A a{1, 2, 3};
+        a += Vec3A(1, 2, 3);
+        ASSERT_ARE_EQUAL(a - Vec3A(0, 0, 1), Vec3A(2, 4, 5));
+        ASSERT_ARE_EQUAL(Vec4(1, 2, 3, 4) + Vec4(4, 3, 2, 1), Vec4(5, 5, 5, 5));
+        ASSERT_ARE_EQUAL(-Vec4(1, 2, 3, 4) * 2.f, Vec4(-2, -4, -6, -8));
+    };
+
+    DESCRIBE_TEST(dot, SameVectorsAsVec3, ReturnSameResult) {
+        const Vec3 a{2, 1, -3};
+        const Vec3 b{1, -2, 5};
+        ASSERT_ARE_EQUAL(Vec3A(a).dot(Vec3A(b)), a.dot(b));
+        ASSERT_ARE_EQUAL(Vec4(a, 2).dot(Vec4(b, 3)), a.dot(b) + 6.f);
+    };
+
+    DESCRIBE_TEST(cross, SameVectorsAsVec3, ReturnSameResult) {
+        const Vec3 a{2, 1, -3};
+        const Vec3 b{1, -2, 5};
+        ASSERT_ARE_EQUAL((Vec3A(a) ^ Vec3A(b)).to_vec3(), a.cross(b));
+        ASSERT_ARE_EQUAL(Vec3A::up().cross(Vec3A::right()), Vec3A(0, 0, -1));
+    };
+
+    DESCRIBE_TEST(rotated, SameRotationAsVec3, ReturnSameResult) {
+        const Vec3 v{1, 1, 1};
+        const Vec3 axis{0, 2, 1};
+        const Vec3 expected = v.rotated(axis, 0.7);
+        const Vec3 result = Vec3A(v).rotated(Vec3A(axis), 0.7).to_vec3();
+        ASSERT_IS_TRUE((result - expected).length() < 1e-6f);
+    };
+
+    DESCRIBE_TEST(rotated, FastPrecision, MatchesVec3FastRotation) {
+        const Vec3 v{1, 1, 1};
+        const Vec3 axis{0, 2, 1};
+        const Vec3 expected = v.rotated(axis, 0.7, Precision::FAST);
+        Vec3A result(v);
+        result.rotate(Vec3A(axis), 0.7, Precision::FAST);
+        ASSERT_IS_TRUE((result.to_vec3() - expected).length() < 1e-6f);
+        ASSERT_IS_TRUE((result.to_vec3() - v.rotated(axis, 0.7)).length() < 1e-5f);
+    };
+
+    DESCRIBE_TEST(normalized, ArbitraryVectors, ReturnUnitLength) {
+        ASSERT_IS_TRUE(std::fabs(Vec3A(3, -4, 12).normalized().length() - 1.f) < 1e-6f);
+        ASSERT_IS_TRUE(std::fabs(Vec4(1, 2, 2, 4).normalized().length() - 1.f) < 1e-6f);
+        ASSERT_ARE_EQUAL(Vec4(1, 2, 2, 4).length(), 5.f);
+    };
+
+    DESCRIBE_TEST(to_string, ConvertingVectorToString, ReturnExpectedResult) {
+        ASSERT_ARE_EQUAL(std::to_string(Vec3A(1, 2, 3)),
+                         std::string("Vec3A(+1.000, +2.000, +3.000)"));
+        ASSERT_ARE_EQUAL(std::to_string(Vec4(1, 2, 3, 4)),
+                         std::string("Vec4(+1.000, +2.000, +3.000, +4.000)"));
+    };
+}
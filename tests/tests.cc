@@ -19,11 +19,23 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include "spec/affine3.spec.cc"
+#include "spec/animation.spec.cc"
+#include "spec/array_file.spec.cc"
 #include "spec/color.spec.cc"
+#include "spec/color32.spec.cc"
+#include "spec/compare.spec.cc"
+#include "spec/frustum.spec.cc"
+#include "spec/half.spec.cc"
 #include "spec/matrix4.spec.cc"
+#include "spec/normalize.spec.cc"
 #include "spec/quaternion.spec.cc"
+#include "spec/quaternion_codec.spec.cc"
+#include "spec/soa_array.spec.cc"
 #include "spec/transform.spec.cc"
+#include "spec/transform_hierarchy.spec.cc"
 #include "spec/vector3.spec.cc"
+#include "spec/vector4.spec.cc"
 
 #include <btl.h>
 #include <iostream>
@@ -40,10 +52,22 @@ int main() {
     std::cout << std::endl << "Running tests..." << std::endl << std::endl;
 
     btl::TestRunner<sml::Color>::run();
+    btl::TestRunner<sml::Color32>::run();
     btl::TestRunner<sml::Vec3>::run();
     btl::TestRunner<sml::Quat>::run();
     btl::TestRunner<sml::Mat4>::run();
+    btl::TestRunner<sml::Affine3>::run();
     btl::TestRunner<sml::Transform>::run();
+    btl::TestRunner<sml::Frustum>::run();
+    btl::TestRunner<sml::TransformHierarchy>::run();
+    btl::TestRunner<sml::ArrayFileReader>::run();
+    btl::TestRunner<sml::Tolerance>::run();
+    btl::TestRunner<sml::Vec3h>::run();
+    btl::TestRunner<sml::Quat32>::run();
+    btl::TestRunner<sml::AnimationSampler>::run();
+    btl::TestRunner<sml::Vec3Array>::run();
+    btl::TestRunner<sml::Vec4>::run();
+    btl::TestRunner<sml::Precision>::run();
 
     if (btl::has_errors()) {
         std::cerr << red_text("One or more tests failed!") << std::endl << std::endl;